@@ -0,0 +1,225 @@
+#ifndef BATCH_READER_H
+#define BATCH_READER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    // Forward declarations
+    class IoUring;
+
+    /**
+     * @brief Blocking FIFO queue with a fixed capacity
+     *
+     * push waits while the queue is full, so a fast producer cannot run
+     * ahead of its consumers by more than the capacity. Once closed,
+     * pushes fail and pops drain what is left before failing.
+     */
+    template <typename T>
+    class BoundedQueue
+    {
+    private:
+        std::mutex mutex_;
+        std::condition_variable not_empty_;
+        std::condition_variable not_full_;
+        std::deque<T> items_;
+        size_t capacity_;
+        bool closed_;
+
+    public:
+        /**
+         * @brief Constructor
+         * @param capacity Largest number of queued items (at least 1)
+         */
+        explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1), closed_(false) {}
+
+        /**
+         * @brief Append an item, waiting for room
+         * @param item Item to append
+         * @return false if the queue was closed
+         */
+        bool push(T item)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this]
+                           { return closed_ || items_.size() < capacity_; });
+            if (closed_)
+            {
+                return false;
+            }
+            items_.push_back(std::move(item));
+            not_empty_.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Remove the oldest item, waiting for one to arrive
+         * @param item Receives the item
+         * @return false once the queue is closed and empty
+         */
+        bool pop(T &item)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this]
+                            { return closed_ || !items_.empty(); });
+            if (items_.empty())
+            {
+                return false;
+            }
+            item = std::move(items_.front());
+            items_.pop_front();
+            not_full_.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Refuse further pushes and wake every waiting thread
+         */
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            not_empty_.notify_all();
+            not_full_.notify_all();
+        }
+    };
+
+    /**
+     * @brief Contents of one file read by a BatchReader
+     */
+    struct FileBuffer
+    {
+        size_t index = 0; // Position of the file in the list given to the reader
+        std::string path;
+        std::vector<char> data;
+        int error = 0;         // errno of a failed open or read, 0 on success
+        bool deferred = false; // Too large or not a regular file; data is empty
+    };
+
+    /**
+     * @brief Reads many files concurrently and hands out their contents as they complete
+     *
+     * Small files are read whole, with many reads in flight at once:
+     * through io_uring where the kernel supports it, otherwise through a
+     * pool of threads issuing pread. Completed files wait in a bounded
+     * queue, so reading overlaps with whatever consumes them. The bytes
+     * of files being read or waiting in the queue are capped (a single
+     * file larger than the cap is still read, alone). Files larger than
+     * the batch limit, pipes and devices are reported as deferred, for
+     * the caller to stream with FileSource instead.
+     */
+    class BatchReader
+    {
+    public:
+        /**
+         * @brief How reads are issued
+         */
+        enum class Backend
+        {
+            IoUring,   // One submission ring, reads completed by the kernel
+            ThreadPool // Blocking pread calls on several threads
+        };
+
+    private:
+        std::vector<std::string> paths_;
+        size_t max_in_flight_;
+        size_t max_file_size_;
+        BoundedQueue<FileBuffer> queue_;
+        std::atomic<size_t> next_path_;
+        std::atomic<size_t> running_readers_;
+        std::mutex budget_mutex_;
+        std::condition_variable budget_freed_;
+        size_t buffered_bytes_; // Buffers being read or waiting in the queue, guarded by budget_mutex_
+        bool closing_;          // Set by the destructor, guarded by budget_mutex_
+        std::unique_ptr<IoUring> ring_; // Set while the io_uring backend is in use
+        std::vector<std::thread> threads_;
+        Backend backend_;
+
+        /**
+         * @brief Open a file, deciding whether it is read here
+         *
+         * The buffer is left empty, so it is allocated only once its
+         * bytes fit under the cap.
+         * @param buffer Buffer for the file at buffer.index
+         * @param size Receives the number of bytes to read
+         * @return Open descriptor, or -1 if the buffer is already complete
+         */
+        int openFile(FileBuffer &buffer, size_t &size) const;
+
+        /**
+         * @brief Count a buffer against the cap on buffered bytes
+         * @param bytes Buffer size
+         * @param wait true to wait for room, false to fail at once if there is none
+         * @return false if there was no room, or the reader is being destroyed
+         */
+        bool reserveBytes(size_t bytes, bool wait);
+
+        /**
+         * @brief Return a buffer's bytes once it has left the queue
+         * @param bytes Buffer size given to reserveBytes
+         */
+        void releaseBytes(size_t bytes);
+
+        /**
+         * @brief Read files through the io_uring ring until none are left
+         */
+        void runIoUring();
+
+        /**
+         * @brief Read files with pread until none are left
+         */
+        void runThreadPool();
+
+        /**
+         * @brief Close the queue once the last reader thread is done
+         */
+        void finishReader();
+
+    public:
+        /**
+         * @brief Constructor; reading starts immediately in the background
+         * @param paths Files to read
+         * @param max_in_flight Largest number of reads issued at once
+         * @param max_file_size Largest file read whole, in bytes; larger ones are deferred
+         * @param use_io_uring false to always use the thread pool
+         */
+        BatchReader(std::vector<std::string> paths, size_t max_in_flight, size_t max_file_size,
+                    bool use_io_uring = true);
+
+        /**
+         * @brief Destructor; stops reading and waits for the background threads
+         */
+        ~BatchReader();
+
+        // Delete copy constructor and assignment operator
+        BatchReader(const BatchReader &) = delete;
+        BatchReader &operator=(const BatchReader &) = delete;
+
+        /**
+         * @brief Take the next completed file, in completion order
+         *
+         * Safe to call from several consumer threads.
+         * @param buffer Receives the file
+         * @return false once every file has been handed out
+         */
+        bool next(FileBuffer &buffer);
+
+        /**
+         * @brief Get the backend chosen at construction
+         * @return Backend in use
+         */
+        Backend backend() const { return backend_; }
+    };
+
+} // namespace spellcheck
+
+#endif // BATCH_READER_H
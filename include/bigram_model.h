@@ -0,0 +1,151 @@
+#ifndef BIGRAM_MODEL_H
+#define BIGRAM_MODEL_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Compact word bigram language model used to rerank suggestions
+     *
+     * The model file holds sorted 64-bit hashes of unigrams and bigrams with
+     * one quantized log10 probability byte each, and is mapped read-only
+     * into memory rather than parsed. Word strings are not stored, so a
+     * hash collision can (rarely) attribute one word's probability to
+     * another. Unseen bigrams back off to the unigram probability.
+     *
+     * File layout (little-endian):
+     *   header: magic "SCBG", version, unigram count, bigram count
+     *   uint64 unigram keys[], uint64 bigram keys[]   (each sorted)
+     *   uint8 unigram costs[], uint8 bigram costs[]   (-log10 p * 32)
+     */
+    class BigramModel
+    {
+    public:
+        /**
+         * @brief Hashes of the words around a misspelling, computed once
+         */
+        struct Context
+        {
+            uint64_t previous = 0; // 0 = no previous word
+            uint64_t next = 0;     // 0 = no next word
+        };
+
+    private:
+        const unsigned char *data_;
+        size_t data_size_;
+        const uint64_t *unigram_keys_;
+        const uint64_t *bigram_keys_;
+        const uint8_t *unigram_costs_;
+        const uint8_t *bigram_costs_;
+        uint64_t unigram_count_;
+        uint64_t bigram_count_;
+
+        /**
+         * @brief Hash a word (case-insensitive)
+         * @param word Word to hash
+         * @return Non-zero 64-bit hash
+         */
+        static uint64_t hashWord(const std::string &word);
+
+        /**
+         * @brief Combine two word hashes into a bigram key
+         * @param first Hash of the first word
+         * @param second Hash of the second word
+         * @return Bigram key
+         */
+        static uint64_t bigramKey(uint64_t first, uint64_t second);
+
+        /**
+         * @brief Look up a key in one of the sorted tables
+         * @param keys Sorted keys
+         * @param costs Costs parallel to keys
+         * @param count Number of keys
+         * @param key Key to find
+         * @param cost Receives the stored cost when found
+         * @return true if the key is present
+         */
+        static bool lookup(const uint64_t *keys, const uint8_t *costs, uint64_t count, uint64_t key, uint8_t &cost);
+
+        /**
+         * @brief Get log10 P(word | previous) with backoff to the unigram
+         * @param previous Hash of the previous word (0 = none)
+         * @param word Hash of the word
+         * @return Log10 probability
+         */
+        double conditionalLogProbability(uint64_t previous, uint64_t word) const;
+
+        /**
+         * @brief Release the mapping
+         */
+        void unmap();
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        BigramModel();
+
+        /**
+         * @brief Destructor
+         */
+        ~BigramModel();
+
+        // Delete copy constructor and assignment operator
+        BigramModel(const BigramModel &) = delete;
+        BigramModel &operator=(const BigramModel &) = delete;
+
+        /**
+         * @brief Map a model file into memory
+         * @param file_path Path to model file
+         * @return true if successful, false otherwise
+         */
+        bool loadFromFile(const std::string &file_path);
+
+        /**
+         * @brief Count words in a plain-text corpus and write a model file
+         * @param corpus_path Path to corpus text
+         * @param output_path Path of the model file to write
+         * @param min_bigram_count Bigrams seen fewer times are dropped
+         * @return true if successful, false otherwise
+         */
+        static bool buildFromCorpus(const std::string &corpus_path, const std::string &output_path,
+                                    uint32_t min_bigram_count = 2);
+
+        /**
+         * @brief Prepare the context of one misspelling
+         * @param previous Word before the misspelling (empty = none)
+         * @param next Word after the misspelling (empty = none)
+         * @return Hashed context
+         */
+        Context makeContext(const std::string &previous, const std::string &next) const;
+
+        /**
+         * @brief Score a candidate in context
+         *
+         * Costs at most four table lookups, each a binary search.
+         * @param context Hashed neighbouring words
+         * @param candidate Candidate word
+         * @return log10 P(candidate | previous) + log10 P(next | candidate)
+         */
+        double score(const Context &context, const std::string &candidate) const;
+
+        /**
+         * @brief Check if a model is loaded
+         * @return true if loaded
+         */
+        bool isLoaded() const { return data_ != nullptr; }
+
+        /**
+         * @brief Get size of the mapped file
+         * @return Size in bytes
+         */
+        size_t mappedBytes() const { return data_size_; }
+    };
+
+} // namespace spellcheck
+
+#endif // BIGRAM_MODEL_H
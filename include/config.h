@@ -0,0 +1,120 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief INI-style configuration file (see spellchecker.conf)
+     *
+     * Keys are looked up by section and name. Typed getters fall back to the
+     * supplied default when a key is missing or its value cannot be parsed.
+     */
+    class Config
+    {
+    private:
+        std::unordered_map<std::string, std::string> values_; // "section.key" -> value
+        std::vector<std::string> warnings_;
+        std::string path_;
+
+        /**
+         * @brief Build the lookup key for a section and name
+         * @param section Section name
+         * @param key Key name
+         * @return Combined lookup key
+         */
+        static std::string makeKey(const std::string &section, const std::string &key);
+
+        /**
+         * @brief Remove leading and trailing whitespace
+         * @param text Input text
+         * @return Trimmed text
+         */
+        static std::string trim(const std::string &text);
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        Config() = default;
+
+        /**
+         * @brief Load configuration from file
+         * @param file_path Path to configuration file
+         * @return true if the file could be read, false otherwise
+         */
+        bool loadFromFile(const std::string &file_path);
+
+        /**
+         * @brief Check if a key is set to a non-empty value
+         * @param section Section name
+         * @param key Key name
+         * @return true if key is present
+         */
+        bool has(const std::string &section, const std::string &key) const;
+
+        /**
+         * @brief Get string value
+         * @param section Section name
+         * @param key Key name
+         * @param default_value Value returned when key is missing
+         * @return Configured value
+         */
+        std::string getString(const std::string &section, const std::string &key,
+                              const std::string &default_value = "") const;
+
+        /**
+         * @brief Get boolean value (true/false, yes/no, on/off, 1/0)
+         * @param section Section name
+         * @param key Key name
+         * @param default_value Value returned when key is missing or invalid
+         * @return Configured value
+         */
+        bool getBool(const std::string &section, const std::string &key, bool default_value) const;
+
+        /**
+         * @brief Get non-negative integer value
+         * @param section Section name
+         * @param key Key name
+         * @param default_value Value returned when key is missing or invalid
+         * @return Configured value
+         */
+        size_t getSize(const std::string &section, const std::string &key, size_t default_value) const;
+
+        /**
+         * @brief Get floating point value
+         * @param section Section name
+         * @param key Key name
+         * @param default_value Value returned when key is missing or invalid
+         * @return Configured value
+         */
+        double getDouble(const std::string &section, const std::string &key, double default_value) const;
+
+        /**
+         * @brief Get comma-separated list value
+         * @param section Section name
+         * @param key Key name
+         * @return Trimmed, non-empty list items
+         */
+        std::vector<std::string> getList(const std::string &section, const std::string &key) const;
+
+        /**
+         * @brief Get problems found while parsing the file
+         * @return Warning messages with line numbers
+         */
+        const std::vector<std::string> &getWarnings() const { return warnings_; }
+
+        /**
+         * @brief Get path of the loaded file
+         * @return File path (empty if nothing loaded)
+         */
+        const std::string &getPath() const { return path_; }
+    };
+
+} // namespace spellcheck
+
+#endif // CONFIG_H
@@ -2,12 +2,17 @@
 #define DICTIONARY_H
 
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include <unordered_map>
 #include <vector>
 #include <memory>
 #include <fstream>
 #include <iostream>
+#include <cstdint>
+
+#include "perfect_hash.h"
+#include "phonetic_index.h"
 
 namespace spellcheck
 {
@@ -24,6 +29,68 @@ namespace spellcheck
         TrieNode() : is_word(false), frequency(0) {}
     };
 
+    /**
+     * @brief A dictionary file line that could not be parsed
+     */
+    struct LoadError
+    {
+        size_t line;
+        std::string message;
+    };
+
+    /**
+     * @brief Encoder used to group sound-alike words
+     */
+    enum class PhoneticAlgorithm
+    {
+        Soundex,        // One coarse code per word
+        DoubleMetaphone // Primary and alternate pronunciation keys
+    };
+
+    /**
+     * @brief Estimated heap usage of each dictionary structure, in bytes
+     *
+     * Node, string and buffer sizes are maintained incrementally as words are
+     * added and removed; hash bucket arrays are read from the containers when
+     * the statistics are requested. Allocations are rounded the way glibc
+     * malloc rounds them, and strings short enough for the small-string
+     * buffer are counted as free.
+     */
+    struct MemoryStats
+    {
+        size_t word_set = 0;
+        size_t frequency_map = 0;
+        size_t trie = 0;
+        size_t phonetic_map = 0;
+        size_t static_index = 0;
+        size_t overlay = 0;
+
+        // Net bytes allocated while loading, as counted by the tracking
+        // allocator (0 unless built with SPELLCHECK_TRACK_ALLOCATIONS)
+        size_t measured_at_load = 0;
+
+        /**
+         * @brief Get estimated total over all structures
+         * @return Total bytes
+         */
+        size_t total() const
+        {
+            return word_set + frequency_map + trie + phonetic_map + static_index + overlay;
+        }
+
+        MemoryStats &operator+=(const MemoryStats &other)
+        {
+            word_set += other.word_set;
+            frequency_map += other.frequency_map;
+            trie += other.trie;
+            phonetic_map += other.phonetic_map;
+            static_index += other.static_index;
+            overlay += other.overlay;
+            measured_at_load += other.measured_at_load;
+            return *this;
+        }
+    };
+
     /**
      * @brief High-performance dictionary class using multiple data structures
      */
@@ -34,30 +101,74 @@ namespace spellcheck
         std::unordered_set<std::string> word_set_; // For O(1) lookups
         std::unordered_map<std::string, uint32_t> word_frequencies_;
 
-        // Phonetic hash map for sound-alike matching
-        std::unordered_map<std::string, std::vector<std::string>> phonetic_map_;
+        // Phonetic buckets for sound-alike matching
+        PhoneticIndex phonetic_index_;
+        PhoneticAlgorithm phonetic_algorithm_;
+
+        // Read-only lookup index used once the dictionary is frozen; words
+        // added afterwards go to the mutable overlay
+        std::unique_ptr<PerfectHashIndex> static_index_;
+        std::unordered_map<std::string, uint32_t> overlay_words_;
 
         size_t word_count_;
-        size_t memory_usage_;
+        uint64_t content_sum_; // Sum of each word's hash, kept up to date for contentHash
+
+        // Incrementally maintained sizes, excluding hash bucket arrays
+        MemoryStats memory_;
+
+        // Loader configuration and diagnostics
+        size_t load_threads_;
+        std::vector<LoadError> load_errors_;
 
         /**
-         * @brief Calculate memory usage of the dictionary
+         * @brief Parse dictionary file contents and build all structures
+         * @param data Whole file contents
          */
-        void calculateMemoryUsage();
+        void buildFromBuffer(std::string_view data);
 
         /**
          * @brief Generate phonetic code for a word (Soundex-like algorithm)
+         *
+         * The code is packed into 14 bits: the first letter (1-26, or 0 for
+         * anything else) in bits 9-13 and three 3-bit consonant class digits
+         * below it.
+         * @param word Input word
+         * @return Packed phonetic code
+         */
+        static uint16_t generatePhoneticCode(const std::string &word);
+
+        /**
+         * @brief Generate packed Double Metaphone keys for a word
+         *
+         * Each key of up to four symbols is packed 4 bits per symbol.
          * @param word Input word
-         * @return Phonetic code
+         * @return Packed primary and alternate keys
          */
-        std::string generatePhoneticCode(const std::string &word) const;
+        static PhoneticCodes generateMetaphoneCodes(const std::string &word);
+
+        /**
+         * @brief Generate phonetic codes with the selected algorithm
+         * @param word Input word
+         * @return Phonetic codes
+         */
+        PhoneticCodes phoneticCodes(const std::string &word) const;
 
         /**
          * @brief Insert word into trie
+         * @param root Root of the trie to insert into
          * @param word Word to insert
          * @param frequency Word frequency
+         * @return Bytes allocated for new nodes (excluding the root's buckets)
          */
-        void insertIntoTrie(const std::string &word, uint32_t frequency);
+        static size_t insertIntoTrie(TrieNode *root, const std::string &word, uint32_t frequency);
+
+        /**
+         * @brief Remove word from trie and prune branches left empty
+         * @param root Root of the trie
+         * @param word Word to remove
+         * @return Bytes released by pruned nodes
+         */
+        static size_t removeFromTrie(TrieNode *root, const std::string &word);
 
         /**
          * @brief Collect all words with given prefix from trie
@@ -86,11 +197,29 @@ namespace spellcheck
 
         /**
          * @brief Load dictionary from file
+         *
+         * The file is read in one shot and its lines are parsed on several
+         * threads. Each thread then builds the hash tables, trie branches and
+         * phonetic buckets for its share of first letters, and the partitions
+         * are spliced together. Malformed lines are skipped and recorded in
+         * getLoadErrors().
          * @param file_path Path to dictionary file
          * @return true if successful, false otherwise
          */
         bool loadFromFile(const std::string &file_path);
 
+        /**
+         * @brief Get lines skipped by the last loadFromFile call
+         * @return Parse errors with line numbers
+         */
+        const std::vector<LoadError> &getLoadErrors() const { return load_errors_; }
+
+        /**
+         * @brief Set number of threads used by loadFromFile
+         * @param threads Thread count (0 = hardware concurrency)
+         */
+        void setLoadThreads(size_t threads) { load_threads_ = threads; }
+
         /**
          * @brief Save dictionary to file
          * @param file_path Path to save dictionary
@@ -135,12 +264,61 @@ namespace spellcheck
         std::vector<std::string> getWordsWithPrefix(const std::string &prefix,
                                                     size_t max_results = 100) const;
 
+        /**
+         * @brief Get the trie holding every word, for bounded searches
+         * @return Root node of the trie
+         */
+        const TrieNode *getTrieRoot() const { return trie_root_.get(); }
+
         /**
          * @brief Get words with similar phonetic code
          * @param word Word to find phonetic matches for
-         * @return Vector of phonetically similar words
+         * @return View of phonetically similar words, valid until the
+         *         dictionary is next modified
+         */
+        PhoneticMatches getPhoneticMatches(const std::string &word) const;
+
+        /**
+         * @brief Check whether two words share a phonetic code
+         * @param word First word
+         * @param other Second word
+         * @return true if getPhoneticMatches(word) would list other
+         */
+        bool soundsAlike(const std::string &word, const std::string &other) const;
+
+        /**
+         * @brief Select the phonetic encoder, re-indexing existing words
+         * @param algorithm Phonetic algorithm
+         */
+        void setPhoneticAlgorithm(PhoneticAlgorithm algorithm);
+
+        /**
+         * @brief Get the phonetic encoder in use
+         * @return Phonetic algorithm
+         */
+        PhoneticAlgorithm getPhoneticAlgorithm() const { return phonetic_algorithm_; }
+
+        /**
+         * @brief Get the phonetic bucket size distribution
+         * @return Bucket statistics
+         */
+        PhoneticBucketStats getPhoneticStats() const { return phonetic_index_.getBucketStats(); }
+
+        /**
+         * @brief Freeze the dictionary into a read-only perfect-hash index
+         *
+         * The hash set and frequency map are released; lookups are served
+         * from flat fingerprint and frequency arrays. Words added after
+         * freezing are kept in a small mutable overlay.
+         * @return true if successful, false otherwise
+         */
+        bool freeze();
+
+        /**
+         * @brief Check if dictionary is frozen
+         * @return true if lookups are served by the perfect-hash index
          */
-        std::vector<std::string> getPhoneticMatches(const std::string &word) const;
+        bool isFrozen() const { return static_index_ != nullptr; }
 
         /**
          * @brief Get all words in dictionary
@@ -148,12 +326,36 @@ namespace spellcheck
          */
         std::vector<std::string> getAllWords() const;
 
+        /**
+         * @brief Hash the words and their frequencies, independent of insertion order
+         *
+         * Maintained as words are loaded, added and removed, so this is O(1).
+         * @return Content hash; equal dictionaries hash equally
+         */
+        uint64_t contentHash() const;
+
         /**
          * @brief Get dictionary statistics
          * @return Pair of (word count, memory usage)
          */
         std::pair<size_t, size_t> getStats() const;
 
+        /**
+         * @brief Get per-structure memory usage
+         * @return Memory statistics
+         */
+        MemoryStats getMemoryStats() const;
+
+        /**
+         * @brief Rebuild all structures densely from the live words
+         *
+         * After many add/remove cycles the hash tables keep their peak bucket
+         * arrays and trie nodes keep oversized child maps. Compaction rebuilds everything at its
+         * current size; a frozen dictionary is re-frozen with its overlay
+         * folded into the index.
+         */
+        void compact();
+
         /**
          * @brief Clear all words from dictionary
          */
@@ -0,0 +1,109 @@
+#ifndef DIRECTORY_WATCHER_H
+#define DIRECTORY_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+#include "file_source.h"
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Files written, created or removed under a watched directory
+     */
+    struct WatchEvents
+    {
+        std::vector<std::string> changed; // Written, created or moved in; sorted
+        std::vector<std::string> removed; // Deleted or moved away; sorted
+        bool rescan = false;              // Events were lost; every file may have changed
+    };
+
+    /**
+     * @brief Reports changes to the files of directory trees, using inotify
+     *
+     * Every directory of a tree is watched, except those the filter
+     * ignores; directories created later are watched as they appear.
+     * A burst of events, such as an editor's save or a checkout, is
+     * gathered until no event has arrived for the debounce interval and
+     * reported once, each file at most once. Only files the filter
+     * accepts are reported.
+     */
+    class DirectoryWatcher
+    {
+    private:
+        int fd_;
+        FileFilter filter_;
+        std::unordered_map<int, std::string> directories_; // Watch descriptor to directory path
+
+        /**
+         * @brief Watch a directory and every directory below it
+         * @param directory Directory to watch
+         * @param found Receives accepted files already in the new directories, if not null
+         * @return false if the directory could not be watched
+         */
+        bool addTree(const std::string &directory, std::vector<std::string> *found);
+
+        /**
+         * @brief Read the events that are ready
+         * @param changed Receives written or created files
+         * @param removed Receives deleted files
+         * @param rescan Set if the kernel dropped events
+         */
+        void readEvents(std::vector<std::string> &changed, std::vector<std::string> &removed, bool &rescan);
+
+        /**
+         * @brief Check if a file should be reported
+         * @param file_path Path to file
+         * @return true if the filter accepts it
+         */
+        bool accepts(const std::string &file_path) const;
+
+        /**
+         * @brief Check if a directory is left unwatched
+         * @param name Directory name
+         * @return true if it matches an ignored directory pattern
+         */
+        bool ignoresDirectory(const std::string &name) const;
+
+    public:
+        /**
+         * @brief Constructor
+         * @param filter Rules for which files and directories are watched
+         */
+        explicit DirectoryWatcher(const FileFilter &filter);
+
+        /**
+         * @brief Destructor
+         */
+        ~DirectoryWatcher();
+
+        // Delete copy constructor and assignment operator
+        DirectoryWatcher(const DirectoryWatcher &) = delete;
+        DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+
+        /**
+         * @brief Start watching a directory tree
+         * @param directory Directory to watch
+         * @return true if successful, false otherwise
+         */
+        bool watch(const std::string &directory);
+
+        /**
+         * @brief Wait for the next burst of changes
+         *
+         * SIGINT and SIGTERM are let through while waiting, even if the
+         * caller blocks them, so a caller that blocks them and installs
+         * handlers is woken by them and never interrupted elsewhere.
+         * @param debounce Quiet time that ends a burst
+         * @param events Receives the changes
+         * @return false if a signal arrived or watching failed
+         */
+        bool waitForChanges(std::chrono::milliseconds debounce, WatchEvents &events);
+    };
+
+} // namespace spellcheck
+
+#endif // DIRECTORY_WATCHER_H
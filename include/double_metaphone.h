@@ -0,0 +1,33 @@
+#ifndef DOUBLE_METAPHONE_H
+#define DOUBLE_METAPHONE_H
+
+#include <string>
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Primary and alternate Double Metaphone keys of a word
+     *
+     * Keys use the symbols A (initial vowel), B, F, H, J, K, L, M, N, P, R,
+     * S, T, X ("sh") and 0 ("th"). The alternate key equals the primary one
+     * unless the word has a second plausible pronunciation.
+     */
+    struct MetaphoneKeys
+    {
+        std::string primary;
+        std::string alternate;
+    };
+
+    /**
+     * @brief Encode a word with Lawrence Philips' Double Metaphone algorithm
+     * @param word Input word (case-insensitive; non-letters are skipped)
+     * @param max_length Maximum key length
+     * @return Primary and alternate keys
+     */
+    MetaphoneKeys doubleMetaphone(const std::string &word, size_t max_length = 4);
+
+} // namespace spellcheck
+
+#endif // DOUBLE_METAPHONE_H
@@ -0,0 +1,139 @@
+#ifndef FILE_SOURCE_H
+#define FILE_SOURCE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Read-only access to a file's bytes without intermediate copies
+     *
+     * Regular files are memory-mapped and their bytes handed out as views
+     * of the mapping. Pipes, terminals and other files that cannot be
+     * mapped are read through a buffer instead. Views stay valid until
+     * the next call that produces one, or until the source is closed.
+     */
+    class FileSource
+    {
+    private:
+        int fd_;
+        const char *data_; // Mapping of a regular file, or nullptr
+        size_t size_;      // Size of the mapping
+        size_t offset_;    // Next mapped byte to hand out
+        std::vector<char> buffer_;
+        bool failed_;
+
+        /**
+         * @brief Unmap and close the current file
+         */
+        void close();
+
+        /**
+         * @brief Read one block from the file into buffer_
+         * @param append true to keep what buffer_ already holds
+         * @param max_bytes Largest number of bytes to read
+         * @return Number of bytes read, 0 at end of input or on error
+         */
+        size_t readIntoBuffer(bool append, size_t max_bytes);
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        FileSource();
+
+        /**
+         * @brief Destructor
+         */
+        ~FileSource();
+
+        // Delete copy constructor and assignment operator
+        FileSource(const FileSource &) = delete;
+        FileSource &operator=(const FileSource &) = delete;
+
+        /**
+         * @brief Open a file, mapping it when it is a regular file
+         * @param file_path Path to file
+         * @return true if successful, false otherwise
+         */
+        bool open(const std::string &file_path);
+
+        /**
+         * @brief Get the next chunk of the file
+         *
+         * Mapped files are handed out in large windows; pages of windows
+         * already consumed are released, so resident memory stays bounded
+         * however large the file is.
+         * @param chunk Receives the chunk
+         * @return false at the end of the file or on a read error
+         */
+        bool next(std::string_view &chunk);
+
+        /**
+         * @brief Get the whole (remaining) file at once
+         * @param contents Receives the contents
+         * @return false on a read error
+         */
+        bool readAll(std::string_view &contents);
+
+        /**
+         * @brief Check if the open file is memory-mapped
+         * @return true if mapped
+         */
+        bool isMapped() const { return data_ != nullptr; }
+
+        /**
+         * @brief Check if a read failed
+         * @return true after a read error
+         */
+        bool failed() const { return failed_; }
+
+        /**
+         * @brief Check if a path names an existing file, without opening it
+         * @param file_path Path to check
+         * @return true if the path exists and is not a directory
+         */
+        static bool exists(const std::string &file_path);
+    };
+
+    /**
+     * @brief Which files a directory walk picks up ([File_Processing] settings)
+     */
+    struct FileFilter
+    {
+        std::vector<std::string> extensions;         // Accepted extensions such as ".md" (empty = all)
+        std::vector<std::string> ignore_files;       // Wildcard patterns matched against file names
+        std::vector<std::string> ignore_directories; // Directory names not descended into
+        size_t max_file_size = 0;                    // In bytes (0 = no limit)
+    };
+
+    /**
+     * @brief Expand files and directories into the list of files to check
+     *
+     * Directories are walked recursively and their files filtered;
+     * files named directly are always kept. Files found in one
+     * directory are sorted, so the order does not depend on the
+     * filesystem.
+     * @param paths Files and directories
+     * @param filter Rules applied to files found in directories
+     * @return Paths of the files to check
+     */
+    std::vector<std::string> collectFiles(const std::vector<std::string> &paths, const FileFilter &filter);
+
+    /**
+     * @brief Apply a filter's name rules to a path that may not exist on disk
+     *
+     * Used for paths named by a diff. The size limit is not applied.
+     * @param path Relative or absolute file path
+     * @param filter Rules for extensions, file names and directory names
+     * @return true if a directory walk would have picked the file up
+     */
+    bool acceptsPath(const std::string &path, const FileFilter &filter);
+
+} // namespace spellcheck
+
+#endif // FILE_SOURCE_H
@@ -0,0 +1,37 @@
+#ifndef HASH_UTIL_H
+#define HASH_UTIL_H
+
+#include <cstdint>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Scramble a 64-bit value so every input bit affects every output bit
+     * @param x Value to mix
+     * @return Mixed value (the splitmix64 finalizer)
+     */
+    inline uint64_t mix64(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    /**
+     * @brief Fold one more value into a running hash
+     * @param hash Hash so far
+     * @param value Value to add
+     * @return New hash, which depends on the order values were added in
+     */
+    inline uint64_t combineHash(uint64_t hash, uint64_t value)
+    {
+        return mix64(hash ^ (value + 0x9e3779b97f4a7c15ULL));
+    }
+
+} // namespace spellcheck
+
+#endif // HASH_UTIL_H
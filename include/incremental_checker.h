@@ -0,0 +1,73 @@
+#ifndef INCREMENTAL_CHECKER_H
+#define INCREMENTAL_CHECKER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+#include "spell_checker.h"
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Re-checks edited files, tokenizing only the lines that changed where possible
+     *
+     * The contents and misspellings of each file checked are kept. When
+     * a plain-text file is checked again, the lines it shares with the
+     * previous version at its start and end are not tokenized again:
+     * their misspellings are carried over, moved by the number of lines
+     * added or removed in between. Formats whose constructs span lines
+     * (comments, code blocks, markup) are checked in full, as are all
+     * files when a context model needs every misspelling's neighbours.
+     */
+    class IncrementalChecker
+    {
+    private:
+        struct FileState
+        {
+            std::string contents;
+            std::vector<Misspelling> misspellings;
+        };
+
+        const SpellChecker &checker_;
+        std::unordered_map<std::string, FileState> files_;
+        size_t lines_checked_; // Lines tokenized by the last check
+
+    public:
+        /**
+         * @brief Constructor
+         * @param checker Spell checker to check with; must outlive this object
+         */
+        explicit IncrementalChecker(const SpellChecker &checker);
+
+        /**
+         * @brief Check a file, reusing the results of its previous version
+         * @param file_path Path to file
+         * @param misspellings Receives the file's misspellings
+         * @return false if the file could not be read
+         */
+        bool check(const std::string &file_path, std::vector<Misspelling> &misspellings);
+
+        /**
+         * @brief Drop what is kept about a file (it was deleted)
+         * @param file_path Path to file
+         */
+        void forget(const std::string &file_path) { files_.erase(file_path); }
+
+        /**
+         * @brief Drop what is kept about every file (the dictionaries or settings changed)
+         */
+        void clear() { files_.clear(); }
+
+        /**
+         * @brief Get the number of lines the last check tokenized
+         * @return Line count
+         */
+        size_t getLinesChecked() const { return lines_checked_; }
+    };
+
+} // namespace spellcheck
+
+#endif // INCREMENTAL_CHECKER_H
@@ -0,0 +1,58 @@
+#ifndef KEYBOARD_LAYOUT_H
+#define KEYBOARD_LAYOUT_H
+
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Keyboard layout used to weight substitution typos
+     */
+    enum class KeyboardLayout
+    {
+        Qwerty,
+        Dvorak
+    };
+
+    /**
+     * @brief Substitution cost between every pair of letters on one layout
+     *
+     * Costs are 0 for the same letter, 0.5 for neighbouring keys, 0.8 for
+     * keys two apart and 1 otherwise. The tables are generated at compile
+     * time from the key rows of each layout.
+     */
+    struct KeyboardCostTable
+    {
+        float cost[26][26];
+
+        /**
+         * @brief Cost of typing one character in place of another
+         * @param a Intended character
+         * @param b Typed character
+         * @return Substitution cost (1 for anything but two lowercase letters)
+         */
+        float substitution(char a, char b) const
+        {
+            if (a == b)
+            {
+                return 0.0f;
+            }
+            if (a < 'a' || a > 'z' || b < 'a' || b > 'z')
+            {
+                return 1.0f;
+            }
+            return cost[a - 'a'][b - 'a'];
+        }
+    };
+
+    /**
+     * @brief Get the precomputed cost table for a layout
+     * @param layout Keyboard layout
+     * @return Cost table with static storage duration
+     */
+    const KeyboardCostTable &keyboardCostTable(KeyboardLayout layout);
+
+} // namespace spellcheck
+
+#endif // KEYBOARD_LAYOUT_H
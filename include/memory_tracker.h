@@ -0,0 +1,84 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Bytes malloc hands out for a request (glibc: 8-byte header,
+     *        16-byte granularity, 32-byte minimum chunk)
+     */
+    inline size_t allocationSize(size_t bytes)
+    {
+        return std::max<size_t>(32, (bytes + sizeof(size_t) + 15) & ~static_cast<size_t>(15));
+    }
+
+    /**
+     * @brief Heap bytes owned by a string beyond its inline buffer
+     */
+    inline size_t stringHeapBytes(const std::string &text)
+    {
+        static const size_t inline_capacity = std::string().capacity();
+        return text.capacity() > inline_capacity ? allocationSize(text.capacity() + 1) : 0;
+    }
+
+    /**
+     * @brief Heap bytes of a vector's element buffer
+     */
+    template <typename T>
+    size_t vectorBufferBytes(const std::vector<T> &items)
+    {
+        return items.capacity() > 0 ? allocationSize(items.capacity() * sizeof(T)) : 0;
+    }
+
+    /**
+     * @brief Heap bytes of a hash container's bucket array
+     */
+    template <typename Container>
+    size_t bucketBytes(const Container &container)
+    {
+        // A single bucket lives inside the container object
+        return container.bucket_count() > 1 ? allocationSize(container.bucket_count() * sizeof(void *)) : 0;
+    }
+
+    /**
+     * @brief Heap bytes of one hash node: next pointer, value and,
+     *        for keys with slow hash functions, the cached hash code
+     */
+    template <typename Value, bool CachedHash>
+    size_t hashNodeBytes()
+    {
+        return allocationSize(sizeof(void *) + sizeof(Value) + (CachedHash ? sizeof(size_t) : 0));
+    }
+
+    /**
+     * @brief Process-wide heap counter used to cross-check memory statistics
+     *
+     * When built with SPELLCHECK_TRACK_ALLOCATIONS, the global operator new
+     * and delete are replaced by versions that keep a running total of live
+     * heap bytes. Otherwise the counter is always zero.
+     */
+    class MemoryTracker
+    {
+    public:
+        /**
+         * @brief Check if allocation tracking is compiled in
+         * @return true if allocations are counted
+         */
+        static bool isEnabled();
+
+        /**
+         * @brief Get bytes currently allocated through operator new
+         * @return Live heap bytes (0 if tracking is disabled)
+         */
+        static size_t currentBytes();
+    };
+
+} // namespace spellcheck
+
+#endif // MEMORY_TRACKER_H
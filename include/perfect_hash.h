@@ -0,0 +1,116 @@
+#ifndef PERFECT_HASH_H
+#define PERFECT_HASH_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Read-only minimal perfect hash over a fixed word list (CHD-style)
+     *
+     * Words are hashed into small buckets; each bucket stores one displacement
+     * value that places all of its words into distinct slots of a table with
+     * exactly one slot per word. Slots hold a 32-bit fingerprint and the word
+     * frequency in flat arrays, so the word strings themselves are not stored.
+     * A word that was never inserted is rejected by its fingerprint, with a
+     * false-positive probability of about 2^-32.
+     */
+    class PerfectHashIndex
+    {
+    private:
+        std::vector<uint32_t> displacements_; // One entry per bucket
+        std::vector<uint32_t> fingerprints_;  // One entry per slot (0 = empty)
+        std::vector<uint32_t> frequencies_;   // One entry per slot
+        uint64_t seed_;
+        size_t size_;
+
+        /**
+         * @brief Hash a word with the index seed
+         * @param word Word to hash
+         * @return 64-bit hash
+         */
+        uint64_t hashWord(const std::string &word) const;
+
+        /**
+         * @brief Locate the slot a word maps to
+         * @param hash Hash of the word
+         * @return Slot index
+         */
+        size_t slotFor(uint64_t hash) const;
+
+        /**
+         * @brief Derive the stored fingerprint from a word hash
+         * @param hash Hash of the word
+         * @return Non-zero fingerprint
+         */
+        static uint32_t fingerprintFor(uint64_t hash);
+
+        /**
+         * @brief Try to build the table with the current seed
+         * @param entries Words and frequencies to place
+         * @return true if every bucket could be placed
+         */
+        bool tryBuild(const std::vector<std::pair<std::string, uint32_t>> &entries);
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        PerfectHashIndex();
+
+        /**
+         * @brief Build the index from a list of unique words
+         * @param entries Words with their frequencies
+         * @return true if successful, false otherwise
+         */
+        bool build(const std::vector<std::pair<std::string, uint32_t>> &entries);
+
+        /**
+         * @brief Check if word is present in the index
+         * @param word Normalized word
+         * @return true if word is present
+         */
+        bool contains(const std::string &word) const;
+
+        /**
+         * @brief Get word frequency
+         * @param word Normalized word
+         * @return Word frequency (0 if not found)
+         */
+        uint32_t frequency(const std::string &word) const;
+
+        /**
+         * @brief Update the frequency of a word already in the index
+         * @param word Normalized word
+         * @param frequency New frequency
+         * @return true if the word was present
+         */
+        bool setFrequency(const std::string &word, uint32_t frequency);
+
+        /**
+         * @brief Mark a word as removed
+         * @param word Normalized word
+         * @return true if the word was present
+         */
+        bool erase(const std::string &word);
+
+        /**
+         * @brief Get number of live words in the index
+         * @return Number of words
+         */
+        size_t size() const { return size_; }
+
+        /**
+         * @brief Get memory used by the flat arrays
+         * @return Memory usage in bytes
+         */
+        size_t memoryUsage() const;
+    };
+
+} // namespace spellcheck
+
+#endif // PERFECT_HASH_H
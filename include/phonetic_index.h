@@ -0,0 +1,245 @@
+#ifndef PHONETIC_INDEX_H
+#define PHONETIC_INDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+
+namespace spellcheck
+{
+
+    class PhoneticIndex;
+
+    /**
+     * @brief Primary and alternate phonetic codes of a word
+     *
+     * Encoders with a single code per word set both fields to the same value.
+     */
+    struct PhoneticCodes
+    {
+        uint16_t primary;
+        uint16_t alternate;
+    };
+
+    /**
+     * @brief A word with its phonetic codes, as passed to PhoneticIndex::build
+     */
+    struct PhoneticEntry
+    {
+        PhoneticCodes codes;
+        std::string word;
+    };
+
+    /**
+     * @brief Bucket size distribution of a phonetic index
+     */
+    struct PhoneticBucketStats
+    {
+        size_t buckets = 0;     // Non-empty buckets
+        size_t entries = 0;     // Words summed over buckets (alternates count twice)
+        size_t largest = 0;     // Size of the largest bucket
+        size_t median = 0;      // Median non-empty bucket size
+        size_t p99 = 0;         // 99th percentile non-empty bucket size
+    };
+
+    /**
+     * @brief Read-only view of the words matching a word's phonetic codes
+     *
+     * The view refers to the index it came from and is invalidated by the
+     * next insert, erase or rebuild on that index. Each word is yielded
+     * once, even if it sits in both the primary and alternate bucket.
+     */
+    class PhoneticMatches
+    {
+    public:
+        /**
+         * @brief Forward iterator yielding the words of the view
+         */
+        class iterator
+        {
+        private:
+            const PhoneticMatches *view_;
+            size_t span_;
+            const uint32_t *current_;
+
+            /**
+             * @brief Advance past exhausted spans and removed words
+             */
+            void skipDead();
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string *;
+            using reference = const std::string &;
+
+            iterator(const PhoneticMatches *view, size_t span, const uint32_t *current);
+
+            const std::string &operator*() const;
+            iterator &operator++();
+            bool operator==(const iterator &other) const { return span_ == other.span_ && current_ == other.current_; }
+            bool operator!=(const iterator &other) const { return !(*this == other); }
+        };
+
+        PhoneticMatches() : index_(nullptr), span_count_(0), alternate_span_(0), primary_code_(0) {}
+
+        iterator begin() const { return iterator(this, 0, span_count_ ? spans_[0].first : nullptr); }
+        iterator end() const { return iterator(this, span_count_, nullptr); }
+
+        /**
+         * @brief Check if the view holds no words
+         * @return true if there are no matches
+         */
+        bool empty() const { return begin() == end(); }
+
+    private:
+        friend class PhoneticIndex;
+
+        // Built and pending part of the primary and alternate buckets
+        static constexpr size_t kMaxSpans = 4;
+
+        const PhoneticIndex *index_;
+        std::pair<const uint32_t *, const uint32_t *> spans_[kMaxSpans];
+        size_t span_count_;
+        size_t alternate_span_; // First span of the alternate bucket
+        uint16_t primary_code_;
+
+        /**
+         * @brief Check if the id at a position should be yielded
+         * @param span Span index
+         * @param id Word id
+         * @return true if the word is live and not a repeat
+         */
+        bool accepts(size_t span, uint32_t id) const;
+
+        /**
+         * @brief Append a range of word ids to the view
+         * @param first First id
+         * @param last One past the last id
+         */
+        void addSpan(const uint32_t *first, const uint32_t *last);
+    };
+
+    /**
+     * @brief Phonetic buckets keyed by packed 16-bit codes
+     *
+     * Words are numbered and each bucket is a run of word ids in one flat
+     * array, located by binary search over the sorted distinct codes
+     * (compressed sparse row layout). Insertions go to small pending buckets
+     * and removals leave dead ids behind; both are folded into the flat
+     * array once they grow past a fraction of the index, so the amortized
+     * cost per update stays constant.
+     */
+    class PhoneticIndex
+    {
+    private:
+        friend class PhoneticMatches;
+
+        std::vector<std::string> words_;        // Word by id (empty = removed)
+        std::vector<PhoneticCodes> word_codes_; // Codes by id
+        std::vector<uint16_t> codes_;           // Distinct codes in ascending order
+        std::vector<uint32_t> offsets_;         // Start of each code's run in ids_, plus the end
+        std::vector<uint32_t> ids_;        // Word ids grouped by code
+        std::unordered_map<uint16_t, std::vector<uint32_t>> pending_; // Ids added since the last build
+        size_t pending_count_;
+        size_t dead_count_;
+        size_t memory_; // String heaps and pending buckets, maintained incrementally
+
+        /**
+         * @brief Find the id of a word with the given primary code
+         * @param word Word to find
+         * @param code Primary phonetic code of the word
+         * @return Word id, or words_.size() if absent
+         */
+        size_t findId(const std::string &word, uint16_t code) const;
+
+        /**
+         * @brief Add an id to the pending bucket of a code
+         * @param code Phonetic code
+         * @param id Word id
+         */
+        void addPending(uint16_t code, uint32_t id);
+
+        /**
+         * @brief Append the built and pending runs of a code to a view
+         * @param matches View to extend
+         * @param code Phonetic code
+         */
+        void appendSpans(PhoneticMatches &matches, uint16_t code) const;
+
+        /**
+         * @brief Fold pending ids into the flat array and drop removed words
+         */
+        void rebuild();
+
+        /**
+         * @brief Rebuild if pending or removed ids have piled up
+         */
+        void maybeRebuild();
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        PhoneticIndex();
+
+        /**
+         * @brief Replace the contents with the given words
+         * @param entries Words with their codes; words must be unique
+         */
+        void build(std::vector<PhoneticEntry> entries);
+
+        /**
+         * @brief Add a word; words already present are left alone
+         * @param word Normalized word
+         * @param codes Phonetic codes of the word
+         */
+        void insert(const std::string &word, PhoneticCodes codes);
+
+        /**
+         * @brief Remove a word
+         * @param word Normalized word
+         * @param codes Phonetic codes of the word
+         * @return true if the word was present
+         */
+        bool erase(const std::string &word, PhoneticCodes codes);
+
+        /**
+         * @brief Get the words sharing either code
+         * @param codes Phonetic codes to look up
+         * @return View of the matching words
+         */
+        PhoneticMatches find(PhoneticCodes codes) const;
+
+        /**
+         * @brief Get the bucket size distribution
+         * @return Bucket statistics
+         */
+        PhoneticBucketStats getBucketStats() const;
+
+        /**
+         * @brief Remove all words
+         */
+        void clear();
+
+        /**
+         * @brief Get number of live words
+         * @return Number of words
+         */
+        size_t size() const { return words_.size() - dead_count_; }
+
+        /**
+         * @brief Get heap memory used by the index
+         * @return Memory usage in bytes
+         */
+        size_t memoryUsage() const;
+    };
+
+} // namespace spellcheck
+
+#endif // PHONETIC_INDEX_H
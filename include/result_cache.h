@@ -0,0 +1,168 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+#include "spell_checker.h"
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Modification time and size of a file, compared before hashing it
+     */
+    struct FileStamp
+    {
+        int64_t mtime_ns = 0;
+        uint64_t size = 0;
+
+        bool operator==(const FileStamp &other) const { return mtime_ns == other.mtime_ns && size == other.size; }
+
+        /**
+         * @brief Read a file's stamp
+         * @param file_path Path to file
+         * @param stamp Receives the stamp
+         * @return false if the file cannot be examined
+         */
+        static bool read(const std::string &file_path, FileStamp &stamp);
+    };
+
+    /**
+     * @brief Incremental 64-bit hash of file contents
+     *
+     * The result does not depend on how the contents are split into chunks.
+     */
+    class ContentHasher
+    {
+    private:
+        uint64_t state_;
+        uint64_t length_;
+        unsigned char tail_[8]; // Bytes not yet making up a whole word
+        size_t tail_size_;
+
+        void mixWord(uint64_t word);
+
+    public:
+        ContentHasher();
+
+        /**
+         * @brief Add the next bytes of the contents
+         * @param bytes Bytes to add
+         */
+        void update(std::string_view bytes);
+
+        /**
+         * @brief Get the hash of everything added so far
+         * @return Hash
+         */
+        uint64_t digest() const;
+    };
+
+    /**
+     * @brief Misspellings found in each file by earlier runs
+     *
+     * Entries are keyed by path and remember the file's stamp and
+     * content hash; the whole cache carries a fingerprint of the
+     * dictionaries and checking settings. A file whose stamp is
+     * unchanged is not read at all; a file whose stamp changed but whose
+     * contents hash the same is not tokenized again. A stamp taken
+     * within a second of the file's last change is not kept, since the
+     * file could change again without its timestamp moving; such files
+     * are hashed next time. Lookups and updates may run on several threads.
+     */
+    class ResultCache
+    {
+    private:
+        struct Entry
+        {
+            FileStamp stamp;
+            uint64_t content_hash = 0;
+            std::vector<Misspelling> misspellings;
+        };
+
+        std::string path_;
+        std::unordered_map<std::string, Entry> entries_;
+        mutable std::mutex mutex_;
+        bool dirty_;
+
+        /**
+         * @brief Record a file's stamp unless it is too recent to be trusted
+         * @param entry Entry to update
+         * @param stamp Stamp read before the file was read
+         */
+        static void setStamp(Entry &entry, const FileStamp &stamp);
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        ResultCache();
+
+        /**
+         * @brief Read the cache file, keeping its entries if they were made with the same fingerprint
+         *
+         * A missing file is not an error; it is created by save.
+         * @param file_path Path to cache file
+         * @param fingerprint Fingerprint of the current dictionaries and settings
+         * @return Number of usable entries
+         */
+        size_t load(const std::string &file_path, uint64_t fingerprint);
+
+        /**
+         * @brief Write the cache file if anything changed, dropping files that no longer exist
+         * @param fingerprint Fingerprint of the dictionaries and settings the entries were made with
+         * @return true if successful, false otherwise
+         */
+        bool save(uint64_t fingerprint);
+
+        /**
+         * @brief Get a file's misspellings if its stamp shows it is unchanged
+         * @param file_path Path to file
+         * @param stamp Current stamp of the file
+         * @param misspellings Receives the stored misspellings on a hit
+         * @return true on a hit
+         */
+        bool lookup(const std::string &file_path, const FileStamp &stamp, std::vector<Misspelling> &misspellings) const;
+
+        /**
+         * @brief Get a file's misspellings if its contents are unchanged, and record its new stamp
+         * @param file_path Path to file
+         * @param stamp Current stamp of the file
+         * @param content_hash Hash of the current contents
+         * @param misspellings Receives the stored misspellings on a hit
+         * @return true on a hit
+         */
+        bool lookup(const std::string &file_path, const FileStamp &stamp, uint64_t content_hash,
+                    std::vector<Misspelling> &misspellings);
+
+        /**
+         * @brief Store the misspellings found in a file
+         * @param file_path Path to file
+         * @param stamp Stamp read before the file was read
+         * @param content_hash Hash of the contents that were checked
+         * @param misspellings Misspellings found
+         */
+        void store(const std::string &file_path, const FileStamp &stamp, uint64_t content_hash,
+                   const std::vector<Misspelling> &misspellings);
+
+        /**
+         * @brief Forget every entry (the dictionaries or settings changed)
+         */
+        void clear();
+
+        /**
+         * @brief Check if a cache file was loaded
+         * @return true after load
+         */
+        bool isOpen() const { return !path_.empty(); }
+    };
+
+} // namespace spellcheck
+
+#endif // RESULT_CACHE_H
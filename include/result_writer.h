@@ -0,0 +1,141 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include "spell_checker.h"
+
+namespace spellcheck
+{
+
+    /**
+     * @brief How misspellings are reported on standard output
+     */
+    enum class OutputFormat
+    {
+        Text,      // Human-readable lines
+        JsonLines, // One JSON object per misspelling
+        Sarif      // One SARIF 2.1.0 log, for code-scanning tools
+    };
+
+    /**
+     * @brief Parse the name of an output format
+     * @param name "text", "jsonl" or "sarif"
+     * @param format Receives the format
+     * @return false if the name is not recognized
+     */
+    bool parseOutputFormat(const std::string &name, OutputFormat &format);
+
+    /**
+     * @brief Writes misspellings in a machine-readable format as they are found
+     *
+     * Records are formatted by hand into one reusable buffer, which is
+     * written to the file descriptor whenever it fills, so output starts
+     * before checking ends and memory use does not grow with the number
+     * of misspellings. Nothing else may write to the descriptor while
+     * the writer is in use.
+     */
+    class ResultWriter
+    {
+    private:
+        int fd_;
+        bool failed_;
+
+    protected:
+        std::string buffer_;
+        size_t suggestions_per_word_;
+
+        /**
+         * @brief Append a number
+         * @param value Number to append
+         */
+        void appendNumber(size_t value);
+
+        /**
+         * @brief Append a quoted JSON string; invalid UTF-8 becomes U+FFFD
+         * @param text Text to append
+         */
+        void appendJsonString(std::string_view text);
+
+        /**
+         * @brief Append text escaped for use inside a JSON string, without quotes
+         * @param text Text to append
+         */
+        void appendJsonText(std::string_view text);
+
+        /**
+         * @brief Append a file path as a quoted, percent-encoded URI reference
+         * @param path File path
+         */
+        void appendUri(std::string_view path);
+
+        /**
+         * @brief Write the buffer out if it has filled
+         */
+        void commit();
+
+    public:
+        /**
+         * @brief Constructor
+         * @param fd File descriptor to write to; left open
+         * @param suggestions_per_word Most suggestions written per misspelling
+         */
+        ResultWriter(int fd, size_t suggestions_per_word);
+
+        /**
+         * @brief Destructor; writes out what is left in the buffer
+         */
+        virtual ~ResultWriter();
+
+        // Delete copy constructor and assignment operator
+        ResultWriter(const ResultWriter &) = delete;
+        ResultWriter &operator=(const ResultWriter &) = delete;
+
+        /**
+         * @brief Start the output, before any misspelling is written
+         */
+        virtual void begin() {}
+
+        /**
+         * @brief Write one misspelling
+         * @param path File the misspelling is in
+         * @param misspelling Misspelling
+         * @param suggestions Suggested corrections, best first
+         */
+        virtual void write(const std::string &path, const Misspelling &misspelling,
+                           const std::vector<std::string> &suggestions) = 0;
+
+        /**
+         * @brief Finish the output, after the last misspelling is written
+         */
+        virtual void end() {}
+
+        /**
+         * @brief Write every misspelling of a checked file
+         * @param result File result with its suggestions filled in
+         */
+        void writeFile(const FileCheckResult &result);
+
+        /**
+         * @brief Write out the buffer
+         * @return false if writing to the descriptor has failed
+         */
+        bool flush();
+
+        /**
+         * @brief Create a writer for a machine-readable format
+         * @param format JsonLines or Sarif
+         * @param fd File descriptor to write to
+         * @param suggestions_per_word Most suggestions written per misspelling
+         * @return New writer, or null for Text
+         */
+        static std::unique_ptr<ResultWriter> create(OutputFormat format, int fd, size_t suggestions_per_word);
+    };
+
+} // namespace spellcheck
+
+#endif // RESULT_WRITER_H
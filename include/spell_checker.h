@@ -2,6 +2,7 @@
 #define SPELL_CHECKER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -12,6 +13,8 @@
 #include <iostream>
 #include <cctype>
 #include <functional>
+#include <chrono>
+#include <cstdint>
 
 namespace spellcheck
 {
@@ -20,6 +23,86 @@ namespace spellcheck
     class Dictionary;
     class SuggestionEngine;
     class TextProcessor;
+    class Config;
+    class BigramModel;
+    class ThreadPool;
+    class SuggestionCache;
+    class SuggestionStore;
+    class ResultCache;
+    struct SuggestionCacheStats;
+    struct DiffFile;
+    struct SuggestionResult;
+    struct MemoryStats;
+    struct PhoneticBucketStats;
+    enum class PhoneticAlgorithm;
+    enum class DocumentFormat;
+
+    /**
+     * @brief Lookup structure used for the base and domain dictionaries
+     */
+    enum class DictionaryBackend
+    {
+        HashTable,  // Mutable hash set and frequency map
+        PerfectHash // Frozen minimal perfect hash (see Dictionary::freeze)
+    };
+
+    /**
+     * @brief A misspelled word with its position and neighbouring words
+     */
+    struct Misspelling
+    {
+        std::string word;
+        size_t line;
+        size_t column;        // 1-based, in characters
+        std::string previous; // Word before it in the text (empty at the start)
+        std::string next;     // Word after it in the text (empty at the end)
+    };
+
+    // Receives each misspelling as it is found; returning false stops the check
+    using MisspellingVisitor = std::function<bool(const Misspelling &)>;
+
+    /**
+     * @brief Suggestions for a list of misspellings, computed once per distinct word
+     */
+    struct SuggestionBatch
+    {
+        std::unordered_map<std::string, std::vector<std::string>> suggestions; // Keyed by key()
+        bool in_context = false; // Keys include the neighbouring words (a context model is loaded)
+        size_t occurrences = 0;  // Misspellings given
+        size_t threads = 0;      // Pool threads available to the batch
+        std::chrono::microseconds wall_time{0};
+        std::chrono::microseconds cpu_time{0}; // Summed over every thread that generated suggestions
+
+        /**
+         * @brief Get the suggestions for one of the misspellings
+         * @param misspelling Misspelling from the list given to the batch
+         * @return Suggested corrections (empty if the misspelling was not in the list)
+         */
+        const std::vector<std::string> &find(const Misspelling &misspelling) const;
+
+        /**
+         * @brief Get the key under which a misspelling's suggestions are stored
+         * @param misspelling Misspelling
+         * @param in_context true if suggestions depend on the neighbouring words
+         * @return Map key
+         */
+        static std::string key(const Misspelling &misspelling, bool in_context);
+    };
+
+    /**
+     * @brief Outcome of checking one file of a batch
+     */
+    struct FileCheckResult
+    {
+        std::string path;
+        std::vector<Misspelling> misspellings;
+        std::vector<std::vector<std::string>> suggestions; // One list per misspelling, when requested
+        bool checked = false;                              // false if the file could not be read
+        bool cached = false;                               // Misspellings replayed from the result cache
+    };
+
+    // Receives each file's result once it is checked
+    using FileResultVisitor = std::function<void(FileCheckResult &)>;
 
     /**
      * @brief Main spell checker class that coordinates all components
@@ -27,15 +110,70 @@ namespace spellcheck
     class SpellChecker
     {
     private:
+        // Dictionary layers: a read-mostly base, optional domain
+        // dictionaries, and a small mutable personal word list
         std::unique_ptr<Dictionary> dictionary_;
+        std::vector<std::unique_ptr<Dictionary>> domain_dictionaries_;
+        std::unique_ptr<Dictionary> personal_dictionary_;
         std::unique_ptr<SuggestionEngine> suggestion_engine_;
         std::unique_ptr<TextProcessor> text_processor_;
+        std::unique_ptr<BigramModel> context_model_;
+        std::unique_ptr<ThreadPool> thread_pool_;
+        std::unique_ptr<SuggestionCache> suggestion_cache_; // nullptr when disabled
+        std::unique_ptr<SuggestionStore> suggestion_store_; // nullptr unless a cache file is open
+        std::unique_ptr<ResultCache> result_cache_;         // nullptr unless a cache file is open
 
         // Configuration options
         bool case_sensitive_;
         bool ignore_numbers_;
         bool ignore_urls_;
         size_t max_suggestions_;
+        DictionaryBackend backend_;
+        PhoneticAlgorithm phonetic_algorithm_;
+        size_t load_threads_;
+        size_t read_depth_;
+        bool use_io_uring_;
+        size_t threads_;
+
+        /**
+         * @brief Check if any dictionary layer contains the word
+         * @param word Normalized word
+         * @return true if word exists in at least one layer
+         */
+        bool containsWord(const std::string &word) const;
+
+        /**
+         * @brief Point the suggestion engine at the current layers
+         */
+        void updateSuggestionLayers();
+
+        /**
+         * @brief Drop cached suggestions after the dictionaries or engine settings change
+         */
+        void invalidateSuggestions();
+
+        /**
+         * @brief Hash the contents of every dictionary layer, in layer order
+         * @return Dictionary hash versioning the suggestion cache file
+         */
+        uint64_t dictionaryHash() const;
+
+        /**
+         * @brief Hash the settings that change which suggestions are produced
+         * @return Settings hash versioning the suggestion cache file
+         */
+        uint64_t settingsHash() const;
+
+        /**
+         * @brief Drop cached file results after the dictionaries or checking settings change
+         */
+        void invalidateResults();
+
+        /**
+         * @brief Hash the dictionaries and the settings that change which words are misspelled
+         * @return Fingerprint versioning the result cache file
+         */
+        uint64_t checkFingerprint() const;
 
     public:
         /**
@@ -61,13 +199,34 @@ namespace spellcheck
         bool loadDictionary(const std::string &dict_path);
 
         /**
-         * @brief Add word to dictionary
+         * @brief Load an additional domain dictionary layer
+         * @param dict_path Path to dictionary file
+         * @return true if successful, false otherwise
+         */
+        bool addDictionary(const std::string &dict_path);
+
+        /**
+         * @brief Load the personal word list layer, keeping words already added to it
+         * @param dict_path Path to personal dictionary file
+         * @return true if successful, false otherwise
+         */
+        bool loadPersonalDictionary(const std::string &dict_path);
+
+        /**
+         * @brief Save the personal word list layer
+         * @param dict_path Path to save personal dictionary
+         * @return true if successful, false otherwise
+         */
+        bool savePersonalDictionary(const std::string &dict_path) const;
+
+        /**
+         * @brief Add word to the personal dictionary layer
          * @param word Word to add
          */
         void addWord(const std::string &word);
 
         /**
-         * @brief Remove word from dictionary
+         * @brief Remove word from every dictionary layer
          * @param word Word to remove
          */
         void removeWord(const std::string &word);
@@ -86,6 +245,48 @@ namespace spellcheck
          */
         std::vector<std::string> getSuggestions(const std::string &word) const;
 
+        /**
+         * @brief Get spelling suggestions within the configured budget
+         * @param word Misspelled word
+         * @return Suggested corrections and whether the search was cut short
+         */
+        SuggestionResult getSuggestionResult(const std::string &word) const;
+
+        /**
+         * @brief Get spelling suggestions reranked by the surrounding words
+         *
+         * Falls back to getSuggestionResult(word) when no context model is loaded.
+         * @param word Misspelled word
+         * @param previous Word before it (empty = none)
+         * @param next Word after it (empty = none)
+         * @return Suggested corrections and whether the search was cut short
+         */
+        SuggestionResult getSuggestionResult(const std::string &word, const std::string &previous,
+                                             const std::string &next) const;
+
+        /**
+         * @brief Get suggestions for every misspelling of a document at once
+         *
+         * Repeated words are looked up once, and distinct words are
+         * spread over the thread pool; the dictionaries are only read.
+         * @param misspellings Misspellings, typically from checkFile
+         * @return Suggestions by word, with timing statistics
+         */
+        SuggestionBatch suggestAll(const std::vector<Misspelling> &misspellings) const;
+
+        /**
+         * @brief Load the bigram model used to rerank suggestions in context
+         * @param model_path Path to model file (see BigramModel)
+         * @return true if successful, false otherwise
+         */
+        bool loadContextModel(const std::string &model_path);
+
+        /**
+         * @brief Check if suggestions are reranked by a context model
+         * @return true if a context model is loaded
+         */
+        bool hasContextModel() const { return context_model_ != nullptr; }
+
         /**
          * @brief Check spelling of entire text
          * @param text Text to check
@@ -96,30 +297,224 @@ namespace spellcheck
         /**
          * @brief Check spelling of file
          * @param file_path Path to file to check
-         * @return Vector of misspelled words with line numbers
+         * @return Misspelled words with line numbers and neighbouring words
+         */
+        std::vector<Misspelling> checkFile(const std::string &file_path) const;
+
+        /**
+         * @brief Check spelling of file, reporting misspellings as they are found
+         *
+         * The file is read in fixed-size blocks, so memory use does not
+         * grow with its size. The format is chosen by extension.
+         * @param file_path Path to file to check
+         * @param visit Called for each misspelling, in document order
+         * @return true if the whole file was checked, false if it could not be read or visit stopped
+         */
+        bool checkFile(const std::string &file_path, const MisspellingVisitor &visit) const;
+
+        /**
+         * @brief Check spelling of a stream, reporting misspellings as they are found
+         * @param input Stream to read until its end
+         * @param format Markup or language of the text
+         * @param visit Called for each misspelling, in document order
+         * @return true if the whole stream was checked, false on a read error or if visit stopped
+         */
+        bool checkStream(std::istream &input, DocumentFormat format, const MisspellingVisitor &visit) const;
+
+        /**
+         * @brief Check spelling of part of a document
+         * @param text Whole lines of the document
+         * @param format Markup or language of the document
+         * @param first_line Line number of the first line of text
+         * @param visit Called for each misspelling, with its line in the document
+         * @return true if the whole text was checked, false if visit stopped
+         */
+        bool checkFragment(std::string_view text, DocumentFormat format, size_t first_line,
+                           const MisspellingVisitor &visit) const;
+
+        /**
+         * @brief Check spelling of many files, overlapping reads with checking
+         *
+         * Files are read concurrently by a BatchReader and each is checked
+         * as a task on the thread pool as soon as its contents arrive.
+         * Suggestions are generated as separate tasks, one per distinct
+         * word of a file (see suggestAll), so a file with a costly word
+         * does not hold up the others. Large files are streamed as in checkFile.
+         * With a result cache open, unchanged files are not checked again.
+         * @param file_paths Files to check
+         * @param with_suggestions true to fill FileCheckResult::suggestions
+         * @return One result per file, in the order given
+         */
+        std::vector<FileCheckResult> checkFiles(const std::vector<std::string> &file_paths,
+                                                bool with_suggestions = false) const;
+
+        /**
+         * @brief Check spelling of many files, handing over each result as soon as it is ready
+         *
+         * Works as the overload returning a vector, but a file's result is
+         * released once visit returns, so memory use does not grow with the
+         * number of misspellings found. Results are handed over in the order
+         * given; one finished early waits only for those before it. visit is
+         * called from pool threads, one call at a time, and may move from
+         * the result.
+         * @param file_paths Files to check
+         * @param with_suggestions true to fill FileCheckResult::suggestions
+         * @param visit Called once for each file
+         */
+        void checkFiles(const std::vector<std::string> &file_paths, bool with_suggestions,
+                        const FileResultVisitor &visit) const;
+
+        /**
+         * @brief Check spelling of only the lines a diff adds
+         *
+         * Misspellings are reported at their line in the new file. Plain
+         * text is tokenized one run of added lines at a time. Other formats
+         * keep state across lines (fences, comments, strings), so when the
+         * new file on disk holds the added lines it is tokenized whole and
+         * only misspellings on added lines are kept; otherwise each run is
+         * tokenized on its own. Files are checked as tasks on the thread pool.
+         * @param files Added lines per file, as read by readUnifiedDiff
+         * @return One result per file, in the order given
          */
-        std::vector<std::tuple<std::string, size_t, size_t>> checkFile(const std::string &file_path) const;
+        std::vector<FileCheckResult> checkDiff(const std::vector<DiffFile> &files) const;
+
+        /**
+         * @brief Apply settings from a configuration file
+         *
+         * Maps the Dictionary, Checking, Suggestions and Performance sections
+         * onto the checker, text processor and suggestion engine, and loads
+         * any additional dictionaries and custom words. The default
+         * dictionary path is left to the caller.
+         * @param config Loaded configuration
+         */
+        void applyConfig(const Config &config);
 
         // Configuration setters
-        void setCaseSensitive(bool sensitive) { case_sensitive_ = sensitive; }
-        void setIgnoreNumbers(bool ignore) { ignore_numbers_ = ignore; }
-        void setIgnoreUrls(bool ignore) { ignore_urls_ = ignore; }
-        void setMaxSuggestions(size_t max_suggestions) { max_suggestions_ = max_suggestions; }
+        void setCaseSensitive(bool sensitive);
+        void setIgnoreNumbers(bool ignore);
+        void setIgnoreUrls(bool ignore);
+        void setIgnoreEmails(bool ignore);
+        void setMinWordLength(size_t length);
+        void setMaxWordLength(size_t length);
+        void setSplitIdentifiers(bool split);
+        void setMaxSuggestions(size_t max_suggestions);
+        void setDictionaryBackend(DictionaryBackend backend) { backend_ = backend; }
+        void setLoadThreads(size_t threads) { load_threads_ = threads; }
+        void setReadDepth(size_t depth) { read_depth_ = depth; }
+        void setUseIoUring(bool use) { use_io_uring_ = use; }
+        void setThreads(size_t threads);
+
+        /**
+         * @brief Enable or disable caching of suggestion lists
+         * @param enable true to cache
+         * @param capacity Largest number of cached words
+         */
+        void setSuggestionCache(bool enable, size_t capacity);
+
+        /**
+         * @brief Reuse suggestions stored by earlier runs and store this run's on flush
+         *
+         * Call after the dictionaries and settings are final; stored
+         * suggestions are only used when both match the file.
+         * @param file_path Path to suggestion cache file (created if missing)
+         * @return Number of stored suggestion lists that can be reused
+         */
+        size_t openSuggestionStore(const std::string &file_path);
+
+        /**
+         * @brief Write suggestions computed since the cache file was opened or last flushed
+         *
+         * Also called by the destructor.
+         * @return true if successful or no cache file is open, false otherwise
+         */
+        bool flushSuggestionStore();
+
+        /**
+         * @brief Let checkFiles skip files that are unchanged since an earlier run
+         *
+         * Call after the dictionaries and settings are final. Files whose
+         * modification time and size are unchanged are not read; files
+         * whose contents hash the same are not checked again.
+         * @param file_path Path to result cache file (created if missing)
+         * @return Number of files with stored results
+         */
+        size_t openResultCache(const std::string &file_path);
+
+        /**
+         * @brief Write the results of files checked since the cache file was opened or last saved
+         *
+         * Also called by the destructor.
+         * @return true if successful or no cache file is open, false otherwise
+         */
+        bool saveResultCache();
+
+        /**
+         * @brief Set the phonetic algorithm used for suggestions by every dictionary layer
+         * @param algorithm Phonetic algorithm
+         */
+        void setPhoneticAlgorithm(PhoneticAlgorithm algorithm);
+
+        /**
+         * @brief Get the suggestion engine for fine-grained tuning
+         *
+         * Cached suggestions are dropped, since the caller may change settings.
+         * @return Suggestion engine
+         */
+        SuggestionEngine &getSuggestionEngine();
+
+        /**
+         * @brief Get the thread pool shared by checking and suggestion tasks
+         * @return Thread pool
+         */
+        ThreadPool &getThreadPool() const { return *thread_pool_; }
 
         // Configuration getters
         bool isCaseSensitive() const { return case_sensitive_; }
         bool ignoreNumbers() const { return ignore_numbers_; }
         bool ignoreUrls() const { return ignore_urls_; }
         size_t getMaxSuggestions() const { return max_suggestions_; }
+        DictionaryBackend getDictionaryBackend() const { return backend_; }
+        PhoneticAlgorithm getPhoneticAlgorithm() const { return phonetic_algorithm_; }
 
         /**
-         * @brief Get dictionary statistics
+         * @brief Get dictionary statistics summed over all layers
          * @return Pair of (word count, memory usage in bytes)
          */
         std::pair<size_t, size_t> getDictionaryStats() const;
 
         /**
-         * @brief Save current dictionary to file
+         * @brief Get per-structure memory usage summed over all layers
+         * @return Memory statistics
+         */
+        MemoryStats getMemoryStats() const;
+
+        /**
+         * @brief Get hit counts and memory usage of the suggestion cache
+         * @return Cache statistics (all zero when caching is disabled)
+         */
+        SuggestionCacheStats getSuggestionCacheStats() const;
+
+        /**
+         * @brief Get phonetic bucket sizes of the base dictionary
+         * @return Bucket statistics
+         */
+        PhoneticBucketStats getPhoneticStats() const;
+
+        /**
+         * @brief Rebuild every dictionary layer densely after heavy churn
+         */
+        void compactDictionaries();
+
+        /**
+         * @brief Freeze the base and domain layers into read-only perfect-hash mode
+         *
+         * The personal layer stays mutable.
+         * @return true if successful, false otherwise
+         */
+        bool freezeDictionary();
+
+        /**
+         * @brief Save all dictionary layers merged into one file
          * @param dict_path Path to save dictionary
          * @return true if successful, false otherwise
          */
@@ -0,0 +1,167 @@
+#ifndef STREAM_TOKENIZER_H
+#define STREAM_TOKENIZER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    // Forward declarations
+    class TextProcessor;
+
+    /**
+     * @brief Markup or programming language of a document, which decides what is prose
+     */
+    enum class DocumentFormat
+    {
+        PlainText,
+        Markdown,
+        LaTeX,
+        Html,
+        ReStructuredText,
+        CSource,    // C and C++: only comments and string literals are prose
+        JavaScript, // JavaScript and TypeScript
+        Python
+    };
+
+    /**
+     * @brief Pick a document format from a file name's extension
+     * @param file_path Path to file
+     * @return Matching format, or PlainText for unknown extensions
+     */
+    DocumentFormat documentFormatForPath(const std::string &file_path);
+
+    /**
+     * @brief A word with its line and column (in characters), as produced by extractWordsWithLines
+     */
+    using WordToken = std::tuple<std::string, size_t, size_t>;
+
+    /**
+     * @brief Single-pass tokenizer that extracts prose words from a document
+     *
+     * Text may be fed in chunks of any size; partial lines are carried
+     * over to the next call, and state such as an open code fence or
+     * math environment persists across lines. Each format skips its own
+     * non-prose regions (code, commands, math, tags, link targets), and
+     * all formats skip URLs and email addresses when the TextProcessor
+     * is configured to ignore them. Words are filtered and normalized by
+     * the TextProcessor.
+     */
+    class StreamTokenizer
+    {
+    private:
+        const TextProcessor &processor_;
+        std::string pending_; // Partial line carried between feed calls
+        size_t line_;
+        size_t column_offset_; // Columns already consumed from an over-long line
+        size_t column_byte_;   // Byte of the line scanned up to by columnAt
+        size_t column_chars_;  // Characters before column_byte_
+        std::vector<WordToken> *tokens_;
+        bool split_camel_case_;
+
+        /**
+         * @brief Get the column of a byte of the line being scanned
+         *
+         * Columns count characters (code points), not bytes. Words arrive
+         * left to right, so counting resumes where the last call stopped.
+         * @param line Current line
+         * @param begin Byte offset in the line
+         * @return 1-based column
+         */
+        size_t columnAt(std::string_view line, size_t begin);
+
+        /**
+         * @brief Emit one word if the TextProcessor does not ignore it
+         * @param line Current line
+         * @param begin First byte of the word
+         * @param end One past the last byte of the word
+         */
+        void emitWord(std::string_view line, size_t begin, size_t end);
+
+        /**
+         * @brief Scan one complete line
+         * @param line Line without its terminator
+         */
+        void processLine(std::string_view line);
+
+        /**
+         * @brief Scan the leading part of an over-long pending line
+         */
+        void flushLongLine();
+
+    protected:
+        /**
+         * @brief Scan one line, calling emitWords for its prose ranges
+         * @param line Line without its terminator
+         */
+        virtual void scanLine(std::string_view line) = 0;
+
+        /**
+         * @brief Emit the words in a prose range of the current line
+         * @param line Current line
+         * @param begin First byte of the range
+         * @param end One past the last byte of the range
+         */
+        void emitWords(std::string_view line, size_t begin, size_t end);
+
+        /**
+         * @brief Find where a URL or email address starting at a position ends
+         * @param line Current line
+         * @param begin Position of a letter that may start a URL or address
+         * @param end End of the range being scanned
+         * @return Position after the URL or address, or begin if there is none
+         */
+        size_t skipAddress(std::string_view line, size_t begin, size_t end) const;
+
+        /**
+         * @brief Split camelCase words into their parts when emitting
+         * @param split true to emit "parseHTTPRequest" as "parse", "HTTP", "Request"
+         */
+        void setSplitCamelCase(bool split) { split_camel_case_ = split; }
+
+    public:
+        /**
+         * @brief Constructor
+         * @param processor Word filter and normalization settings
+         */
+        explicit StreamTokenizer(const TextProcessor &processor);
+
+        /**
+         * @brief Destructor
+         */
+        virtual ~StreamTokenizer() = default;
+
+        // Delete copy constructor and assignment operator
+        StreamTokenizer(const StreamTokenizer &) = delete;
+        StreamTokenizer &operator=(const StreamTokenizer &) = delete;
+
+        /**
+         * @brief Tokenize the next chunk of the document
+         * @param chunk Text following the previous chunk
+         * @param tokens Receives the words completed by this chunk
+         */
+        void feed(std::string_view chunk, std::vector<WordToken> &tokens);
+
+        /**
+         * @brief Tokenize any text left after the last chunk
+         * @param tokens Receives the remaining words
+         */
+        void finish(std::vector<WordToken> &tokens);
+
+        /**
+         * @brief Create a tokenizer for a document format
+         * @param format Document format
+         * @param processor Word filter and normalization settings (must outlive the tokenizer)
+         * @return New tokenizer
+         */
+        static std::unique_ptr<StreamTokenizer> create(DocumentFormat format, const TextProcessor &processor);
+    };
+
+} // namespace spellcheck
+
+#endif // STREAM_TOKENIZER_H
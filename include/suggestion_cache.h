@@ -0,0 +1,112 @@
+#ifndef SUGGESTION_CACHE_H
+#define SUGGESTION_CACHE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Counters and sizes of a SuggestionCache
+     */
+    struct SuggestionCacheStats
+    {
+        size_t capacity = 0;
+        size_t entries = 0;
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t memory_bytes = 0; // Entries, including retired ones not yet freed
+    };
+
+    /**
+     * @brief Concurrent cache of suggestion lists, keyed by normalized word
+     *
+     * Keys are hashed to one of several shards and, within a shard, to a
+     * set of a few slots. Lookups take no lock: entries are immutable
+     * once published, and replaced entries are freed only after every
+     * lookup that might still be reading them has finished (epoch-based
+     * reclamation). Inserts lock only their shard and evict with CLOCK
+     * within the set: a slot read since the hand last passed gets a
+     * second chance. invalidate() bumps a generation number, which
+     * turns every existing entry into a miss without touching it.
+     */
+    class SuggestionCache
+    {
+    private:
+        struct Entry;
+        struct Shard;
+
+        std::unique_ptr<Shard[]> shards_;
+        size_t shard_count_; // Power of two
+        size_t sets_per_shard_;
+        size_t capacity_;
+        std::atomic<uint64_t> generation_;
+
+        /**
+         * @brief Free an entry once no lookup can still be reading it
+         * @param shard Shard the entry was removed from (its lock is held)
+         * @param entry Entry no longer reachable from the table
+         */
+        void retire(Shard &shard, Entry *entry);
+
+    public:
+        /**
+         * @brief Constructor
+         * @param capacity Largest number of cached words
+         */
+        explicit SuggestionCache(size_t capacity);
+
+        /**
+         * @brief Destructor; no lookups may be running
+         */
+        ~SuggestionCache();
+
+        // Delete copy constructor and assignment operator
+        SuggestionCache(const SuggestionCache &) = delete;
+        SuggestionCache &operator=(const SuggestionCache &) = delete;
+
+        /**
+         * @brief Look up a word's suggestions
+         * @param word Normalized word
+         * @param suggestions Receives the cached suggestions on a hit
+         * @return true on a hit
+         */
+        bool lookup(const std::string &word, std::vector<std::string> &suggestions) const;
+
+        /**
+         * @brief Store a word's suggestions, evicting another word if its set is full
+         * @param word Normalized word
+         * @param suggestions Suggestions to cache
+         * @param generation Value of generation() read before the suggestions were
+         *        computed, so a result that raced with invalidate() is never served
+         */
+        void insert(const std::string &word, const std::vector<std::string> &suggestions, uint64_t generation);
+
+        /**
+         * @brief Treat every cached entry as stale (dictionaries or settings changed)
+         */
+        void invalidate() { generation_.fetch_add(1); }
+
+        /**
+         * @brief Get the generation number that current entries must carry
+         * @return Generation number
+         */
+        uint64_t generation() const { return generation_.load(); }
+
+        /**
+         * @brief Get hit counts and memory usage
+         * @return Statistics
+         */
+        SuggestionCacheStats getStats() const;
+    };
+
+} // namespace spellcheck
+
+#endif // SUGGESTION_CACHE_H
@@ -6,12 +6,38 @@
 #include <algorithm>
 #include <unordered_set>
 #include <memory>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+
+#include "keyboard_layout.h"
 
 namespace spellcheck
 {
 
-    // Forward declaration
+    // Forward declarations
     class Dictionary;
+    class BigramModel;
+
+    /**
+     * @brief Limits on the work spent generating suggestions for one word
+     */
+    struct SuggestionBudget
+    {
+        std::chrono::microseconds time_limit{0}; // 0 = unlimited
+        size_t max_probes = 0;                   // Candidate lookups, 0 = unlimited
+
+        bool isUnlimited() const { return time_limit.count() == 0 && max_probes == 0; }
+    };
+
+    /**
+     * @brief Suggestions plus whether generation stopped early
+     */
+    struct SuggestionResult
+    {
+        std::vector<std::string> suggestions;
+        bool truncated = false; // Budget ran out before all tiers were searched
+    };
 
     /**
      * @brief Advanced suggestion engine using multiple algorithms
@@ -19,7 +45,8 @@ namespace spellcheck
     class SuggestionEngine
     {
     private:
-        const Dictionary *dictionary_;
+        // Dictionary layers searched together (e.g. base, domain, personal)
+        std::vector<const Dictionary *> layers_;
         size_t max_edit_distance_;
         size_t max_suggestions_;
 
@@ -29,54 +56,76 @@ namespace spellcheck
         double phonetic_weight_;
         double prefix_weight_;
 
-        /**
-         * @brief Calculate Levenshtein edit distance between two words
-         * @param word1 First word
-         * @param word2 Second word
-         * @return Edit distance
-         */
-        size_t calculateEditDistance(const std::string &word1, const std::string &word2) const;
+        // Default budget used by generateSuggestions(word)
+        SuggestionBudget budget_;
+
+        // Substitution costs for the configured keyboard layout
+        KeyboardLayout keyboard_layout_;
+        const KeyboardCostTable *key_costs_;
+
+        // Most words a run-together token is split into
+        size_t max_split_words_;
+
+        // Optional language model for contextual reranking
+        const BigramModel *context_model_;
+        size_t context_shortlist_;
+
+        // Receives each generated candidate; returning false stops generation
+        using CandidateVisitor = std::function<bool(const std::string &)>;
 
         /**
-         * @brief Calculate Damerau-Levenshtein distance (includes transpositions)
+         * @brief Calculate keyboard-weighted Damerau-Levenshtein distance
+         *
+         * Insertions, deletions and adjacent transpositions cost 1;
+         * substitutions cost less when the two keys are close on the
+         * configured keyboard layout.
          * @param word1 First word
          * @param word2 Second word
-         * @return Edit distance including transpositions
+         * @return Weighted edit distance
          */
-        size_t calculateDamerauLevenshteinDistance(const std::string &word1, const std::string &word2) const;
+        double calculateWeightedDistance(const std::string &word1, const std::string &word2) const;
 
         /**
          * @brief Generate candidates by character deletion
          * @param word Input word
-         * @return Vector of deletion candidates
+         * @param visit Called for each candidate
+         * @return false if the visitor stopped generation early
          */
-        std::vector<std::string> generateDeletionCandidates(const std::string &word) const;
+        bool generateDeletionCandidates(const std::string &word, const CandidateVisitor &visit) const;
 
         /**
          * @brief Generate candidates by character insertion
          * @param word Input word
-         * @return Vector of insertion candidates
+         * @param visit Called for each candidate
+         * @return false if the visitor stopped generation early
          */
-        std::vector<std::string> generateInsertionCandidates(const std::string &word) const;
+        bool generateInsertionCandidates(const std::string &word, const CandidateVisitor &visit) const;
 
         /**
          * @brief Generate candidates by character substitution
          * @param word Input word
-         * @return Vector of substitution candidates
+         * @param visit Called for each candidate
+         * @return false if the visitor stopped generation early
          */
-        std::vector<std::string> generateSubstitutionCandidates(const std::string &word) const;
+        bool generateSubstitutionCandidates(const std::string &word, const CandidateVisitor &visit) const;
 
         /**
          * @brief Generate candidates by character transposition
          * @param word Input word
-         * @return Vector of transposition candidates
+         * @param visit Called for each candidate
+         * @return false if the visitor stopped generation early
          */
-        std::vector<std::string> generateTranspositionCandidates(const std::string &word) const;
+        bool generateTranspositionCandidates(const std::string &word, const CandidateVisitor &visit) const;
 
         /**
-         * @brief Generate candidates by splitting word
+         * @brief Generate candidates by splitting a run-together word
+         *
+         * Word-break dynamic programming over the trie: one trie walk per
+         * reachable start offset finds every dictionary word starting
+         * there, and the best segmentation into k words (by summed log
+         * frequency) is kept for each k up to max_split_words_.
          * @param word Input word
-         * @return Vector of split candidates
+         * @return Space-separated segmentations of dictionary words, fewest words first
          */
         std::vector<std::string> generateSplitCandidates(const std::string &word) const;
 
@@ -98,12 +147,26 @@ namespace spellcheck
         double calculateSuggestionScore(const std::string &original, const std::string &candidate) const;
 
         /**
-         * @brief Get keyboard layout distance for character substitution
-         * @param c1 First character
-         * @param c2 Second character
-         * @return Distance on QWERTY keyboard (lower is closer)
+         * @brief Check if any layer contains the word
+         * @param word Word to check
+         * @return true if word exists in at least one layer
+         */
+        bool containsWord(const std::string &word) const;
+
+        /**
+         * @brief Get word frequency merged across layers
+         * @param word Word to get frequency for
+         * @return Highest frequency of the word in any layer (0 if not found)
+         */
+        uint32_t getWordFrequency(const std::string &word) const;
+
+        /**
+         * @brief Check if the words sound alike in any layer
+         * @param word Word being corrected
+         * @param candidate Candidate word
+         * @return true if some layer gives both words a common phonetic code
          */
-        double getKeyboardDistance(char c1, char c2) const;
+        bool soundsAlike(const std::string &word, const std::string &candidate) const;
 
     public:
         /**
@@ -128,10 +191,46 @@ namespace spellcheck
          */
         std::vector<std::string> generateSuggestions(const std::string &word) const;
 
+        /**
+         * @brief Generate spelling suggestions within a time or work budget
+         *
+         * Candidate tiers run cheapest first: deletions and transpositions,
+         * then substitutions and insertions, then, if none of those is a
+         * word, words up to the maximum edit distance (each trie node
+         * visited counts as a probe), then phonetic, prefix and split
+         * matches. When the budget runs out, the candidates found so far are
+         * ranked and returned with the truncated flag set.
+         * @param word Misspelled word
+         * @param budget Limits for this call
+         * @return Ranked suggestions and truncation flag
+         */
+        SuggestionResult generateSuggestions(const std::string &word, const SuggestionBudget &budget) const;
+
+        /**
+         * @brief Rerank the best suggestions using the surrounding words
+         *
+         * Noisy-channel scoring: the language model's log10 probability of
+         * each candidate between its neighbours plus a channel penalty per
+         * weighted edit. Only the first context_shortlist suggestions are
+         * reordered, so each call costs at most four model lookups per
+         * shortlisted candidate. Without a model the input is returned.
+         * @param word Misspelled word
+         * @param suggestions Suggestions ranked without context
+         * @param previous Word before the misspelling (empty = none)
+         * @param next Word after the misspelling (empty = none)
+         * @return Reranked suggestions
+         */
+        std::vector<std::string> rerankInContext(const std::string &word, std::vector<std::string> suggestions,
+                                                 const std::string &previous, const std::string &next) const;
+
         /**
          * @brief Generate suggestions using edit distance only
+         *
+         * Walks each layer's trie, extending one distance row per node and
+         * skipping subtrees whose best weighted distance already exceeds
+         * max_distance.
          * @param word Misspelled word
-         * @param max_distance Maximum edit distance to consider
+         * @param max_distance Maximum weighted edit distance to consider
          * @return Vector of suggestions within edit distance
          */
         std::vector<std::string> generateEditDistanceSuggestions(const std::string &word,
@@ -158,6 +257,15 @@ namespace spellcheck
         void setFrequencyWeight(double weight) { frequency_weight_ = weight; }
         void setPhoneticWeight(double weight) { phonetic_weight_ = weight; }
         void setPrefixWeight(double weight) { prefix_weight_ = weight; }
+        void setBudget(const SuggestionBudget &budget) { budget_ = budget; }
+        void setContextModel(const BigramModel *model) { context_model_ = model; }
+        void setContextShortlist(size_t size) { context_shortlist_ = size; }
+        void setMaxSplitWords(size_t max_words) { max_split_words_ = max_words; }
+        void setKeyboardLayout(KeyboardLayout layout)
+        {
+            keyboard_layout_ = layout;
+            key_costs_ = &keyboardCostTable(layout);
+        }
 
         // Configuration getters
         size_t getMaxEditDistance() const { return max_edit_distance_; }
@@ -166,12 +274,22 @@ namespace spellcheck
         double getFrequencyWeight() const { return frequency_weight_; }
         double getPhoneticWeight() const { return phonetic_weight_; }
         double getPrefixWeight() const { return prefix_weight_; }
+        const SuggestionBudget &getBudget() const { return budget_; }
+        KeyboardLayout getKeyboardLayout() const { return keyboard_layout_; }
+        size_t getContextShortlist() const { return context_shortlist_; }
+        size_t getMaxSplitWords() const { return max_split_words_; }
 
         /**
          * @brief Set dictionary reference
          * @param dictionary Pointer to dictionary
          */
-        void setDictionary(const Dictionary *dictionary) { dictionary_ = dictionary; }
+        void setDictionary(const Dictionary *dictionary) { layers_.assign(dictionary ? 1 : 0, dictionary); }
+
+        /**
+         * @brief Set the dictionary layers searched for suggestions
+         * @param layers Dictionaries to search, all ranked together
+         */
+        void setDictionaryLayers(const std::vector<const Dictionary *> &layers) { layers_ = layers; }
     };
 
 } // namespace spellcheck
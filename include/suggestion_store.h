@@ -0,0 +1,124 @@
+#ifndef SUGGESTION_STORE_H
+#define SUGGESTION_STORE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Suggestion lists kept on disk between runs
+     *
+     * The file is an append-only log of (word, suggestions) records after
+     * a header naming the dictionary content and suggestion settings the
+     * records were computed with. It is memory-mapped when opened and
+     * indexed without copying; suggestions computed during the run are
+     * collected and appended by flush. When the dictionaries or settings
+     * no longer match the header, the old records are ignored and the
+     * file is rewritten. A record cut short by a crash ends the log.
+     */
+    class SuggestionStore
+    {
+    private:
+        std::string path_;
+        const char *data_; // Mapping of the file, or nullptr
+        size_t size_;
+        size_t end_; // Offset after the last complete record
+        uint64_t dictionary_hash_; // Versions the mapped records were computed for
+        uint64_t settings_hash_;
+        std::unordered_map<std::string_view, std::string_view> index_; // Word to record payload
+        std::atomic<bool> valid_;                                      // false once the mapped records went stale
+
+        std::mutex pending_mutex_;
+        std::vector<std::pair<std::string, std::vector<std::string>>> pending_;
+        std::unordered_set<std::string> pending_words_;
+
+        /**
+         * @brief Unmap the file and forget its records
+         */
+        void close();
+
+        /**
+         * @brief Write the pending records to a fresh file replacing the old one
+         * @param dictionary_hash Current dictionary content hash
+         * @param settings_hash Current suggestion settings hash
+         * @return true if successful, false otherwise
+         */
+        bool rewrite(uint64_t dictionary_hash, uint64_t settings_hash);
+
+    public:
+        /**
+         * @brief Constructor
+         */
+        SuggestionStore();
+
+        /**
+         * @brief Destructor; pending records that were not flushed are lost
+         */
+        ~SuggestionStore();
+
+        // Delete copy constructor and assignment operator
+        SuggestionStore(const SuggestionStore &) = delete;
+        SuggestionStore &operator=(const SuggestionStore &) = delete;
+
+        /**
+         * @brief Open a store file, using its records if they were computed for the same versions
+         *
+         * A missing file is not an error; it is created by flush.
+         * @param file_path Path to store file
+         * @param dictionary_hash Current dictionary content hash
+         * @param settings_hash Current suggestion settings hash
+         * @return Number of usable records
+         */
+        size_t open(const std::string &file_path, uint64_t dictionary_hash, uint64_t settings_hash);
+
+        /**
+         * @brief Look up a word's stored suggestions
+         * @param word Normalized word
+         * @param suggestions Receives the suggestions on a hit
+         * @return true on a hit
+         */
+        bool lookup(const std::string &word, std::vector<std::string> &suggestions) const;
+
+        /**
+         * @brief Remember suggestions computed during this run, to be written by flush
+         * @param word Normalized word
+         * @param suggestions Suggestions
+         */
+        void record(const std::string &word, const std::vector<std::string> &suggestions);
+
+        /**
+         * @brief Stop serving stored records; the dictionaries or settings changed
+         */
+        void invalidate();
+
+        /**
+         * @brief Write the suggestions recorded since open or the last flush
+         *
+         * Appends when the file was written for the same versions;
+         * otherwise replaces it. The file is mapped again afterwards, so
+         * no lookups may run during a flush.
+         * @param dictionary_hash Current dictionary content hash
+         * @param settings_hash Current suggestion settings hash
+         * @return true if successful, false otherwise
+         */
+        bool flush(uint64_t dictionary_hash, uint64_t settings_hash);
+
+        /**
+         * @brief Check if a store file is open
+         * @return true after open
+         */
+        bool isOpen() const { return !path_.empty(); }
+    };
+
+} // namespace spellcheck
+
+#endif // SUGGESTION_STORE_H
@@ -26,6 +26,9 @@ namespace spellcheck
         bool ignore_emails_;
         bool ignore_numbers_;
         bool case_sensitive_;
+        size_t min_word_length_;
+        size_t max_word_length_; // 0 = no limit
+        bool split_identifiers_; // Check code identifiers in source files, split into subwords
 
     public:
         /**
@@ -134,12 +137,18 @@ namespace spellcheck
         void setIgnoreEmails(bool ignore) { ignore_emails_ = ignore; }
         void setIgnoreNumbers(bool ignore) { ignore_numbers_ = ignore; }
         void setCaseSensitive(bool sensitive) { case_sensitive_ = sensitive; }
+        void setMinWordLength(size_t length) { min_word_length_ = length; }
+        void setMaxWordLength(size_t length) { max_word_length_ = length; }
+        void setSplitIdentifiers(bool split) { split_identifiers_ = split; }
 
         // Configuration getters
         bool ignoreUrls() const { return ignore_urls_; }
         bool ignoreEmails() const { return ignore_emails_; }
         bool ignoreNumbers() const { return ignore_numbers_; }
         bool isCaseSensitive() const { return case_sensitive_; }
+        size_t getMinWordLength() const { return min_word_length_; }
+        size_t getMaxWordLength() const { return max_word_length_; }
+        bool splitIdentifiers() const { return split_identifiers_; }
 
         /**
          * @brief Read file contents
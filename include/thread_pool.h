@@ -0,0 +1,151 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Fixed set of worker threads that balance uneven tasks by work stealing
+     *
+     * Every worker owns a deque. Tasks submitted from a worker go to the
+     * back of its own deque and are taken from the back again, so
+     * related work stays on one thread; idle workers steal from the
+     * front of other deques, taking the oldest and usually largest
+     * tasks. Tasks submitted from other threads are spread across the
+     * deques. Threads are started on the first submission.
+     */
+    class ThreadPool
+    {
+    private:
+        using Task = std::function<void()>;
+
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        size_t thread_count_;
+        std::vector<std::unique_ptr<WorkQueue>> queues_;
+        std::vector<std::thread> threads_;
+        std::once_flag started_;
+        std::atomic<size_t> queued_; // Tasks submitted but not yet taken
+        std::atomic<size_t> next_queue_;
+        std::mutex sleep_mutex_;
+        std::condition_variable wake_;
+        bool stopping_;
+
+        /**
+         * @brief Take a task from a worker's own deque, else steal one
+         * @param home Deque to try first
+         * @param from_back true to take the newest task of the home deque
+         * @param task Receives the task
+         * @return true if a task was taken
+         */
+        bool takeTask(size_t home, bool from_back, Task &task);
+
+        /**
+         * @brief Run tasks until the pool is destroyed
+         * @param index Worker number, which is also its deque
+         */
+        void workerLoop(size_t index);
+
+    public:
+        /**
+         * @brief Constructor
+         * @param threads Number of worker threads (0 = one per CPU core)
+         */
+        explicit ThreadPool(size_t threads = 0);
+
+        /**
+         * @brief Destructor; finishes queued tasks and joins the workers
+         */
+        ~ThreadPool();
+
+        // Delete copy constructor and assignment operator
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /**
+         * @brief Queue a task
+         * @param task Task to run on some worker
+         */
+        void submit(Task task);
+
+        /**
+         * @brief Run one queued task on the calling thread, if there is one
+         * @return true if a task was run
+         */
+        bool runPendingTask();
+
+        /**
+         * @brief Get the number of worker threads
+         * @return Worker count
+         */
+        size_t size() const { return thread_count_; }
+    };
+
+    /**
+     * @brief Tasks submitted to a ThreadPool that are waited for together
+     *
+     * Tasks may add more tasks to their own group. A thread waiting for
+     * the group runs queued tasks instead of sleeping, so waiting from
+     * inside a task cannot starve the pool. An exception thrown by a task
+     * still counts it as finished and is rethrown by the next wait.
+     */
+    class TaskGroup
+    {
+    private:
+        ThreadPool &pool_;
+        std::atomic<size_t> pending_;
+        std::atomic<size_t> wait_limit_; // Pending count the waiter is waiting for
+        std::mutex mutex_;
+        std::condition_variable done_;
+        std::exception_ptr error_; // First exception thrown by a task, guarded by mutex_
+
+    public:
+        /**
+         * @brief Constructor
+         * @param pool Pool that runs the tasks
+         */
+        explicit TaskGroup(ThreadPool &pool);
+
+        /**
+         * @brief Destructor; waits for every task of the group, dropping any exception
+         */
+        ~TaskGroup();
+
+        // Delete copy constructor and assignment operator
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        /**
+         * @brief Submit a task as part of the group
+         * @param task Task to run
+         */
+        void run(std::function<void()> task);
+
+        /**
+         * @brief Wait until at most a number of the group's tasks are unfinished
+         *
+         * Only one thread may wait on a group at a time. If a task has
+         * thrown, its exception is rethrown here, once.
+         * @param max_pending Unfinished tasks to allow (0 = wait for all)
+         */
+        void wait(size_t max_pending = 0);
+    };
+
+} // namespace spellcheck
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,46 @@
+#ifndef UNIFIED_DIFF_H
+#define UNIFIED_DIFF_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <cstddef>
+
+namespace spellcheck
+{
+
+    /**
+     * @brief Consecutive lines added by a diff
+     */
+    struct DiffRange
+    {
+        size_t first_line = 0; // Line number of the first line in the new file
+        std::string text;      // The lines, each ending in '\n'
+    };
+
+    /**
+     * @brief Lines a diff adds to one file
+     */
+    struct DiffFile
+    {
+        std::string path; // New name, without the "b/" prefix git adds
+        std::vector<DiffRange> ranges;
+    };
+
+    /**
+     * @brief Read the added lines of a unified diff, such as git diff prints
+     *
+     * Modified lines count as added, since a unified diff shows them as
+     * removed and added again. Removed lines, context lines and deleted
+     * files are skipped, as are binary files, for which no lines are
+     * shown. Only the diff itself is kept in memory, so reading costs
+     * time in proportion to the patch rather than to the files changed.
+     * @param input Diff to read until its end
+     * @param files Receives one entry per file with added lines, in diff order
+     * @return false if a hunk is malformed or the stream fails, true otherwise
+     */
+    bool readUnifiedDiff(std::istream &input, std::vector<DiffFile> &files);
+
+} // namespace spellcheck
+
+#endif // UNIFIED_DIFF_H
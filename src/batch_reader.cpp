@@ -0,0 +1,756 @@
+#include "batch_reader.h"
+#include <algorithm>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define SPELLCHECK_HAVE_IO_URING
+#endif
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        // Threads used for pread when io_uring is unavailable
+        constexpr size_t kMaxPoolThreads = 16;
+
+        // Largest submission ring requested from the kernel
+        constexpr unsigned kMaxRingEntries = 256;
+
+        // Cap on the bytes of files being read or waiting to be consumed
+        constexpr size_t kMaxBufferedBytes = 64 * 1024 * 1024;
+
+        // Keep a buffer the kernel may still write into for the rest of the process
+        void retainBuffer(std::vector<char> data)
+        {
+            static std::mutex mutex;
+            static std::vector<std::vector<char>> retained;
+            std::lock_guard<std::mutex> lock(mutex);
+            retained.push_back(std::move(data));
+        }
+
+        // Read a file into its sized buffer, recording an error or a file that shrank
+        void readWhole(int fd, FileBuffer &buffer)
+        {
+            size_t done = 0;
+            while (done < buffer.data.size())
+            {
+                ssize_t count = pread(fd, buffer.data.data() + done, buffer.data.size() - done,
+                                      static_cast<off_t>(done));
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (count < 0)
+                {
+                    buffer.error = errno;
+                    break;
+                }
+                if (count == 0)
+                {
+                    // The file shrank since it was sized
+                    buffer.data.resize(done);
+                    break;
+                }
+                done += static_cast<size_t>(count);
+            }
+        }
+    } // namespace
+
+#ifdef SPELLCHECK_HAVE_IO_URING
+
+    /**
+     * @brief Minimal io_uring submission and completion rings, driven by raw syscalls
+     *
+     * Only vectored reads are queued. The completion ring is twice the
+     * size of the submission ring, so it cannot overflow as long as no
+     * more reads are in flight than capacity().
+     */
+    class IoUring
+    {
+    private:
+        int fd_;
+        unsigned entries_;
+        void *sq_ring_;
+        size_t sq_ring_size_;
+        void *cq_ring_; // Same mapping as sq_ring_ on kernels with IORING_FEAT_SINGLE_MMAP
+        size_t cq_ring_size_;
+        io_uring_sqe *sqes_;
+        size_t sqes_size_;
+        unsigned *sq_head_;
+        unsigned *sq_tail_;
+        unsigned *sq_array_;
+        unsigned sq_mask_;
+        unsigned *cq_head_;
+        unsigned *cq_tail_;
+        io_uring_cqe *cqes_;
+        unsigned cq_mask_;
+        unsigned unsubmitted_;
+
+        IoUring()
+            : fd_(-1), entries_(0), sq_ring_(MAP_FAILED), sq_ring_size_(0), cq_ring_(MAP_FAILED), cq_ring_size_(0),
+              sqes_(nullptr), sqes_size_(0), sq_head_(nullptr), sq_tail_(nullptr), sq_array_(nullptr), sq_mask_(0),
+              cq_head_(nullptr), cq_tail_(nullptr), cqes_(nullptr), cq_mask_(0), unsubmitted_(0)
+        {
+        }
+
+        static unsigned *field(void *ring, uint32_t offset)
+        {
+            return reinterpret_cast<unsigned *>(static_cast<char *>(ring) + offset);
+        }
+
+    public:
+        ~IoUring()
+        {
+            if (sqes_)
+            {
+                munmap(sqes_, sqes_size_);
+            }
+            if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+            {
+                munmap(cq_ring_, cq_ring_size_);
+            }
+            if (sq_ring_ != MAP_FAILED)
+            {
+                munmap(sq_ring_, sq_ring_size_);
+            }
+            if (fd_ >= 0)
+            {
+                close(fd_);
+            }
+        }
+
+        /**
+         * @brief Set up a ring
+         * @param entries Requested submission ring size
+         * @return Ring, or nullptr if the kernel (or a sandbox) refuses io_uring
+         */
+        static std::unique_ptr<IoUring> create(unsigned entries)
+        {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (fd < 0)
+            {
+                return nullptr;
+            }
+
+            std::unique_ptr<IoUring> ring(new IoUring());
+            ring->fd_ = fd;
+            ring->entries_ = params.sq_entries;
+            ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+            bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single_mmap)
+            {
+                ring->sq_ring_size_ = ring->cq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+            }
+
+            ring->sq_ring_ = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  fd, IORING_OFF_SQ_RING);
+            if (ring->sq_ring_ == MAP_FAILED)
+            {
+                return nullptr;
+            }
+
+            ring->cq_ring_ = single_mmap ? ring->sq_ring_
+                                         : mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE,
+                                                MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (ring->cq_ring_ == MAP_FAILED)
+            {
+                return nullptr;
+            }
+
+            ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+            void *sqes = mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              fd, IORING_OFF_SQES);
+            if (sqes == MAP_FAILED)
+            {
+                return nullptr;
+            }
+            ring->sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+            ring->sq_head_ = field(ring->sq_ring_, params.sq_off.head);
+            ring->sq_tail_ = field(ring->sq_ring_, params.sq_off.tail);
+            ring->sq_array_ = field(ring->sq_ring_, params.sq_off.array);
+            ring->sq_mask_ = *field(ring->sq_ring_, params.sq_off.ring_mask);
+            ring->cq_head_ = field(ring->cq_ring_, params.cq_off.head);
+            ring->cq_tail_ = field(ring->cq_ring_, params.cq_off.tail);
+            ring->cq_mask_ = *field(ring->cq_ring_, params.cq_off.ring_mask);
+            ring->cqes_ = reinterpret_cast<io_uring_cqe *>(static_cast<char *>(ring->cq_ring_) + params.cq_off.cqes);
+
+            return ring;
+        }
+
+        /**
+         * @brief Get the number of reads that may be in flight at once
+         * @return Submission ring size
+         */
+        unsigned capacity() const { return entries_; }
+
+        /**
+         * @brief Queue a read into one buffer; it is issued by the next submitAndWait
+         * @param fd File to read
+         * @param vec Destination; must stay valid until the read completes
+         * @param offset File offset
+         * @param user_data Returned with the completion
+         * @return false if the submission ring is full
+         */
+        bool queueRead(int fd, const iovec *vec, uint64_t offset, uint64_t user_data)
+        {
+            unsigned tail = *sq_tail_;
+            if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= entries_)
+            {
+                return false;
+            }
+
+            unsigned index = tail & sq_mask_;
+            io_uring_sqe &sqe = sqes_[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READV;
+            sqe.fd = fd;
+            sqe.addr = reinterpret_cast<uint64_t>(vec);
+            sqe.len = 1;
+            sqe.off = offset;
+            sqe.user_data = user_data;
+            sq_array_[index] = index;
+
+            // The entry must be visible to the kernel before the new tail
+            __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+            unsubmitted_++;
+            return true;
+        }
+
+        /**
+         * @brief Queue a request to cancel a read; it is issued by the next submitAndWait
+         * @param target User data of the read to cancel
+         * @param user_data Returned with the cancellation's own completion
+         * @return false if the submission ring is full
+         */
+        bool queueCancel(uint64_t target, uint64_t user_data)
+        {
+            unsigned tail = *sq_tail_;
+            if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= entries_)
+            {
+                return false;
+            }
+
+            unsigned index = tail & sq_mask_;
+            io_uring_sqe &sqe = sqes_[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_ASYNC_CANCEL;
+            sqe.fd = -1;
+            sqe.addr = target;
+            sqe.user_data = user_data;
+            sq_array_[index] = index;
+
+            __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+            unsubmitted_++;
+            return true;
+        }
+
+        /**
+         * @brief Submit queued reads and wait for at least one completion
+         * @return 0 on success, or a negative errno
+         */
+        int submitAndWait()
+        {
+            while (true)
+            {
+                long submitted = syscall(__NR_io_uring_enter, fd_, unsubmitted_, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (submitted >= 0)
+                {
+                    unsubmitted_ -= static_cast<unsigned>(submitted);
+                    return 0;
+                }
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                {
+                    return -errno;
+                }
+            }
+        }
+
+        /**
+         * @brief Hand every available completion to a callback
+         * @param visit Called with each completion's user data and result
+         */
+        template <typename Visit>
+        void reap(Visit visit)
+        {
+            unsigned head = *cq_head_;
+            unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            while (head != tail)
+            {
+                const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+                uint64_t user_data = cqe.user_data;
+                int32_t result = cqe.res;
+
+                // Release the slot before visiting, which may queue more reads
+                head++;
+                __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+                visit(user_data, result);
+                tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            }
+        }
+    };
+
+#else
+
+    // Stand-in so BatchReader compiles where io_uring is unavailable
+    class IoUring
+    {
+    };
+
+#endif // SPELLCHECK_HAVE_IO_URING
+
+    BatchReader::BatchReader(std::vector<std::string> paths, size_t max_in_flight, size_t max_file_size,
+                             bool use_io_uring)
+        : paths_(std::move(paths)), max_in_flight_(std::max<size_t>(1, max_in_flight)), max_file_size_(max_file_size),
+          queue_(max_in_flight_), next_path_(0), running_readers_(0), buffered_bytes_(0), closing_(false),
+          backend_(Backend::ThreadPool)
+    {
+#ifdef SPELLCHECK_HAVE_IO_URING
+        if (use_io_uring)
+        {
+            ring_ = IoUring::create(static_cast<unsigned>(std::min<size_t>(max_in_flight_, kMaxRingEntries)));
+        }
+#else
+        (void)use_io_uring;
+#endif
+
+        if (ring_)
+        {
+            backend_ = Backend::IoUring;
+            running_readers_ = 1;
+            threads_.emplace_back(&BatchReader::runIoUring, this);
+            return;
+        }
+
+        size_t thread_count = std::min({max_in_flight_, kMaxPoolThreads, std::max<size_t>(1, paths_.size())});
+        running_readers_ = thread_count;
+        for (size_t i = 0; i < thread_count; ++i)
+        {
+            threads_.emplace_back(&BatchReader::runThreadPool, this);
+        }
+    }
+
+    BatchReader::~BatchReader()
+    {
+        // Readers blocked on a full queue or on the byte cap give up once it is closed
+        {
+            std::lock_guard<std::mutex> lock(budget_mutex_);
+            closing_ = true;
+        }
+        budget_freed_.notify_all();
+        queue_.close();
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    bool BatchReader::next(FileBuffer &buffer)
+    {
+        if (!queue_.pop(buffer))
+        {
+            return false;
+        }
+        // A buffer is allocated at exactly the size reserved for it
+        releaseBytes(buffer.data.capacity());
+        return true;
+    }
+
+    bool BatchReader::reserveBytes(size_t bytes, bool wait)
+    {
+        // With nothing buffered any file fits, so one larger than the cap cannot stall reading
+        std::unique_lock<std::mutex> lock(budget_mutex_);
+        auto fits = [this, bytes]
+        { return buffered_bytes_ == 0 || buffered_bytes_ + bytes <= kMaxBufferedBytes; };
+        if (wait)
+        {
+            budget_freed_.wait(lock, [this, &fits]
+                               { return closing_ || fits(); });
+        }
+        if (closing_ || !fits())
+        {
+            return false;
+        }
+        buffered_bytes_ += bytes;
+        return true;
+    }
+
+    void BatchReader::releaseBytes(size_t bytes)
+    {
+        if (bytes == 0)
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(budget_mutex_);
+            buffered_bytes_ -= bytes;
+        }
+        budget_freed_.notify_all();
+    }
+
+    void BatchReader::finishReader()
+    {
+        if (running_readers_.fetch_sub(1) == 1)
+        {
+            queue_.close();
+        }
+    }
+
+    int BatchReader::openFile(FileBuffer &buffer, size_t &size) const
+    {
+        int fd = open(buffer.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            buffer.error = errno;
+            return -1;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            buffer.error = errno;
+            close(fd);
+            return -1;
+        }
+        if (S_ISDIR(info.st_mode))
+        {
+            buffer.error = EISDIR;
+            close(fd);
+            return -1;
+        }
+
+        // Pipes and devices have no size to read up to; large files are streamed
+        size = static_cast<size_t>(info.st_size);
+        if (!S_ISREG(info.st_mode) || size > max_file_size_)
+        {
+            buffer.deferred = true;
+            close(fd);
+            return -1;
+        }
+        if (size == 0)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void BatchReader::runThreadPool()
+    {
+        size_t index;
+        while ((index = next_path_.fetch_add(1)) < paths_.size())
+        {
+            FileBuffer buffer;
+            buffer.index = index;
+            buffer.path = paths_[index];
+
+            size_t size;
+            int fd = openFile(buffer, size);
+            if (fd >= 0)
+            {
+                if (!reserveBytes(size, true))
+                {
+                    close(fd);
+                    break;
+                }
+                buffer.data.resize(size);
+                readWhole(fd, buffer);
+                close(fd);
+            }
+
+            if (!queue_.push(std::move(buffer)))
+            {
+                break;
+            }
+        }
+
+        finishReader();
+    }
+
+#ifdef SPELLCHECK_HAVE_IO_URING
+
+    void BatchReader::runIoUring()
+    {
+        struct Slot
+        {
+            FileBuffer buffer;
+            int fd = -1;
+            size_t done = 0;
+            iovec vec;
+        };
+
+        // User data of cancellations; reads carry their slot index
+        constexpr uint64_t kCancelTag = ~uint64_t(0);
+
+        std::vector<Slot> slots(std::min<size_t>(max_in_flight_, ring_->capacity()));
+        std::vector<size_t> free_slots;
+        for (size_t i = slots.size(); i > 0; --i)
+        {
+            free_slots.push_back(i - 1);
+        }
+        size_t in_flight = 0;
+        bool stopped = false;
+
+        // A file opened while the byte cap was reached, read once reads in flight free room
+        FileBuffer waiting;
+        int waiting_fd = -1;
+        size_t waiting_size = 0;
+
+        auto issue = [&](size_t slot_index)
+        {
+            Slot &slot = slots[slot_index];
+            slot.vec.iov_base = slot.buffer.data.data() + slot.done;
+            slot.vec.iov_len = slot.buffer.data.size() - slot.done;
+            // Cannot fail: every slot in flight has its own ring entry
+            ring_->queueRead(slot.fd, &slot.vec, slot.done, slot_index);
+        };
+
+        auto complete = [&](size_t slot_index)
+        {
+            Slot &slot = slots[slot_index];
+            close(slot.fd);
+            slot.fd = -1;
+            in_flight--;
+            free_slots.push_back(slot_index);
+            if (!stopped && !queue_.push(std::move(slot.buffer)))
+            {
+                stopped = true;
+            }
+            slot.buffer = FileBuffer();
+        };
+
+        auto on_completion = [&](uint64_t slot_index, int32_t result)
+        {
+            Slot &slot = slots[slot_index];
+            if (result == -EINTR || result == -EAGAIN)
+            {
+                issue(slot_index);
+                return;
+            }
+
+            if (result < 0)
+            {
+                slot.buffer.error = -result;
+            }
+            else if (result == 0)
+            {
+                // The file shrank since it was sized
+                slot.buffer.data.resize(slot.done);
+            }
+            else
+            {
+                slot.done += static_cast<size_t>(result);
+                if (slot.done < slot.buffer.data.size())
+                {
+                    issue(slot_index);
+                    return;
+                }
+            }
+            complete(slot_index);
+        };
+
+        bool ring_failed = false;
+        while (!stopped)
+        {
+            // Keep every slot busy while files remain and the byte cap allows
+            while (!free_slots.empty())
+            {
+                FileBuffer buffer;
+                int fd = waiting_fd;
+                size_t size = waiting_size;
+                if (fd >= 0)
+                {
+                    buffer = std::move(waiting);
+                    waiting_fd = -1;
+                }
+                else
+                {
+                    size_t index = next_path_.fetch_add(1);
+                    if (index >= paths_.size())
+                    {
+                        break;
+                    }
+
+                    buffer.index = index;
+                    buffer.path = paths_[index];
+                    fd = openFile(buffer, size);
+                    if (fd < 0)
+                    {
+                        if (!queue_.push(std::move(buffer)))
+                        {
+                            stopped = true;
+                            break;
+                        }
+                        continue;
+                    }
+                }
+
+                // Waiting is safe only with nothing in flight: completions are reaped by this thread
+                if (!reserveBytes(size, in_flight == 0))
+                {
+                    if (in_flight == 0)
+                    {
+                        close(fd);
+                        stopped = true;
+                        break;
+                    }
+                    waiting = std::move(buffer);
+                    waiting_fd = fd;
+                    waiting_size = size;
+                    break;
+                }
+                buffer.data.resize(size);
+
+                size_t slot_index = free_slots.back();
+                free_slots.pop_back();
+                slots[slot_index].buffer = std::move(buffer);
+                slots[slot_index].fd = fd;
+                slots[slot_index].done = 0;
+                issue(slot_index);
+                in_flight++;
+            }
+
+            if (in_flight == 0)
+            {
+                break;
+            }
+
+            int error = ring_->submitAndWait();
+            if (error < 0)
+            {
+                std::cerr << "io_uring failed: " << std::strerror(-error) << ", reading with pread" << std::endl;
+                ring_failed = true;
+                break;
+            }
+            ring_->reap(on_completion);
+        }
+
+        // The consumer went away; let reads already in the kernel finish
+        while (stopped && in_flight > 0 && ring_->submitAndWait() == 0)
+        {
+            ring_->reap([&](uint64_t slot_index, int32_t)
+                        {
+                            if (slot_index != kCancelTag)
+                            {
+                                complete(slot_index);
+                            }
+                        });
+        }
+
+        if (ring_failed && in_flight > 0)
+        {
+            // The kernel may still write into the buffers of outstanding
+            // reads, so they are cancelled and every completion reaped
+            // before the buffers are touched. The files are then read again.
+            std::vector<char> settled(slots.size(), 1);
+            size_t to_cancel = 0;
+            for (size_t i = 0; i < slots.size(); ++i)
+            {
+                if (slots[i].fd >= 0)
+                {
+                    settled[i] = 0;
+                }
+            }
+            size_t unsettled = in_flight;
+            auto settle = [&](uint64_t slot_index, int32_t)
+            {
+                if (slot_index != kCancelTag && !settled[slot_index])
+                {
+                    settled[slot_index] = 1;
+                    unsettled--;
+                }
+            };
+
+            while (unsettled > 0)
+            {
+                for (; to_cancel < slots.size(); ++to_cancel)
+                {
+                    if (!settled[to_cancel] && !ring_->queueCancel(to_cancel, kCancelTag))
+                    {
+                        break;
+                    }
+                }
+                if (ring_->submitAndWait() < 0)
+                {
+                    break;
+                }
+                ring_->reap(settle);
+            }
+
+            for (size_t i = 0; i < slots.size(); ++i)
+            {
+                Slot &slot = slots[i];
+                if (slot.fd < 0)
+                {
+                    continue;
+                }
+                if (settled[i])
+                {
+                    slot.buffer.error = 0;
+                    readWhole(slot.fd, slot.buffer);
+                }
+                else
+                {
+                    // Not even the cancellation got through, so the read may
+                    // still land; its buffer is kept until the process exits
+                    slot.buffer.error = EIO;
+                    retainBuffer(std::move(slot.buffer.data));
+                }
+                close(slot.fd);
+                slot.fd = -1;
+                if (!stopped && !queue_.push(std::move(slot.buffer)))
+                {
+                    stopped = true;
+                }
+            }
+            in_flight = 0;
+        }
+
+        if (waiting_fd >= 0)
+        {
+            if (!stopped && reserveBytes(waiting_size, true))
+            {
+                waiting.data.resize(waiting_size);
+                readWhole(waiting_fd, waiting);
+                if (!queue_.push(std::move(waiting)))
+                {
+                    stopped = true;
+                }
+            }
+            close(waiting_fd);
+        }
+
+        if (stopped)
+        {
+            finishReader();
+            return;
+        }
+
+        // Whatever the ring did not get to is read with pread
+        runThreadPool();
+    }
+
+#else
+
+    void BatchReader::runIoUring()
+    {
+        runThreadPool();
+    }
+
+#endif // SPELLCHECK_HAVE_IO_URING
+
+} // namespace spellcheck
@@ -0,0 +1,316 @@
+#include "bigram_model.h"
+#include "hash_util.h"
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        constexpr char kMagic[4] = {'S', 'C', 'B', 'G'};
+        constexpr uint32_t kVersion = 1;
+
+        // Costs are -log10 p in steps of 1/32, saturating at 255 (p ~ 1e-8)
+        constexpr double kCostScale = 32.0;
+        constexpr uint8_t kMaxCost = 255;
+
+        // Stupid-backoff penalty for a bigram that was never seen (log10 0.4)
+        constexpr double kBackoffLog10 = -0.39794;
+
+        struct FileHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint64_t unigram_count;
+            uint64_t bigram_count;
+        };
+
+        uint8_t quantize(double log10_probability)
+        {
+            double cost = std::round(-log10_probability * kCostScale);
+            return static_cast<uint8_t>(std::min<double>(kMaxCost, std::max(0.0, cost)));
+        }
+
+        double dequantize(uint8_t cost)
+        {
+            return -static_cast<double>(cost) / kCostScale;
+        }
+
+        template <typename T>
+        bool writeArray(std::ofstream &file, const std::vector<T> &items)
+        {
+            file.write(reinterpret_cast<const char *>(items.data()),
+                       static_cast<std::streamsize>(items.size() * sizeof(T)));
+            return static_cast<bool>(file);
+        }
+    } // namespace
+
+    BigramModel::BigramModel()
+        : data_(nullptr), data_size_(0), unigram_keys_(nullptr), bigram_keys_(nullptr),
+          unigram_costs_(nullptr), bigram_costs_(nullptr), unigram_count_(0), bigram_count_(0)
+    {
+    }
+
+    BigramModel::~BigramModel()
+    {
+        unmap();
+    }
+
+    void BigramModel::unmap()
+    {
+        if (data_)
+        {
+            munmap(const_cast<unsigned char *>(data_), data_size_);
+        }
+        data_ = nullptr;
+        data_size_ = 0;
+        unigram_count_ = 0;
+        bigram_count_ = 0;
+    }
+
+    bool BigramModel::loadFromFile(const std::string &file_path)
+    {
+        unmap();
+
+        int fd = open(file_path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FileHeader))
+        {
+            close(fd);
+            return false;
+        }
+
+        size_t size = static_cast<size_t>(info.st_size);
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED)
+        {
+            return false;
+        }
+
+        FileHeader header;
+        std::memcpy(&header, mapped, sizeof(header));
+        uint64_t entries = header.unigram_count + header.bigram_count;
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+            entries > size || size != sizeof(FileHeader) + entries * (sizeof(uint64_t) + sizeof(uint8_t)))
+        {
+            munmap(mapped, size);
+            return false;
+        }
+
+        // Lookups touch scattered pages
+        madvise(mapped, size, MADV_RANDOM);
+
+        data_ = static_cast<const unsigned char *>(mapped);
+        data_size_ = size;
+        unigram_count_ = header.unigram_count;
+        bigram_count_ = header.bigram_count;
+        unigram_keys_ = reinterpret_cast<const uint64_t *>(data_ + sizeof(FileHeader));
+        bigram_keys_ = unigram_keys_ + unigram_count_;
+        unigram_costs_ = reinterpret_cast<const uint8_t *>(bigram_keys_ + bigram_count_);
+        bigram_costs_ = unigram_costs_ + unigram_count_;
+
+        return true;
+    }
+
+    bool BigramModel::buildFromCorpus(const std::string &corpus_path, const std::string &output_path,
+                                      uint32_t min_bigram_count)
+    {
+        std::ifstream corpus(corpus_path);
+        if (!corpus.is_open())
+        {
+            return false;
+        }
+
+        struct BigramCount
+        {
+            uint64_t previous;
+            uint64_t count;
+        };
+
+        std::unordered_map<uint64_t, uint64_t> unigram_counts;
+        std::unordered_map<uint64_t, BigramCount> bigram_counts;
+        uint64_t total_words = 0;
+
+        std::string line;
+        std::string word;
+        uint64_t previous = 0;
+        while (std::getline(corpus, line))
+        {
+            line += '\n';
+            for (size_t i = 0; i < line.size(); ++i)
+            {
+                unsigned char c = static_cast<unsigned char>(line[i]);
+                bool inner_apostrophe = c == '\'' && !word.empty() && i + 1 < line.size() &&
+                                        std::isalpha(static_cast<unsigned char>(line[i + 1]));
+                if (std::isalpha(c) || inner_apostrophe)
+                {
+                    word += static_cast<char>(std::tolower(c));
+                    continue;
+                }
+
+                if (!word.empty())
+                {
+                    uint64_t hash = hashWord(word);
+                    unigram_counts[hash]++;
+                    total_words++;
+                    if (previous != 0)
+                    {
+                        BigramCount &bigram = bigram_counts[bigramKey(previous, hash)];
+                        bigram.previous = previous;
+                        bigram.count++;
+                    }
+                    previous = hash;
+                    word.clear();
+                }
+
+                // Sentence boundaries break the chain
+                if (c == '.' || c == '!' || c == '?')
+                {
+                    previous = 0;
+                }
+            }
+        }
+
+        if (total_words == 0)
+        {
+            return false;
+        }
+
+        std::vector<std::pair<uint64_t, uint8_t>> unigrams;
+        unigrams.reserve(unigram_counts.size());
+        for (const auto &entry : unigram_counts)
+        {
+            unigrams.emplace_back(entry.first, quantize(std::log10(static_cast<double>(entry.second) / total_words)));
+        }
+
+        std::vector<std::pair<uint64_t, uint8_t>> bigrams;
+        for (const auto &entry : bigram_counts)
+        {
+            if (entry.second.count < min_bigram_count)
+            {
+                continue;
+            }
+            double previous_count = static_cast<double>(unigram_counts[entry.second.previous]);
+            bigrams.emplace_back(entry.first, quantize(std::log10(entry.second.count / previous_count)));
+        }
+
+        std::sort(unigrams.begin(), unigrams.end());
+        std::sort(bigrams.begin(), bigrams.end());
+
+        std::vector<uint64_t> unigram_keys;
+        std::vector<uint64_t> bigram_keys;
+        std::vector<uint8_t> costs;
+        unigram_keys.reserve(unigrams.size());
+        bigram_keys.reserve(bigrams.size());
+        costs.reserve(unigrams.size() + bigrams.size());
+        for (const auto &entry : unigrams)
+        {
+            unigram_keys.push_back(entry.first);
+            costs.push_back(entry.second);
+        }
+        for (const auto &entry : bigrams)
+        {
+            bigram_keys.push_back(entry.first);
+            costs.push_back(entry.second);
+        }
+
+        std::ofstream output(output_path, std::ios::binary | std::ios::trunc);
+        if (!output.is_open())
+        {
+            return false;
+        }
+
+        FileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.unigram_count = unigram_keys.size();
+        header.bigram_count = bigram_keys.size();
+        output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        return writeArray(output, unigram_keys) && writeArray(output, bigram_keys) && writeArray(output, costs);
+    }
+
+    BigramModel::Context BigramModel::makeContext(const std::string &previous, const std::string &next) const
+    {
+        Context context;
+        context.previous = previous.empty() ? 0 : hashWord(previous);
+        context.next = next.empty() ? 0 : hashWord(next);
+        return context;
+    }
+
+    double BigramModel::score(const Context &context, const std::string &candidate) const
+    {
+        uint64_t word = hashWord(candidate);
+        double log_probability = conditionalLogProbability(context.previous, word);
+        if (context.next != 0)
+        {
+            log_probability += conditionalLogProbability(word, context.next);
+        }
+        return log_probability;
+    }
+
+    double BigramModel::conditionalLogProbability(uint64_t previous, uint64_t word) const
+    {
+        uint8_t cost = kMaxCost;
+        if (previous != 0 && lookup(bigram_keys_, bigram_costs_, bigram_count_, bigramKey(previous, word), cost))
+        {
+            return dequantize(cost);
+        }
+
+        cost = kMaxCost;
+        lookup(unigram_keys_, unigram_costs_, unigram_count_, word, cost);
+        return (previous != 0 ? kBackoffLog10 : 0.0) + dequantize(cost);
+    }
+
+    bool BigramModel::lookup(const uint64_t *keys, const uint8_t *costs, uint64_t count, uint64_t key, uint8_t &cost)
+    {
+        if (count == 0)
+        {
+            return false;
+        }
+
+        const uint64_t *found = std::lower_bound(keys, keys + count, key);
+        if (found == keys + count || *found != key)
+        {
+            return false;
+        }
+
+        cost = costs[found - keys];
+        return true;
+    }
+
+    uint64_t BigramModel::hashWord(const std::string &word)
+    {
+        // FNV-1a over the lowercased word, then finalized
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char c : word)
+        {
+            hash ^= static_cast<unsigned char>(std::tolower(c));
+            hash *= 0x100000001b3ULL;
+        }
+        hash = mix64(hash);
+        return hash == 0 ? 1 : hash;
+    }
+
+    uint64_t BigramModel::bigramKey(uint64_t first, uint64_t second)
+    {
+        return mix64((first << 1 | first >> 63) ^ second);
+    }
+
+} // namespace spellcheck
@@ -0,0 +1,167 @@
+#include "config.h"
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace spellcheck
+{
+
+    bool Config::loadFromFile(const std::string &file_path)
+    {
+        std::ifstream file(file_path);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        values_.clear();
+        warnings_.clear();
+        path_ = file_path;
+
+        std::string line;
+        std::string section;
+        size_t line_number = 0;
+
+        while (std::getline(file, line))
+        {
+            line_number++;
+            line = trim(line);
+
+            // Skip blank lines and comments
+            if (line.empty() || line[0] == '#' || line[0] == ';')
+            {
+                continue;
+            }
+
+            if (line.front() == '[')
+            {
+                if (line.back() != ']')
+                {
+                    warnings_.push_back("line " + std::to_string(line_number) + ": unterminated section header");
+                    continue;
+                }
+                section = trim(line.substr(1, line.size() - 2));
+                continue;
+            }
+
+            size_t equals_pos = line.find('=');
+            if (equals_pos == std::string::npos)
+            {
+                warnings_.push_back("line " + std::to_string(line_number) + ": expected key = value");
+                continue;
+            }
+
+            std::string key = trim(line.substr(0, equals_pos));
+            std::string value = trim(line.substr(equals_pos + 1));
+            if (key.empty())
+            {
+                warnings_.push_back("line " + std::to_string(line_number) + ": missing key");
+                continue;
+            }
+
+            values_[makeKey(section, key)] = value;
+        }
+
+        return true;
+    }
+
+    bool Config::has(const std::string &section, const std::string &key) const
+    {
+        auto it = values_.find(makeKey(section, key));
+        return it != values_.end() && !it->second.empty();
+    }
+
+    std::string Config::getString(const std::string &section, const std::string &key,
+                                  const std::string &default_value) const
+    {
+        auto it = values_.find(makeKey(section, key));
+        return (it != values_.end() && !it->second.empty()) ? it->second : default_value;
+    }
+
+    bool Config::getBool(const std::string &section, const std::string &key, bool default_value) const
+    {
+        std::string value = getString(section, key);
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+
+        if (value == "true" || value == "yes" || value == "on" || value == "1")
+        {
+            return true;
+        }
+        if (value == "false" || value == "no" || value == "off" || value == "0")
+        {
+            return false;
+        }
+
+        return default_value;
+    }
+
+    size_t Config::getSize(const std::string &section, const std::string &key, size_t default_value) const
+    {
+        std::string value = getString(section, key);
+        if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0])))
+        {
+            return default_value;
+        }
+
+        char *end = nullptr;
+        unsigned long long parsed = std::strtoull(value.c_str(), &end, 10);
+        return (*end == '\0') ? static_cast<size_t>(parsed) : default_value;
+    }
+
+    double Config::getDouble(const std::string &section, const std::string &key, double default_value) const
+    {
+        std::string value = getString(section, key);
+        if (value.empty())
+        {
+            return default_value;
+        }
+
+        char *end = nullptr;
+        double parsed = std::strtod(value.c_str(), &end);
+        return (*end == '\0') ? parsed : default_value;
+    }
+
+    std::vector<std::string> Config::getList(const std::string &section, const std::string &key) const
+    {
+        std::vector<std::string> items;
+        std::string value = getString(section, key);
+
+        size_t start = 0;
+        while (start <= value.size())
+        {
+            size_t comma = value.find(',', start);
+            if (comma == std::string::npos)
+            {
+                comma = value.size();
+            }
+
+            std::string item = trim(value.substr(start, comma - start));
+            if (!item.empty())
+            {
+                items.push_back(item);
+            }
+            start = comma + 1;
+        }
+
+        return items;
+    }
+
+    std::string Config::makeKey(const std::string &section, const std::string &key)
+    {
+        return section + "." + key;
+    }
+
+    std::string Config::trim(const std::string &text)
+    {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos)
+        {
+            return "";
+        }
+
+        size_t last = text.find_last_not_of(" \t\r\n");
+        return text.substr(first, last - first + 1);
+    }
+
+} // namespace spellcheck
@@ -1,58 +1,341 @@
 #include "dictionary.h"
+#include "hash_util.h"
+#include "memory_tracker.h"
+#include "double_metaphone.h"
+#include "file_source.h"
 #include <fstream>
-#include <sstream>
 #include <algorithm>
 #include <iostream>
+#include <thread>
+#include <charconv>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 
 namespace spellcheck
 {
 
+    namespace
+    {
+        // Files are split so that each loader thread gets at least this much
+        constexpr size_t kMinBytesPerThread = 256 * 1024;
+
+        // Double Metaphone key symbols, packed as their position plus one
+        constexpr char kMetaphoneSymbols[] = "ABFHJKLMNPRSTX0";
+
+        uint16_t packMetaphoneKey(const std::string &key)
+        {
+            uint16_t code = 0;
+            for (size_t i = 0; i < 4; ++i)
+            {
+                uint16_t symbol = 0;
+                if (i < key.size())
+                {
+                    const char *found = std::strchr(kMetaphoneSymbols, key[i]);
+                    symbol = found ? static_cast<uint16_t>(found - kMetaphoneSymbols + 1) : 0;
+                }
+                code = static_cast<uint16_t>((code << 4) | symbol);
+            }
+            return code;
+        }
+
+        using TrieChild = std::pair<const char, std::unique_ptr<TrieNode>>;
+
+        size_t wordSetEntryBytes(const std::string &word)
+        {
+            return hashNodeBytes<std::string, true>() + stringHeapBytes(word);
+        }
+
+        size_t frequencyEntryBytes(const std::string &word)
+        {
+            return hashNodeBytes<std::pair<const std::string, uint32_t>, true>() + stringHeapBytes(word);
+        }
+
+        struct ParsedEntry
+        {
+            std::string word;
+            uint32_t frequency;
+        };
+
+        /**
+         * @brief Entries parsed from one line range, grouped by first byte
+         */
+        struct ParsedChunk
+        {
+            std::vector<std::vector<ParsedEntry>> by_first_char;
+            std::vector<LoadError> errors; // Line numbers relative to the chunk
+            size_t line_count = 0;
+        };
+
+        /**
+         * @brief Structures built for one share of first letters
+         */
+        struct LoadPartition
+        {
+            std::vector<unsigned char> first_chars;
+            size_t entry_count = 0;
+            std::unordered_set<std::string> words;
+            std::unordered_map<std::string, uint32_t> frequencies;
+            std::vector<PhoneticEntry> phonetic;
+            TrieNode trie;
+            MemoryStats memory;
+            uint64_t content_sum = 0;
+        };
+
+        /**
+         * @brief Run fn(0) .. fn(count - 1) on separate threads
+         */
+        template <typename Fn>
+        void runParallel(size_t count, Fn fn)
+        {
+            std::vector<std::thread> workers;
+            workers.reserve(count);
+            for (size_t i = 1; i < count; ++i)
+            {
+                workers.emplace_back(fn, i);
+            }
+            fn(0);
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        void parseRange(std::string_view data, size_t begin, size_t end, ParsedChunk &chunk)
+        {
+            const uint32_t default_frequency = 1;
+            chunk.by_first_char.resize(256);
+
+            std::string line;
+            size_t pos = begin;
+            while (pos < end)
+            {
+                size_t newline = data.find('\n', pos);
+                if (newline == std::string_view::npos || newline > end)
+                {
+                    newline = end;
+                }
+                chunk.line_count++;
+
+                // Remove whitespace
+                line.clear();
+                for (size_t i = pos; i < newline; ++i)
+                {
+                    if (!std::isspace(static_cast<unsigned char>(data[i])))
+                    {
+                        line += data[i];
+                    }
+                }
+                pos = newline + 1;
+
+                if (line.empty())
+                {
+                    continue;
+                }
+
+                // Check if line contains frequency information (word:frequency format)
+                uint32_t frequency = default_frequency;
+                size_t colon_pos = line.find(':');
+                if (colon_pos != std::string::npos)
+                {
+                    const char *first = line.data() + colon_pos + 1;
+                    const char *last = line.data() + line.size();
+                    unsigned long value = 0;
+                    auto result = std::from_chars(first, last, value);
+
+                    if (result.ec == std::errc::result_out_of_range ||
+                        (result.ec == std::errc() && value > UINT32_MAX))
+                    {
+                        chunk.errors.push_back({chunk.line_count, "frequency out of range"});
+                        continue;
+                    }
+                    if (result.ec != std::errc() || result.ptr != last)
+                    {
+                        chunk.errors.push_back({chunk.line_count,
+                                                "invalid frequency '" + std::string(first, last) + "'"});
+                        continue;
+                    }
+
+                    frequency = static_cast<uint32_t>(value);
+                    line.resize(colon_pos);
+                }
+
+                if (line.empty())
+                {
+                    chunk.errors.push_back({chunk.line_count, "missing word"});
+                    continue;
+                }
+
+                std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+                chunk.by_first_char[static_cast<unsigned char>(line[0])].push_back({line, frequency});
+            }
+        }
+
+        // One word's share of Dictionary::contentHash
+        uint64_t entryHash(const std::string &word, uint32_t frequency)
+        {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (unsigned char c : word)
+            {
+                hash ^= c;
+                hash *= 0x100000001b3ULL;
+            }
+            return mix64(hash ^ (static_cast<uint64_t>(frequency) << 32));
+        }
+    } // namespace
+
     Dictionary::Dictionary()
-        : trie_root_(std::make_unique<TrieNode>()), word_count_(0), memory_usage_(0)
+        : trie_root_(std::make_unique<TrieNode>()),
+          phonetic_algorithm_(PhoneticAlgorithm::Soundex), word_count_(0), content_sum_(0), load_threads_(0)
     {
+        memory_.trie = allocationSize(sizeof(TrieNode));
     }
 
     bool Dictionary::loadFromFile(const std::string &file_path)
     {
-        std::ifstream file(file_path);
-        if (!file.is_open())
+        // Parse straight out of the mapped file
+        FileSource source;
+        std::string_view data;
+        if (!source.open(file_path) || !source.readAll(data))
         {
             return false;
         }
 
         clear();
+        load_errors_.clear();
 
-        std::string line;
-        uint32_t default_frequency = 1;
+        const size_t heap_before_load = MemoryTracker::currentBytes();
+        buildFromBuffer(data);
+        const size_t heap_after_load = MemoryTracker::currentBytes();
 
-        while (std::getline(file, line))
+        if (MemoryTracker::isEnabled() && heap_after_load > heap_before_load)
         {
-            // Remove whitespace
-            line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
+            memory_.measured_at_load = heap_after_load - heap_before_load;
+        }
+
+        return true;
+    }
 
-            if (line.empty())
+    void Dictionary::buildFromBuffer(std::string_view data)
+    {
+        size_t thread_count = load_threads_ ? load_threads_ : std::thread::hardware_concurrency();
+        thread_count = std::max<size_t>(1, std::min(thread_count, data.size() / kMinBytesPerThread));
+
+        // Split into line-aligned ranges and parse them in parallel
+        std::vector<size_t> boundaries{0};
+        for (size_t i = 1; i < thread_count; ++i)
+        {
+            size_t pos = std::max(boundaries.back(), data.size() * i / thread_count);
+            size_t newline = data.find('\n', pos);
+            if (newline == std::string::npos)
             {
-                continue;
+                break;
             }
+            boundaries.push_back(newline + 1);
+        }
+        boundaries.push_back(data.size());
+
+        std::vector<ParsedChunk> chunks(boundaries.size() - 1);
+        runParallel(chunks.size(), [&](size_t i)
+                    { parseRange(data, boundaries[i], boundaries[i + 1], chunks[i]); });
 
-            // Check if line contains frequency information (word:frequency format)
-            size_t colon_pos = line.find(':');
-            if (colon_pos != std::string::npos)
+        size_t line_offset = 0;
+        for (auto &chunk : chunks)
+        {
+            for (auto &error : chunk.errors)
+            {
+                load_errors_.push_back({line_offset + error.line, std::move(error.message)});
+            }
+            line_offset += chunk.line_count;
+        }
+
+        // Balance first letters across partitions by entry count
+        std::vector<std::pair<size_t, unsigned char>> char_counts;
+        for (size_t c = 0; c < 256; ++c)
+        {
+            size_t count = 0;
+            for (const auto &chunk : chunks)
             {
-                std::string word = line.substr(0, colon_pos);
-                uint32_t frequency = static_cast<uint32_t>(std::stoul(line.substr(colon_pos + 1)));
-                addWord(word, frequency);
+                count += chunk.by_first_char[c].size();
             }
-            else
+            if (count > 0)
             {
-                addWord(line, default_frequency);
+                char_counts.emplace_back(count, static_cast<unsigned char>(c));
             }
         }
+        std::sort(char_counts.rbegin(), char_counts.rend());
 
-        file.close();
-        calculateMemoryUsage();
+        std::vector<LoadPartition> partitions(std::max<size_t>(1, std::min(thread_count, char_counts.size())));
+        for (const auto &char_count : char_counts)
+        {
+            auto lightest = std::min_element(partitions.begin(), partitions.end(),
+                                             [](const LoadPartition &a, const LoadPartition &b)
+                                             {
+                                                 return a.entry_count < b.entry_count;
+                                             });
+            lightest->first_chars.push_back(char_count.second);
+            lightest->entry_count += char_count.first;
+        }
 
-        return true;
+        // Build every structure for each partition. Words sharing a first
+        // letter also share trie branches, so the partitions are disjoint.
+        // Chunks are visited in file order so that the last frequency for a
+        // repeated word wins.
+        runParallel(partitions.size(), [&](size_t i)
+                    {
+                        LoadPartition &partition = partitions[i];
+                        for (unsigned char c : partition.first_chars)
+                        {
+                            for (const auto &chunk : chunks)
+                            {
+                                for (const auto &entry : chunk.by_first_char[c])
+                                {
+                                    partition.frequencies[entry.word] = entry.frequency;
+                                }
+                            }
+                        }
+
+                        partition.words.reserve(partition.frequencies.size());
+                        partition.phonetic.reserve(partition.frequencies.size());
+                        for (const auto &word_freq : partition.frequencies)
+                        {
+                            const std::string &word = word_freq.first;
+                            partition.words.insert(word);
+                            partition.phonetic.push_back({phoneticCodes(word), word});
+
+                            partition.memory.word_set += wordSetEntryBytes(word);
+                            partition.memory.frequency_map += frequencyEntryBytes(word);
+                            partition.memory.trie += insertIntoTrie(&partition.trie, word, word_freq.second);
+                            partition.content_sum += entryHash(word, word_freq.second);
+                        }
+                    });
+
+        // Splice the partitions together
+        size_t total_words = 0;
+        for (const auto &partition : partitions)
+        {
+            total_words += partition.words.size();
+        }
+        word_set_.reserve(total_words);
+        word_frequencies_.reserve(total_words);
+
+        std::vector<PhoneticEntry> phonetic_entries;
+        phonetic_entries.reserve(total_words);
+        for (auto &partition : partitions)
+        {
+            word_set_.merge(partition.words);
+            word_frequencies_.merge(partition.frequencies);
+            trie_root_->children.merge(partition.trie.children);
+            std::move(partition.phonetic.begin(), partition.phonetic.end(), std::back_inserter(phonetic_entries));
+            std::vector<PhoneticEntry>().swap(partition.phonetic);
+            memory_ += partition.memory;
+            content_sum_ += partition.content_sum;
+        }
+        word_count_ = word_set_.size();
+
+        // Bulk-build the phonetic buckets in one pass
+        phonetic_index_.build(std::move(phonetic_entries));
     }
 
     bool Dictionary::saveToFile(const std::string &file_path) const
@@ -63,9 +346,19 @@ namespace spellcheck
             return false;
         }
 
-        for (const auto &word_freq : word_frequencies_)
+        if (static_index_)
         {
-            file << word_freq.first << ":" << word_freq.second << "\n";
+            for (const auto &word : getAllWords())
+            {
+                file << word << ":" << getWordFrequency(word) << "\n";
+            }
+        }
+        else
+        {
+            for (const auto &word_freq : word_frequencies_)
+            {
+                file << word_freq.first << ":" << word_freq.second << "\n";
+            }
         }
 
         file.close();
@@ -84,22 +377,51 @@ namespace spellcheck
         std::transform(normalized_word.begin(), normalized_word.end(),
                        normalized_word.begin(), ::tolower);
 
-        // Add to hash set for fast lookup
-        bool is_new_word = word_set_.find(normalized_word) == word_set_.end();
-        word_set_.insert(normalized_word);
+        // The word's old entry leaves the content hash and the new one joins it
+        if (containsWord(normalized_word))
+        {
+            content_sum_ -= entryHash(normalized_word, getWordFrequency(normalized_word));
+        }
+        content_sum_ += entryHash(normalized_word, frequency);
+
+        bool is_new_word;
+        if (static_index_)
+        {
+            // Frozen: update in place if indexed, otherwise use the overlay
+            is_new_word = !containsWord(normalized_word);
+            if (!static_index_->setFrequency(normalized_word, frequency))
+            {
+                auto inserted = overlay_words_.insert_or_assign(normalized_word, frequency);
+                if (inserted.second)
+                {
+                    memory_.overlay += frequencyEntryBytes(inserted.first->first);
+                }
+            }
+        }
+        else
+        {
+            // Add to hash set for fast lookup
+            auto inserted = word_set_.insert(normalized_word);
+            is_new_word = inserted.second;
+            if (is_new_word)
+            {
+                memory_.word_set += wordSetEntryBytes(*inserted.first);
+            }
 
-        // Add/update frequency
-        word_frequencies_[normalized_word] = frequency;
+            // Add/update frequency
+            auto frequency_entry = word_frequencies_.insert_or_assign(normalized_word, frequency);
+            if (frequency_entry.second)
+            {
+                memory_.frequency_map += frequencyEntryBytes(frequency_entry.first->first);
+            }
+        }
 
         // Add to trie
-        insertIntoTrie(normalized_word, frequency);
-
-        // Add to phonetic map
-        std::string phonetic_code = generatePhoneticCode(normalized_word);
-        phonetic_map_[phonetic_code].push_back(normalized_word);
+        memory_.trie += insertIntoTrie(trie_root_.get(), normalized_word, frequency);
 
         if (is_new_word)
         {
+            phonetic_index_.insert(normalized_word, phoneticCodes(normalized_word));
             word_count_++;
         }
     }
@@ -109,28 +431,44 @@ namespace spellcheck
         std::string normalized_word = word;
         std::transform(normalized_word.begin(), normalized_word.end(),
                        normalized_word.begin(), ::tolower);
+        uint32_t frequency = getWordFrequency(normalized_word);
 
-        auto it = word_set_.find(normalized_word);
-        if (it == word_set_.end())
+        if (static_index_)
         {
-            return false;
+            if (!static_index_->erase(normalized_word))
+            {
+                auto overlay_it = overlay_words_.find(normalized_word);
+                if (overlay_it == overlay_words_.end())
+                {
+                    return false;
+                }
+
+                memory_.overlay -= frequencyEntryBytes(overlay_it->first);
+                overlay_words_.erase(overlay_it);
+            }
         }
+        else
+        {
+            auto it = word_set_.find(normalized_word);
+            if (it == word_set_.end())
+            {
+                return false;
+            }
 
-        word_set_.erase(it);
-        word_frequencies_.erase(normalized_word);
-
-        // Remove from phonetic map
-        std::string phonetic_code = generatePhoneticCode(normalized_word);
-        auto &phonetic_words = phonetic_map_[phonetic_code];
-        phonetic_words.erase(
-            std::remove(phonetic_words.begin(), phonetic_words.end(), normalized_word),
-            phonetic_words.end());
+            memory_.word_set -= wordSetEntryBytes(*it);
+            word_set_.erase(it);
 
-        if (phonetic_words.empty())
-        {
-            phonetic_map_.erase(phonetic_code);
+            auto frequency_it = word_frequencies_.find(normalized_word);
+            memory_.frequency_map -= frequencyEntryBytes(frequency_it->first);
+            word_frequencies_.erase(frequency_it);
         }
 
+        // Remove from trie, pruning branches that no longer lead to a word
+        memory_.trie -= removeFromTrie(trie_root_.get(), normalized_word);
+
+        phonetic_index_.erase(normalized_word, phoneticCodes(normalized_word));
+
+        content_sum_ -= entryHash(normalized_word, frequency);
         word_count_--;
         return true;
     }
@@ -141,6 +479,12 @@ namespace spellcheck
         std::transform(normalized_word.begin(), normalized_word.end(),
                        normalized_word.begin(), ::tolower);
 
+        if (static_index_)
+        {
+            return static_index_->contains(normalized_word) ||
+                   overlay_words_.find(normalized_word) != overlay_words_.end();
+        }
+
         return word_set_.find(normalized_word) != word_set_.end();
     }
 
@@ -150,6 +494,16 @@ namespace spellcheck
         std::transform(normalized_word.begin(), normalized_word.end(),
                        normalized_word.begin(), ::tolower);
 
+        if (static_index_)
+        {
+            auto it = overlay_words_.find(normalized_word);
+            if (it != overlay_words_.end())
+            {
+                return it->second;
+            }
+            return static_index_->frequency(normalized_word);
+        }
+
         auto it = word_frequencies_.find(normalized_word);
         return (it != word_frequencies_.end()) ? it->second : 0;
     }
@@ -188,22 +542,79 @@ namespace spellcheck
         return results;
     }
 
-    std::vector<std::string> Dictionary::getPhoneticMatches(const std::string &word) const
+    PhoneticMatches Dictionary::getPhoneticMatches(const std::string &word) const
+    {
+        return phonetic_index_.find(phoneticCodes(word));
+    }
+
+    bool Dictionary::soundsAlike(const std::string &word, const std::string &other) const
     {
-        std::string phonetic_code = generatePhoneticCode(word);
+        PhoneticCodes a = phoneticCodes(word);
+        PhoneticCodes b = phoneticCodes(other);
+        return a.primary == b.primary || a.primary == b.alternate ||
+               a.alternate == b.primary || a.alternate == b.alternate;
+    }
 
-        auto it = phonetic_map_.find(phonetic_code);
-        if (it != phonetic_map_.end())
+    void Dictionary::setPhoneticAlgorithm(PhoneticAlgorithm algorithm)
+    {
+        if (algorithm == phonetic_algorithm_)
         {
-            return it->second;
+            return;
         }
 
-        return {};
+        phonetic_algorithm_ = algorithm;
+
+        std::vector<PhoneticEntry> entries;
+        entries.reserve(word_count_);
+        for (auto &word : getAllWords())
+        {
+            PhoneticCodes codes = phoneticCodes(word);
+            entries.push_back({codes, std::move(word)});
+        }
+        phonetic_index_.build(std::move(entries));
+    }
+
+    bool Dictionary::freeze()
+    {
+        if (static_index_)
+        {
+            return true;
+        }
+
+        std::vector<std::pair<std::string, uint32_t>> entries(word_frequencies_.begin(),
+                                                              word_frequencies_.end());
+
+        auto index = std::make_unique<PerfectHashIndex>();
+        if (!index->build(entries))
+        {
+            return false;
+        }
+
+        static_index_ = std::move(index);
+        overlay_words_.clear();
+
+        // Release the hash containers entirely, including their bucket arrays
+        std::unordered_set<std::string>().swap(word_set_);
+        std::unordered_map<std::string, uint32_t>().swap(word_frequencies_);
+        memory_.word_set = 0;
+        memory_.frequency_map = 0;
+        memory_.overlay = 0;
+
+        return true;
     }
 
     std::vector<std::string> Dictionary::getAllWords() const
     {
         std::vector<std::string> words;
+
+        if (static_index_)
+        {
+            // The frozen index does not store strings; the trie holds every word
+            words.reserve(word_count_);
+            collectWordsWithPrefix(trie_root_.get(), "", words, static_cast<size_t>(-1));
+            return words;
+        }
+
         words.reserve(word_set_.size());
 
         for (const auto &word : word_set_)
@@ -214,77 +625,102 @@ namespace spellcheck
         return words;
     }
 
-    std::pair<size_t, size_t> Dictionary::getStats() const
+    uint64_t Dictionary::contentHash() const
     {
-        return {word_count_, memory_usage_};
+        return mix64(content_sum_ ^ word_count_);
     }
 
-    void Dictionary::clear()
+    std::pair<size_t, size_t> Dictionary::getStats() const
     {
-        word_set_.clear();
-        word_frequencies_.clear();
-        phonetic_map_.clear();
-        trie_root_ = std::make_unique<TrieNode>();
-        word_count_ = 0;
-        memory_usage_ = 0;
+        return {word_count_, getMemoryStats().total()};
     }
 
-    void Dictionary::calculateMemoryUsage()
+    MemoryStats Dictionary::getMemoryStats() const
     {
-        memory_usage_ = sizeof(Dictionary);
+        MemoryStats stats = memory_;
+        stats.word_set += bucketBytes(word_set_);
+        stats.frequency_map += bucketBytes(word_frequencies_);
+        stats.trie += bucketBytes(trie_root_->children);
+        stats.phonetic_map = phonetic_index_.memoryUsage();
+        stats.overlay += bucketBytes(overlay_words_);
+        if (static_index_)
+        {
+            stats.static_index = static_index_->memoryUsage();
+        }
 
-        // Calculate hash set memory
-        for (const auto &word : word_set_)
+        return stats;
+    }
+
+    void Dictionary::compact()
+    {
+        std::vector<std::pair<std::string, uint32_t>> entries;
+        entries.reserve(word_count_);
+        for (auto &word : getAllWords())
         {
-            memory_usage_ += word.size() + sizeof(std::string);
+            uint32_t frequency = getWordFrequency(word);
+            entries.emplace_back(std::move(word), frequency);
         }
 
-        // Calculate frequency map memory
-        for (const auto &word_freq : word_frequencies_)
+        bool was_frozen = isFrozen();
+        clear();
+
+        // Size the hash tables for the live words only
+        if (!was_frozen)
         {
-            memory_usage_ += word_freq.first.size() + sizeof(std::string) + sizeof(uint32_t);
+            word_set_.reserve(entries.size());
+            word_frequencies_.reserve(entries.size());
+        }
+        for (const auto &entry : entries)
+        {
+            addWord(entry.first, entry.second);
         }
 
-        // Calculate phonetic map memory
-        for (const auto &phonetic_entry : phonetic_map_)
+        // Fold the overlay back into a freshly built index
+        if (was_frozen)
         {
-            memory_usage_ += phonetic_entry.first.size() + sizeof(std::string);
-            for (const auto &word : phonetic_entry.second)
-            {
-                memory_usage_ += word.size() + sizeof(std::string);
-            }
+            freeze();
         }
+    }
 
-        // Note: Trie memory calculation is complex and omitted for simplicity
+    void Dictionary::clear()
+    {
+        word_set_.clear();
+        word_frequencies_.clear();
+        phonetic_index_.clear();
+        static_index_.reset();
+        overlay_words_.clear();
+        trie_root_ = std::make_unique<TrieNode>();
+        word_count_ = 0;
+        content_sum_ = 0;
+        memory_ = MemoryStats();
+        memory_.trie = allocationSize(sizeof(TrieNode));
     }
 
-    std::string Dictionary::generatePhoneticCode(const std::string &word) const
+    uint16_t Dictionary::generatePhoneticCode(const std::string &word)
     {
         if (word.empty())
         {
-            return "";
+            return 0;
         }
 
         // Simple Soundex-like algorithm
-        std::string code;
-        code.reserve(4);
-
-        // First character
-        code += std::toupper(word[0]);
+        unsigned char first = static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(word[0])));
+        uint16_t code = (first >= 'a' && first <= 'z') ? static_cast<uint16_t>(first - 'a' + 1) : 0;
 
-        // Convert consonants to numbers
-        for (size_t i = 1; i < word.length() && code.length() < 4; ++i)
+        // Convert consonants to class digits, three at most
+        size_t digit_count = 0;
+        uint16_t last_digit = 0;
+        for (size_t i = 1; i < word.length() && digit_count < 3; ++i)
         {
-            char c = std::tolower(word[i]);
-            char digit = '0';
+            uint16_t digit = 0;
 
-            switch (c)
+            switch (std::tolower(static_cast<unsigned char>(word[i])))
             {
             case 'b':
             case 'f':
             case 'p':
             case 'v':
-                digit = '1';
+                digit = 1;
                 break;
             case 'c':
             case 'g':
@@ -294,57 +730,122 @@ namespace spellcheck
             case 's':
             case 'x':
             case 'z':
-                digit = '2';
+                digit = 2;
                 break;
             case 'd':
             case 't':
-                digit = '3';
+                digit = 3;
                 break;
             case 'l':
-                digit = '4';
+                digit = 4;
                 break;
             case 'm':
             case 'n':
-                digit = '5';
+                digit = 5;
                 break;
             case 'r':
-                digit = '6';
+                digit = 6;
                 break;
             default:
                 continue; // Skip vowels and other characters
             }
 
             // Avoid consecutive duplicates
-            if (code.empty() || code.back() != digit)
+            if (digit != last_digit)
             {
-                code += digit;
+                code = static_cast<uint16_t>((code << 3) | digit);
+                last_digit = digit;
+                digit_count++;
             }
         }
 
         // Pad with zeros
-        while (code.length() < 4)
+        return static_cast<uint16_t>(code << (3 * (3 - digit_count)));
+    }
+
+    PhoneticCodes Dictionary::generateMetaphoneCodes(const std::string &word)
+    {
+        MetaphoneKeys keys = doubleMetaphone(word);
+        return {packMetaphoneKey(keys.primary), packMetaphoneKey(keys.alternate)};
+    }
+
+    PhoneticCodes Dictionary::phoneticCodes(const std::string &word) const
+    {
+        if (phonetic_algorithm_ == PhoneticAlgorithm::DoubleMetaphone)
         {
-            code += '0';
+            return generateMetaphoneCodes(word);
         }
 
-        return code;
+        uint16_t code = generatePhoneticCode(word);
+        return {code, code};
     }
 
-    void Dictionary::insertIntoTrie(const std::string &word, uint32_t frequency)
+    size_t Dictionary::insertIntoTrie(TrieNode *root, const std::string &word, uint32_t frequency)
     {
-        TrieNode *current = trie_root_.get();
+        TrieNode *current = root;
+        size_t bytes_added = 0;
 
         for (char c : word)
         {
-            if (current->children.find(c) == current->children.end())
+            auto it = current->children.find(c);
+            if (it == current->children.end())
             {
-                current->children[c] = std::make_unique<TrieNode>();
+                // The root's bucket array is accounted when stats are requested
+                size_t buckets_before = (current == root) ? 0 : bucketBytes(current->children);
+                it = current->children.emplace(c, std::make_unique<TrieNode>()).first;
+                size_t buckets_after = (current == root) ? 0 : bucketBytes(current->children);
+
+                bytes_added += allocationSize(sizeof(TrieNode)) + hashNodeBytes<TrieChild, false>() +
+                               buckets_after - buckets_before;
             }
-            current = current->children[c].get();
+            current = it->second.get();
         }
 
         current->is_word = true;
         current->frequency = frequency;
+
+        return bytes_added;
+    }
+
+    size_t Dictionary::removeFromTrie(TrieNode *root, const std::string &word)
+    {
+        // Record the path so empty branches can be pruned bottom-up
+        std::vector<TrieNode *> path{root};
+        for (char c : word)
+        {
+            auto it = path.back()->children.find(c);
+            if (it == path.back()->children.end())
+            {
+                return 0;
+            }
+            path.push_back(it->second.get());
+        }
+
+        TrieNode *node = path.back();
+        if (!node->is_word)
+        {
+            return 0;
+        }
+        node->is_word = false;
+        node->frequency = 0;
+
+        size_t bytes_freed = 0;
+        for (size_t depth = word.length(); depth > 0; --depth)
+        {
+            TrieNode *current = path[depth];
+            if (current->is_word || !current->children.empty())
+            {
+                break;
+            }
+
+            // The pruned node takes its (possibly grown) bucket array with it;
+            // erasing never shrinks the parent's bucket array
+            bytes_freed += allocationSize(sizeof(TrieNode)) + hashNodeBytes<TrieChild, false>() +
+                           bucketBytes(current->children);
+            path[depth - 1]->children.erase(word[depth - 1]);
+        }
+
+        return bytes_freed;
     }
 
     void Dictionary::collectWordsWithPrefix(TrieNode *node, const std::string &prefix,
@@ -0,0 +1,283 @@
+#include "directory_watcher.h"
+#include <algorithm>
+#include <iostream>
+#include <filesystem>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <fnmatch.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        constexpr uint32_t kDirectoryEvents = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE |
+                                              IN_DELETE_SELF | IN_ONLYDIR;
+
+        // Enough for many events; each is at most sizeof(inotify_event) + NAME_MAX + 1 bytes
+        constexpr size_t kEventBufferSize = 64 * 1024;
+
+        std::string joinPath(const std::string &directory, const char *name)
+        {
+            if (!directory.empty() && directory.back() == '/')
+            {
+                return directory + name;
+            }
+            return directory + "/" + name;
+        }
+
+        void sortUnique(std::vector<std::string> &paths)
+        {
+            std::sort(paths.begin(), paths.end());
+            paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+        }
+    } // namespace
+
+    DirectoryWatcher::DirectoryWatcher(const FileFilter &filter)
+        : fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)), filter_(filter)
+    {
+        if (fd_ < 0)
+        {
+            std::cerr << "Cannot watch files: " << std::strerror(errno) << std::endl;
+        }
+    }
+
+    DirectoryWatcher::~DirectoryWatcher()
+    {
+        if (fd_ >= 0)
+        {
+            close(fd_);
+        }
+    }
+
+    bool DirectoryWatcher::ignoresDirectory(const std::string &name) const
+    {
+        for (const auto &pattern : filter_.ignore_directories)
+        {
+            if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool DirectoryWatcher::accepts(const std::string &file_path) const
+    {
+        if (!acceptsPath(file_path, filter_))
+        {
+            return false;
+        }
+
+        std::error_code error;
+        uintmax_t size = std::filesystem::file_size(file_path, error);
+        return filter_.max_file_size == 0 || error || size <= filter_.max_file_size;
+    }
+
+    bool DirectoryWatcher::addTree(const std::string &directory, std::vector<std::string> *found)
+    {
+        namespace fs = std::filesystem;
+
+        int wd = inotify_add_watch(fd_, directory.c_str(), kDirectoryEvents);
+        if (wd < 0)
+        {
+            std::cerr << "Cannot watch directory: " << directory << " (" << std::strerror(errno) << ")" << std::endl;
+            return false;
+        }
+        directories_[wd] = directory;
+
+        std::error_code error;
+        fs::recursive_directory_iterator walk(directory, fs::directory_options::skip_permission_denied, error);
+        for (; !error && walk != fs::recursive_directory_iterator(); walk.increment(error))
+        {
+            const fs::directory_entry &entry = *walk;
+            std::error_code entry_error;
+            if (entry.is_directory(entry_error))
+            {
+                if (ignoresDirectory(entry.path().filename().string()))
+                {
+                    walk.disable_recursion_pending();
+                    continue;
+                }
+
+                wd = inotify_add_watch(fd_, entry.path().c_str(), kDirectoryEvents);
+                if (wd >= 0)
+                {
+                    directories_[wd] = entry.path().string();
+                }
+            }
+            else if (found && entry.is_regular_file(entry_error) && accepts(entry.path().string()))
+            {
+                found->push_back(entry.path().string());
+            }
+        }
+        return true;
+    }
+
+    bool DirectoryWatcher::watch(const std::string &directory)
+    {
+        if (fd_ < 0)
+        {
+            return false;
+        }
+        return addTree(directory, nullptr);
+    }
+
+    void DirectoryWatcher::readEvents(std::vector<std::string> &changed, std::vector<std::string> &removed, bool &rescan)
+    {
+        alignas(inotify_event) char buffer[kEventBufferSize];
+        while (true)
+        {
+            ssize_t length = read(fd_, buffer, sizeof(buffer));
+            if (length <= 0)
+            {
+                return;
+            }
+
+            for (char *cursor = buffer; cursor < buffer + length;)
+            {
+                const inotify_event *event = reinterpret_cast<const inotify_event *>(cursor);
+                cursor += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    rescan = true;
+                    continue;
+                }
+
+                auto directory = directories_.find(event->wd);
+                if (directory == directories_.end())
+                {
+                    continue;
+                }
+                if (event->mask & IN_IGNORED)
+                {
+                    directories_.erase(directory);
+                    continue;
+                }
+                if (event->len == 0)
+                {
+                    continue;
+                }
+
+                std::string path = joinPath(directory->second, event->name);
+                if (event->mask & IN_ISDIR)
+                {
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    {
+                        // Files may already be inside by the time the watch is added
+                        if (!ignoresDirectory(event->name))
+                        {
+                            addTree(path, &changed);
+                        }
+                    }
+                    else if (event->mask & IN_MOVED_FROM)
+                    {
+                        // Watches follow the moved directory; forget them under the old name
+                        std::string prefix = path + "/";
+                        for (auto it = directories_.begin(); it != directories_.end();)
+                        {
+                            if (it->second == path || it->second.compare(0, prefix.size(), prefix) == 0)
+                            {
+                                inotify_rm_watch(fd_, it->first);
+                                it = directories_.erase(it);
+                            }
+                            else
+                            {
+                                ++it;
+                            }
+                        }
+                        rescan = true;
+                    }
+                }
+                else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                {
+                    if (accepts(path))
+                    {
+                        changed.push_back(path);
+                    }
+                }
+                else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                {
+                    if (acceptsPath(path, filter_))
+                    {
+                        removed.push_back(path);
+                    }
+                }
+            }
+        }
+    }
+
+    bool DirectoryWatcher::waitForChanges(std::chrono::milliseconds debounce, WatchEvents &events)
+    {
+        events = WatchEvents();
+        if (fd_ < 0)
+        {
+            return false;
+        }
+
+        sigset_t mask;
+        pthread_sigmask(SIG_SETMASK, nullptr, &mask);
+        sigdelset(&mask, SIGINT);
+        sigdelset(&mask, SIGTERM);
+
+        struct timespec quiet;
+        quiet.tv_sec = debounce.count() / 1000;
+        quiet.tv_nsec = (debounce.count() % 1000) * 1000000;
+
+        pollfd poll_fd{fd_, POLLIN, 0};
+        bool bursting = false;
+        while (true)
+        {
+            // Block until the first event, then until the burst goes quiet
+            int ready = ppoll(&poll_fd, 1, bursting ? &quiet : nullptr, &mask);
+            if (ready < 0)
+            {
+                if (errno != EINTR)
+                {
+                    std::cerr << "Cannot watch files: " << std::strerror(errno) << std::endl;
+                }
+                return false;
+            }
+            if (ready == 0)
+            {
+                break;
+            }
+
+            readEvents(events.changed, events.removed, events.rescan);
+            bursting = !events.changed.empty() || !events.removed.empty() || events.rescan;
+        }
+
+        // A file both removed and written in one burst (an editor's save by rename) is reported as it is now
+        sortUnique(events.changed);
+        sortUnique(events.removed);
+        std::vector<std::string> removed;
+        for (auto &path : events.removed)
+        {
+            std::error_code error;
+            if (!std::filesystem::exists(path, error))
+            {
+                removed.push_back(std::move(path));
+            }
+            else if (!std::binary_search(events.changed.begin(), events.changed.end(), path))
+            {
+                events.changed.push_back(path);
+            }
+        }
+        events.removed = std::move(removed);
+        sortUnique(events.changed);
+        events.changed.erase(std::remove_if(events.changed.begin(), events.changed.end(), [](const std::string &path)
+                                            {
+                                                std::error_code error;
+                                                return !std::filesystem::is_regular_file(path, error);
+                                            }),
+                             events.changed.end());
+
+        return true;
+    }
+
+} // namespace spellcheck
@@ -0,0 +1,755 @@
+#include "double_metaphone.h"
+#include <cctype>
+#include <initializer_list>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        /**
+         * @brief State of one Double Metaphone encoding pass
+         *
+         * Follows the rules of the original published algorithm. The word is
+         * upper-cased and padded with spaces so that look-ahead past the end
+         * never needs a bounds check.
+         */
+        class MetaphoneEncoder
+        {
+        private:
+            std::string word_;
+            long length_;
+            long last_;
+            size_t max_length_;
+            bool slavo_germanic_;
+            MetaphoneKeys keys_;
+
+            char at(long pos) const
+            {
+                return (pos >= 0 && pos < static_cast<long>(word_.size())) ? word_[pos] : '\0';
+            }
+
+            bool isVowel(long pos) const
+            {
+                switch (at(pos))
+                {
+                case 'A':
+                case 'E':
+                case 'I':
+                case 'O':
+                case 'U':
+                case 'Y':
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            bool stringAt(long start, size_t length, std::initializer_list<const char *> options) const
+            {
+                if (start < 0 || start + static_cast<long>(length) > static_cast<long>(word_.size()))
+                {
+                    return false;
+                }
+                for (const char *option : options)
+                {
+                    if (word_.compare(start, length, option) == 0)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void add(const char *both)
+            {
+                add(both, both);
+            }
+
+            void add(const char *primary, const char *alternate)
+            {
+                keys_.primary += primary;
+                keys_.alternate += alternate;
+            }
+
+            bool done() const
+            {
+                return keys_.primary.size() >= max_length_ && keys_.alternate.size() >= max_length_;
+            }
+
+            long encodeC(long current);
+            long encodeG(long current);
+            long encodeS(long current);
+
+        public:
+            MetaphoneEncoder(const std::string &word, size_t max_length);
+
+            MetaphoneKeys encode();
+        };
+
+        MetaphoneEncoder::MetaphoneEncoder(const std::string &word, size_t max_length)
+            : max_length_(max_length)
+        {
+            for (char c : word)
+            {
+                word_ += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+            length_ = static_cast<long>(word_.size());
+            last_ = length_ - 1;
+            word_ += "     ";
+
+            slavo_germanic_ = word_.find('W') != std::string::npos || word_.find('K') != std::string::npos ||
+                              word_.find("CZ") != std::string::npos || word_.find("WITZ") != std::string::npos;
+        }
+
+        MetaphoneKeys MetaphoneEncoder::encode()
+        {
+            long current = 0;
+
+            // Skip silent letters at the start
+            if (stringAt(0, 2, {"GN", "KN", "PN", "WR", "PS"}))
+            {
+                current++;
+            }
+
+            // Initial X is pronounced Z, which maps to S
+            if (at(0) == 'X')
+            {
+                add("S");
+                current++;
+            }
+
+            while (current < length_ && !done())
+            {
+                switch (at(current))
+                {
+                case 'A':
+                case 'E':
+                case 'I':
+                case 'O':
+                case 'U':
+                case 'Y':
+                    // Vowels only count at the start
+                    if (current == 0)
+                    {
+                        add("A");
+                    }
+                    current++;
+                    break;
+
+                case 'B':
+                    add("P");
+                    current += (at(current + 1) == 'B') ? 2 : 1;
+                    break;
+
+                case 'C':
+                    current = encodeC(current);
+                    break;
+
+                case 'D':
+                    if (stringAt(current, 2, {"DG"}))
+                    {
+                        if (stringAt(current + 2, 1, {"I", "E", "Y"}))
+                        {
+                            add("J"); // edge
+                            current += 3;
+                        }
+                        else
+                        {
+                            add("TK"); // edgar
+                            current += 2;
+                        }
+                        break;
+                    }
+                    add("T");
+                    current += stringAt(current, 2, {"DT", "DD"}) ? 2 : 1;
+                    break;
+
+                case 'F':
+                    add("F");
+                    current += (at(current + 1) == 'F') ? 2 : 1;
+                    break;
+
+                case 'G':
+                    current = encodeG(current);
+                    break;
+
+                case 'H':
+                    // Only keep H between vowels or at the start before a vowel
+                    if ((current == 0 || isVowel(current - 1)) && isVowel(current + 1))
+                    {
+                        add("H");
+                        current += 2;
+                    }
+                    else
+                    {
+                        current++;
+                    }
+                    break;
+
+                case 'J':
+                    if (stringAt(current, 4, {"JOSE"}) || stringAt(0, 4, {"SAN "}))
+                    {
+                        if ((current == 0 && at(current + 4) == ' ') || stringAt(0, 4, {"SAN "}))
+                        {
+                            add("H");
+                        }
+                        else
+                        {
+                            add("J", "H");
+                        }
+                        current++;
+                        break;
+                    }
+
+                    if (current == 0)
+                    {
+                        add("J", "A");
+                    }
+                    else if (isVowel(current - 1) && !slavo_germanic_ &&
+                             (at(current + 1) == 'A' || at(current + 1) == 'O'))
+                    {
+                        add("J", "H");
+                    }
+                    else if (current == last_)
+                    {
+                        add("J", "");
+                    }
+                    else if (!stringAt(current + 1, 1, {"L", "T", "K", "S", "N", "M", "B", "Z"}) &&
+                             !stringAt(current - 1, 1, {"S", "K", "L"}))
+                    {
+                        add("J");
+                    }
+                    current += (at(current + 1) == 'J') ? 2 : 1;
+                    break;
+
+                case 'K':
+                    add("K");
+                    current += (at(current + 1) == 'K') ? 2 : 1;
+                    break;
+
+                case 'L':
+                    if (at(current + 1) == 'L')
+                    {
+                        // Spanish double L (cabrillo, gallegos)
+                        if ((current == length_ - 3 && stringAt(current - 1, 4, {"ILLO", "ILLA", "ALLE"})) ||
+                            ((stringAt(last_ - 1, 2, {"AS", "OS"}) || stringAt(last_, 1, {"A", "O"})) &&
+                             stringAt(current - 1, 4, {"ALLE"})))
+                        {
+                            add("L", "");
+                            current += 2;
+                            break;
+                        }
+                        current += 2;
+                    }
+                    else
+                    {
+                        current++;
+                    }
+                    add("L");
+                    break;
+
+                case 'M':
+                    add("M");
+                    if ((stringAt(current - 1, 3, {"UMB"}) &&
+                         (current + 1 == last_ || stringAt(current + 2, 2, {"ER"}))) ||
+                        at(current + 1) == 'M')
+                    {
+                        current += 2; // dumb, thumb
+                    }
+                    else
+                    {
+                        current++;
+                    }
+                    break;
+
+                case 'N':
+                    add("N");
+                    current += (at(current + 1) == 'N') ? 2 : 1;
+                    break;
+
+                case 'P':
+                    if (at(current + 1) == 'H')
+                    {
+                        add("F");
+                        current += 2;
+                        break;
+                    }
+                    add("P");
+                    current += stringAt(current + 1, 1, {"P", "B"}) ? 2 : 1; // campbell
+                    break;
+
+                case 'Q':
+                    add("K");
+                    current += (at(current + 1) == 'Q') ? 2 : 1;
+                    break;
+
+                case 'R':
+                    // French final R (rogier) is silent in the primary key
+                    if (current == last_ && !slavo_germanic_ && stringAt(current - 2, 2, {"IE"}) &&
+                        !stringAt(current - 4, 2, {"ME", "MA"}))
+                    {
+                        add("", "R");
+                    }
+                    else
+                    {
+                        add("R");
+                    }
+                    current += (at(current + 1) == 'R') ? 2 : 1;
+                    break;
+
+                case 'S':
+                    current = encodeS(current);
+                    break;
+
+                case 'T':
+                    if (stringAt(current, 4, {"TION"}) || stringAt(current, 3, {"TIA", "TCH"}))
+                    {
+                        add("X");
+                        current += 3;
+                        break;
+                    }
+                    if (stringAt(current, 2, {"TH"}) || stringAt(current, 3, {"TTH"}))
+                    {
+                        // thomas, thames
+                        if (stringAt(current + 2, 2, {"OM", "AM"}) || stringAt(0, 4, {"VAN ", "VON "}) ||
+                            stringAt(0, 3, {"SCH"}))
+                        {
+                            add("T");
+                        }
+                        else
+                        {
+                            add("0", "T");
+                        }
+                        current += 2;
+                        break;
+                    }
+                    add("T");
+                    current += stringAt(current + 1, 1, {"T", "D"}) ? 2 : 1;
+                    break;
+
+                case 'V':
+                    add("F");
+                    current += (at(current + 1) == 'V') ? 2 : 1;
+                    break;
+
+                case 'W':
+                    if (stringAt(current, 2, {"WR"}))
+                    {
+                        add("R");
+                        current += 2;
+                        break;
+                    }
+                    if (current == 0 && (isVowel(current + 1) || stringAt(current, 2, {"WH"})))
+                    {
+                        // Wasserman should match Vasserman
+                        if (isVowel(current + 1))
+                        {
+                            add("A", "F");
+                        }
+                        else
+                        {
+                            add("A");
+                        }
+                    }
+                    // Polish final W (filipowicz) and Germanic W (arnow)
+                    if ((current == last_ && isVowel(current - 1)) ||
+                        stringAt(current - 1, 5, {"EWSKI", "EWSKY", "OWSKI", "OWSKY"}) || stringAt(0, 3, {"SCH"}))
+                    {
+                        add("", "F");
+                        current++;
+                        break;
+                    }
+                    if (stringAt(current, 4, {"WICZ", "WITZ"}))
+                    {
+                        add("TS", "FX");
+                        current += 4;
+                        break;
+                    }
+                    current++;
+                    break;
+
+                case 'X':
+                    // French final X (breaux) is silent
+                    if (!(current == last_ &&
+                          (stringAt(current - 3, 3, {"IAU", "EAU"}) || stringAt(current - 2, 2, {"AU", "OU"}))))
+                    {
+                        add("KS");
+                    }
+                    current += stringAt(current + 1, 1, {"C", "X"}) ? 2 : 1;
+                    break;
+
+                case 'Z':
+                    if (at(current + 1) == 'H')
+                    {
+                        add("J"); // Chinese pinyin (zhao)
+                        current += 2;
+                        break;
+                    }
+                    if (stringAt(current + 1, 2, {"ZO", "ZI", "ZA"}) ||
+                        (slavo_germanic_ && current > 0 && at(current - 1) != 'T'))
+                    {
+                        add("S", "TS");
+                    }
+                    else
+                    {
+                        add("S");
+                    }
+                    current += (at(current + 1) == 'Z') ? 2 : 1;
+                    break;
+
+                default:
+                    current++;
+                    break;
+                }
+            }
+
+            if (keys_.primary.size() > max_length_)
+            {
+                keys_.primary.resize(max_length_);
+            }
+            if (keys_.alternate.size() > max_length_)
+            {
+                keys_.alternate.resize(max_length_);
+            }
+            return keys_;
+        }
+
+        long MetaphoneEncoder::encodeC(long current)
+        {
+            // Various Germanic spellings (bacher, macher)
+            if (current > 1 && !isVowel(current - 2) && stringAt(current - 1, 3, {"ACH"}) &&
+                at(current + 2) != 'I' &&
+                (at(current + 2) != 'E' || stringAt(current - 2, 6, {"BACHER", "MACHER"})))
+            {
+                add("K");
+                return current + 2;
+            }
+
+            if (current == 0 && stringAt(current, 6, {"CAESAR"}))
+            {
+                add("S");
+                return current + 2;
+            }
+
+            if (stringAt(current, 4, {"CHIA"}))
+            {
+                add("K"); // chianti
+                return current + 2;
+            }
+
+            if (stringAt(current, 2, {"CH"}))
+            {
+                if (current > 0 && stringAt(current, 4, {"CHAE"}))
+                {
+                    add("K", "X"); // michael
+                    return current + 2;
+                }
+
+                // Greek roots (chemistry, chorus)
+                if (current == 0 &&
+                    (stringAt(current + 1, 5, {"HARAC", "HARIS"}) ||
+                     stringAt(current + 1, 3, {"HOR", "HYM", "HIA", "HEM"})) &&
+                    !stringAt(0, 5, {"CHORE"}))
+                {
+                    add("K");
+                    return current + 2;
+                }
+
+                // Germanic, Greek, or otherwise 'ch' for 'kh' sound
+                if (stringAt(0, 4, {"VAN ", "VON "}) || stringAt(0, 3, {"SCH"}) ||
+                    stringAt(current - 2, 6, {"ORCHES", "ARCHIT", "ORCHID"}) ||
+                    stringAt(current + 2, 1, {"T", "S"}) ||
+                    ((stringAt(current - 1, 1, {"A", "O", "U", "E"}) || current == 0) &&
+                     stringAt(current + 2, 1, {"L", "R", "N", "M", "B", "H", "F", "V", "W", " "})))
+                {
+                    add("K");
+                }
+                else if (current > 0)
+                {
+                    if (stringAt(0, 2, {"MC"}))
+                    {
+                        add("K"); // mchugh
+                    }
+                    else
+                    {
+                        add("X", "K");
+                    }
+                }
+                else
+                {
+                    add("X");
+                }
+                return current + 2;
+            }
+
+            if (stringAt(current, 2, {"CZ"}) && !stringAt(current - 2, 4, {"WICZ"}))
+            {
+                add("S", "X"); // czerny
+                return current + 2;
+            }
+
+            if (stringAt(current + 1, 3, {"CIA"}))
+            {
+                add("X"); // focaccia
+                return current + 3;
+            }
+
+            // Double C, but not if it is McClellan
+            if (stringAt(current, 2, {"CC"}) && !(current == 1 && at(0) == 'M'))
+            {
+                if (stringAt(current + 2, 1, {"I", "E", "H"}) && !stringAt(current + 2, 2, {"HU"}))
+                {
+                    // accident, accede, succeed
+                    if ((current == 1 && at(current - 1) == 'A') || stringAt(current - 1, 5, {"UCCEE", "UCCES"}))
+                    {
+                        add("KS");
+                    }
+                    else
+                    {
+                        add("X"); // bacchus
+                    }
+                    return current + 3;
+                }
+
+                add("K"); // Pierce's rule
+                return current + 2;
+            }
+
+            if (stringAt(current, 2, {"CK", "CG", "CQ"}))
+            {
+                add("K");
+                return current + 2;
+            }
+
+            if (stringAt(current, 2, {"CI", "CE", "CY"}))
+            {
+                // Italian vs. English
+                if (stringAt(current, 3, {"CIO", "CIE", "CIA"}))
+                {
+                    add("S", "X");
+                }
+                else
+                {
+                    add("S");
+                }
+                return current + 2;
+            }
+
+            add("K");
+
+            // Mac Caffrey, Mac Gregor
+            if (stringAt(current + 1, 2, {" C", " Q", " G"}))
+            {
+                return current + 3;
+            }
+            if (stringAt(current + 1, 1, {"C", "K", "Q"}) && !stringAt(current + 1, 2, {"CE", "CI"}))
+            {
+                return current + 2;
+            }
+            return current + 1;
+        }
+
+        long MetaphoneEncoder::encodeG(long current)
+        {
+            if (at(current + 1) == 'H')
+            {
+                if (current > 0 && !isVowel(current - 1))
+                {
+                    add("K");
+                    return current + 2;
+                }
+
+                if (current == 0)
+                {
+                    // ghislane, ghiradelli
+                    add(at(current + 2) == 'I' ? "J" : "K");
+                    return current + 2;
+                }
+
+                // Parker's rule (with some further refinements): hugh, bough, broughton
+                if ((current > 1 && stringAt(current - 2, 1, {"B", "H", "D"})) ||
+                    (current > 2 && stringAt(current - 3, 1, {"B", "H", "D"})) ||
+                    (current > 3 && stringAt(current - 4, 1, {"B", "H"})))
+                {
+                    return current + 2;
+                }
+
+                // laugh, McLaughlin, cough, gough, rough, tough
+                if (current > 2 && at(current - 1) == 'U' && stringAt(current - 3, 1, {"C", "G", "L", "R", "T"}))
+                {
+                    add("F");
+                }
+                else if (current > 0 && at(current - 1) != 'I')
+                {
+                    add("K");
+                }
+                return current + 2;
+            }
+
+            if (at(current + 1) == 'N')
+            {
+                if (current == 1 && isVowel(0) && !slavo_germanic_)
+                {
+                    add("KN", "N");
+                }
+                else if (!stringAt(current + 2, 2, {"EY"}) && at(current + 1) != 'Y' && !slavo_germanic_)
+                {
+                    add("N", "KN"); // not e.g. cagney
+                }
+                else
+                {
+                    add("KN");
+                }
+                return current + 2;
+            }
+
+            // tagliaro
+            if (stringAt(current + 1, 2, {"LI"}) && !slavo_germanic_)
+            {
+                add("KL", "L");
+                return current + 2;
+            }
+
+            // -ges-, -gep-, -gel-, -gie- at beginning
+            if (current == 0 &&
+                (at(current + 1) == 'Y' ||
+                 stringAt(current + 1, 2, {"ES", "EP", "EB", "EL", "EY", "IB", "IL", "IN", "IE", "EI", "ER"})))
+            {
+                add("K", "J");
+                return current + 2;
+            }
+
+            // -ger-, -gy-
+            if ((stringAt(current + 1, 2, {"ER"}) || at(current + 1) == 'Y') &&
+                !stringAt(0, 6, {"DANGER", "RANGER", "MANGER"}) && !stringAt(current - 1, 1, {"E", "I"}) &&
+                !stringAt(current - 1, 3, {"RGY", "OGY"}))
+            {
+                add("K", "J");
+                return current + 2;
+            }
+
+            // Italian (biaggi)
+            if (stringAt(current + 1, 1, {"E", "I", "Y"}) || stringAt(current - 1, 4, {"AGGI", "OGGI"}))
+            {
+                if (stringAt(0, 4, {"VAN ", "VON "}) || stringAt(0, 3, {"SCH"}) || stringAt(current + 1, 2, {"ET"}))
+                {
+                    add("K"); // obvious Germanic
+                }
+                else if (stringAt(current + 1, 4, {"IER "}))
+                {
+                    add("J");
+                }
+                else
+                {
+                    add("J", "K");
+                }
+                return current + 2;
+            }
+
+            add("K");
+            return current + ((at(current + 1) == 'G') ? 2 : 1);
+        }
+
+        long MetaphoneEncoder::encodeS(long current)
+        {
+            // Special cases island, isle, carlisle, carlysle
+            if (stringAt(current - 1, 3, {"ISL", "YSL"}))
+            {
+                return current + 1;
+            }
+
+            if (current == 0 && stringAt(current, 5, {"SUGAR"}))
+            {
+                add("X", "S");
+                return current + 1;
+            }
+
+            if (stringAt(current, 2, {"SH"}))
+            {
+                // Germanic
+                add(stringAt(current + 1, 4, {"HEIM", "HOEK", "HOLM", "HOLZ"}) ? "S" : "X");
+                return current + 2;
+            }
+
+            // Italian and Armenian
+            if (stringAt(current, 3, {"SIO", "SIA"}) || stringAt(current, 4, {"SIAN"}))
+            {
+                if (!slavo_germanic_)
+                {
+                    add("S", "X");
+                }
+                else
+                {
+                    add("S");
+                }
+                return current + 3;
+            }
+
+            // German and anglicisations (smith matches schmidt, snider matches schneider)
+            if ((current == 0 && stringAt(current + 1, 1, {"M", "N", "L", "W"})) || stringAt(current + 1, 1, {"Z"}))
+            {
+                add("S", "X");
+                return current + (stringAt(current + 1, 1, {"Z"}) ? 2 : 1);
+            }
+
+            if (stringAt(current, 2, {"SC"}))
+            {
+                // Schlesinger's rule
+                if (at(current + 2) == 'H')
+                {
+                    // Dutch origin (school, schooner)
+                    if (stringAt(current + 3, 2, {"OO", "ER", "EN", "UY", "ED", "EM"}))
+                    {
+                        // schermerhorn, schenker
+                        if (stringAt(current + 3, 2, {"ER", "EN"}))
+                        {
+                            add("X", "SK");
+                        }
+                        else
+                        {
+                            add("SK");
+                        }
+                        return current + 3;
+                    }
+
+                    if (current == 0 && !isVowel(3) && at(3) != 'W')
+                    {
+                        add("X", "S");
+                    }
+                    else
+                    {
+                        add("X");
+                    }
+                    return current + 3;
+                }
+
+                if (stringAt(current + 2, 1, {"I", "E", "Y"}))
+                {
+                    add("S");
+                    return current + 3;
+                }
+
+                add("SK");
+                return current + 3;
+            }
+
+            // French final S (resnais, artois)
+            if (current == last_ && stringAt(current - 2, 2, {"AI", "OI"}))
+            {
+                add("", "S");
+            }
+            else
+            {
+                add("S");
+            }
+            return current + (stringAt(current + 1, 1, {"S", "Z"}) ? 2 : 1);
+        }
+    } // namespace
+
+    MetaphoneKeys doubleMetaphone(const std::string &word, size_t max_length)
+    {
+        return MetaphoneEncoder(word, max_length).encode();
+    }
+
+} // namespace spellcheck
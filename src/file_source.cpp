@@ -0,0 +1,248 @@
+#include "file_source.h"
+#include <algorithm>
+#include <iostream>
+#include <cerrno>
+#include <filesystem>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        // Bytes of a mapping handed out per chunk; a multiple of the page size
+        constexpr size_t kMapWindow = 16 * 1024 * 1024;
+
+        // Bytes read per call from files that cannot be mapped
+        constexpr size_t kReadBlock = 64 * 1024;
+
+        bool matchesAny(const std::vector<std::string> &patterns, const std::string &name)
+        {
+            for (const auto &pattern : patterns)
+            {
+                if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool acceptsFile(const std::filesystem::path &path, uintmax_t size, const FileFilter &filter)
+        {
+            if (filter.max_file_size > 0 && size > filter.max_file_size)
+            {
+                return false;
+            }
+            if (matchesAny(filter.ignore_files, path.filename().string()))
+            {
+                return false;
+            }
+            if (filter.extensions.empty())
+            {
+                return true;
+            }
+            std::string extension = path.extension().string();
+            return std::find(filter.extensions.begin(), filter.extensions.end(), extension) != filter.extensions.end();
+        }
+    } // namespace
+
+    FileSource::FileSource()
+        : fd_(-1), data_(nullptr), size_(0), offset_(0), failed_(false)
+    {
+    }
+
+    FileSource::~FileSource()
+    {
+        close();
+    }
+
+    void FileSource::close()
+    {
+        if (data_)
+        {
+            munmap(const_cast<char *>(data_), size_);
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+        fd_ = -1;
+        data_ = nullptr;
+        size_ = 0;
+        offset_ = 0;
+        buffer_.clear();
+        failed_ = false;
+    }
+
+    bool FileSource::open(const std::string &file_path)
+    {
+        close();
+
+        fd_ = ::open(file_path.c_str(), O_RDONLY);
+        if (fd_ < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd_, &info) != 0 || S_ISDIR(info.st_mode))
+        {
+            close();
+            return false;
+        }
+
+        // Empty files have nothing to map; pipes and devices are read instead
+        if (S_ISREG(info.st_mode) && info.st_size > 0)
+        {
+            size_t size = static_cast<size_t>(info.st_size);
+            void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (mapped != MAP_FAILED)
+            {
+                // Read front to back: aggressive read-ahead, early reclaim
+                madvise(mapped, size, MADV_SEQUENTIAL);
+                data_ = static_cast<const char *>(mapped);
+                size_ = size;
+            }
+        }
+
+        return true;
+    }
+
+    bool FileSource::next(std::string_view &chunk)
+    {
+        if (data_)
+        {
+            if (offset_ >= size_)
+            {
+                return false;
+            }
+
+            // The previous window has been consumed
+            if (offset_ >= kMapWindow)
+            {
+                madvise(const_cast<char *>(data_) + offset_ - kMapWindow, kMapWindow, MADV_DONTNEED);
+            }
+
+            size_t length = std::min(kMapWindow, size_ - offset_);
+            chunk = std::string_view(data_ + offset_, length);
+            offset_ += length;
+            return true;
+        }
+
+        size_t count = readIntoBuffer(false, kReadBlock);
+        chunk = std::string_view(buffer_.data(), count);
+        return count > 0;
+    }
+
+    bool FileSource::readAll(std::string_view &contents)
+    {
+        if (data_)
+        {
+            contents = std::string_view(data_ + offset_, size_ - offset_);
+            offset_ = size_;
+            return true;
+        }
+
+        buffer_.clear();
+        while (readIntoBuffer(true, kReadBlock) > 0)
+        {
+        }
+        contents = std::string_view(buffer_.data(), buffer_.size());
+        return !failed_;
+    }
+
+    size_t FileSource::readIntoBuffer(bool append, size_t max_bytes)
+    {
+        if (fd_ < 0 || failed_)
+        {
+            return 0;
+        }
+
+        size_t start = append ? buffer_.size() : 0;
+        buffer_.resize(start + max_bytes);
+
+        ssize_t count;
+        do
+        {
+            count = ::read(fd_, buffer_.data() + start, max_bytes);
+        } while (count < 0 && errno == EINTR);
+
+        if (count < 0)
+        {
+            failed_ = true;
+            count = 0;
+        }
+        buffer_.resize(start + static_cast<size_t>(count));
+        return static_cast<size_t>(count);
+    }
+
+    bool FileSource::exists(const std::string &file_path)
+    {
+        struct stat info;
+        return stat(file_path.c_str(), &info) == 0 && !S_ISDIR(info.st_mode);
+    }
+
+    std::vector<std::string> collectFiles(const std::vector<std::string> &paths, const FileFilter &filter)
+    {
+        namespace fs = std::filesystem;
+        std::vector<std::string> files;
+
+        for (const auto &path : paths)
+        {
+            std::error_code error;
+            if (!fs::is_directory(path, error))
+            {
+                files.push_back(path);
+                continue;
+            }
+
+            size_t first = files.size();
+            fs::recursive_directory_iterator walk(path, fs::directory_options::skip_permission_denied, error);
+            for (; !error && walk != fs::recursive_directory_iterator(); walk.increment(error))
+            {
+                const fs::directory_entry &entry = *walk;
+                std::error_code entry_error;
+                if (entry.is_directory(entry_error))
+                {
+                    if (matchesAny(filter.ignore_directories, entry.path().filename().string()))
+                    {
+                        walk.disable_recursion_pending();
+                    }
+                    continue;
+                }
+
+                if (entry.is_regular_file(entry_error) && acceptsFile(entry.path(), entry.file_size(entry_error), filter))
+                {
+                    files.push_back(entry.path().string());
+                }
+            }
+            if (error)
+            {
+                std::cerr << "Could not read directory: " << path << " (" << error.message() << ")" << std::endl;
+            }
+
+            std::sort(files.begin() + static_cast<std::ptrdiff_t>(first), files.end());
+        }
+
+        return files;
+    }
+
+    bool acceptsPath(const std::string &path, const FileFilter &filter)
+    {
+        std::filesystem::path file(path);
+        for (const auto &part : file.parent_path())
+        {
+            if (matchesAny(filter.ignore_directories, part.string()))
+            {
+                return false;
+            }
+        }
+        return acceptsFile(file, 0, filter);
+    }
+
+} // namespace spellcheck
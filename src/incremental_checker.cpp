@@ -0,0 +1,123 @@
+#include "incremental_checker.h"
+#include "stream_tokenizer.h"
+#include "file_source.h"
+#include <string_view>
+#include <iostream>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        // Offset of the start of each line, followed by the end of the text
+        std::vector<size_t> lineStarts(const std::string &text)
+        {
+            std::vector<size_t> starts{0};
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                if (text[i] == '\n')
+                {
+                    starts.push_back(i + 1);
+                }
+            }
+            if (starts.back() != text.size())
+            {
+                starts.push_back(text.size()); // Last line has no newline
+            }
+            return starts;
+        }
+
+        std::string_view lineAt(const std::string &text, const std::vector<size_t> &starts, size_t index)
+        {
+            return std::string_view(text).substr(starts[index], starts[index + 1] - starts[index]);
+        }
+    } // namespace
+
+    IncrementalChecker::IncrementalChecker(const SpellChecker &checker)
+        : checker_(checker), lines_checked_(0)
+    {
+    }
+
+    bool IncrementalChecker::check(const std::string &file_path, std::vector<Misspelling> &misspellings)
+    {
+        lines_checked_ = 0;
+        misspellings.clear();
+
+        FileSource source;
+        std::string_view view;
+        if (!source.open(file_path) || !source.readAll(view))
+        {
+            std::cerr << "Could not read file: " << file_path << std::endl;
+            files_.erase(file_path);
+            return false;
+        }
+        std::string contents(view);
+
+        DocumentFormat format = documentFormatForPath(file_path);
+        std::vector<size_t> starts = lineStarts(contents);
+        size_t line_count = starts.size() - 1;
+
+        // Lines [first, end) of the new version are tokenized; the rest keep their old results
+        size_t first = 0;
+        size_t end = line_count;
+        MisspellingVisitor collect = [&misspellings](const Misspelling &misspelling)
+        {
+            misspellings.push_back(misspelling);
+            return true;
+        };
+
+        // Plain text is tokenized line by line, so unchanged lines give unchanged results
+        auto previous = files_.find(file_path);
+        if (previous != files_.end() && format == DocumentFormat::PlainText && !checker_.hasContextModel())
+        {
+            const FileState &old = previous->second;
+            std::vector<size_t> old_starts = lineStarts(old.contents);
+            size_t old_count = old_starts.size() - 1;
+
+            size_t prefix = 0;
+            while (prefix < old_count && prefix < line_count &&
+                   lineAt(old.contents, old_starts, prefix) == lineAt(contents, starts, prefix))
+            {
+                ++prefix;
+            }
+            size_t suffix = 0;
+            while (suffix < old_count - prefix && suffix < line_count - prefix &&
+                   lineAt(old.contents, old_starts, old_count - 1 - suffix) ==
+                       lineAt(contents, starts, line_count - 1 - suffix))
+            {
+                ++suffix;
+            }
+            first = prefix;
+            end = line_count - suffix;
+
+            // Neighbouring words of misspellings next to the edit are not
+            // refreshed; only a context model uses them, and it rules this out
+            for (const auto &misspelling : old.misspellings)
+            {
+                if (misspelling.line <= first)
+                {
+                    misspellings.push_back(misspelling);
+                }
+            }
+            checker_.checkFragment(std::string_view(contents).substr(starts[first], starts[end] - starts[first]),
+                                   format, first + 1, collect);
+            for (const auto &misspelling : old.misspellings)
+            {
+                if (misspelling.line > old_count - suffix)
+                {
+                    misspellings.push_back(misspelling);
+                    misspellings.back().line = misspelling.line - old_count + line_count;
+                }
+            }
+        }
+        else
+        {
+            checker_.checkFragment(contents, format, 1, collect);
+        }
+
+        lines_checked_ = end - first;
+        files_[file_path] = FileState{std::move(contents), misspellings};
+        return true;
+    }
+
+} // namespace spellcheck
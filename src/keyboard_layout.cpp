@@ -0,0 +1,88 @@
+#include "keyboard_layout.h"
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        /**
+         * @brief Letter rows of a layout, top to bottom; '_' marks non-letter keys
+         */
+        struct LayoutRows
+        {
+            const char *rows[3];
+        };
+
+        // Horizontal stagger of each row relative to the top row, in key widths
+        constexpr double kRowOffsets[3] = {0.0, 0.25, 0.75};
+
+        // Squared key distances for the neighbour and second-ring costs
+        constexpr double kNeighbourDistanceSq = 1.6;
+        constexpr double kSecondRingDistanceSq = 4.6;
+
+        constexpr LayoutRows kQwertyRows = {{"qwertyuiop", "asdfghjkl", "zxcvbnm"}};
+        constexpr LayoutRows kDvorakRows = {{"___pyfgcrl", "aoeuidhtns", "_qjkxbmwvz"}};
+
+        constexpr KeyboardCostTable makeCostTable(const LayoutRows &layout)
+        {
+            double x[26] = {};
+            double y[26] = {};
+            bool present[26] = {};
+
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; layout.rows[row][column] != '\0'; ++column)
+                {
+                    char c = layout.rows[row][column];
+                    if (c >= 'a' && c <= 'z')
+                    {
+                        x[c - 'a'] = column + kRowOffsets[row];
+                        y[c - 'a'] = row;
+                        present[c - 'a'] = true;
+                    }
+                }
+            }
+
+            KeyboardCostTable table{};
+            for (int a = 0; a < 26; ++a)
+            {
+                for (int b = 0; b < 26; ++b)
+                {
+                    double dx = x[a] - x[b];
+                    double dy = y[a] - y[b];
+                    double distance_sq = dx * dx + dy * dy;
+
+                    float cost = 1.0f;
+                    if (a == b)
+                    {
+                        cost = 0.0f;
+                    }
+                    else if (present[a] && present[b] && distance_sq <= kNeighbourDistanceSq)
+                    {
+                        cost = 0.5f;
+                    }
+                    else if (present[a] && present[b] && distance_sq <= kSecondRingDistanceSq)
+                    {
+                        cost = 0.8f;
+                    }
+                    table.cost[a][b] = cost;
+                }
+            }
+
+            return table;
+        }
+
+        constexpr KeyboardCostTable kQwertyCosts = makeCostTable(kQwertyRows);
+        constexpr KeyboardCostTable kDvorakCosts = makeCostTable(kDvorakRows);
+
+        static_assert(kQwertyCosts.cost['q' - 'a']['w' - 'a'] == 0.5f, "q and w are neighbours on QWERTY");
+        static_assert(kQwertyCosts.cost['q' - 'a']['p' - 'a'] == 1.0f, "q and p are far apart on QWERTY");
+        static_assert(kDvorakCosts.cost['a' - 'a']['o' - 'a'] == 0.5f, "a and o are neighbours on Dvorak");
+    } // namespace
+
+    const KeyboardCostTable &keyboardCostTable(KeyboardLayout layout)
+    {
+        return layout == KeyboardLayout::Dvorak ? kDvorakCosts : kQwertyCosts;
+    }
+
+} // namespace spellcheck
@@ -1,15 +1,50 @@
 #include "spell_checker.h"
+#include "config.h"
+#include "suggestion_engine.h"
+#include "dictionary.h"
+#include "bigram_model.h"
+#include "stream_tokenizer.h"
+#include "file_source.h"
+#include "suggestion_cache.h"
+#include "unified_diff.h"
+#include "directory_watcher.h"
+#include "incremental_checker.h"
+#include "result_writer.h"
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <vector>
 #include <iomanip>
 #include <algorithm>
+#include <optional>
+#include <cstdlib>
+#include <filesystem>
+#include <chrono>
+#include <csignal>
+#include <unistd.h>
+
+/**
+ * @brief Settings from the [Output] section of the configuration file
+ */
+struct OutputOptions
+{
+    size_t suggestions_per_word = 3;
+    bool show_line_numbers = true;
+    bool show_column_numbers = true;
+    bool show_timing = false;
+    bool colored = false;
+    spellcheck::OutputFormat format = spellcheck::OutputFormat::Text;
+};
 
 void printUsage(const std::string &program_name)
 {
-    std::cout << "Usage: " << program_name << " [OPTIONS] [FILE]\n"
+    std::cout << "Usage: " << program_name << " [OPTIONS] [FILE|DIRECTORY...]\n"
               << "\nOptions:\n"
+              << "  --config PATH           Configuration file (default: ~/.spellchecker.conf or ./spellchecker.conf)\n"
+              << "  --no-config             Do not load any configuration file\n"
               << "  -d, --dictionary PATH    Specify dictionary file (default: dictionaries/en_US.dict)\n"
+              << "  -D, --add-dictionary PATH Load an additional domain dictionary (repeatable)\n"
+              << "  -p, --personal PATH      Personal word list; -a/-r changes are saved to it\n"
               << "  -i, --interactive        Interactive mode for spell checking\n"
               << "  -c, --case-sensitive     Enable case-sensitive checking\n"
               << "  --ignore-numbers        Ignore numbers (default: true)\n"
@@ -18,20 +53,34 @@ void printUsage(const std::string &program_name)
               << "  -w, --word WORD         Check a single word\n"
               << "  -a, --add WORD          Add word to dictionary\n"
               << "  -r, --remove WORD       Remove word from dictionary\n"
+              << "  --freeze                Serve lookups from a read-only perfect-hash index\n"
               << "  --stats                 Show dictionary statistics\n"
+              << "  --timing                Show how long suggestion generation took\n"
+              << "  --suggestion-cache PATH Reuse suggestions stored in PATH by earlier runs\n"
+              << "  --result-cache PATH     Skip files unchanged since the run that wrote PATH\n"
+              << "  --diff FILE             Check only the lines a unified diff adds (FILE may be -)\n"
+              << "  --watch DIR             Check DIR, then re-check files as they change until interrupted\n"
+              << "  --format FORMAT         Report errors as text, jsonl (one JSON object per line) or sarif\n"
+              << "  --stream                Print errors as they are found, reading FILE in blocks\n"
+              << "                          (FILE may be - for standard input)\n"
+              << "  --context-model PATH    Rerank suggestions with a bigram model built by --build-context-model\n"
+              << "  --build-context-model CORPUS OUTPUT\n"
+              << "                          Build a bigram model from a plain-text corpus and exit\n"
               << "  -h, --help              Show this help message\n"
               << "\nExamples:\n"
               << "  " << program_name << " document.txt\n"
+              << "  " << program_name << " docs/ README.md\n"
               << "  " << program_name << " -w \"teh\" -d my_dict.dict\n"
               << "  " << program_name << " -i\n";
 }
 
-void printSuggestions(const std::string &word, const std::vector<std::string> &suggestions)
+void printSuggestions(const std::string &word, const std::vector<std::string> &suggestions,
+                      bool truncated = false)
 {
     std::cout << "Word: \"" << word << "\" - ";
     if (suggestions.empty())
     {
-        std::cout << "No suggestions found.\n";
+        std::cout << "No suggestions found." << (truncated ? " (search truncated)" : "") << "\n";
     }
     else
     {
@@ -44,12 +93,71 @@ void printSuggestions(const std::string &word, const std::vector<std::string> &s
                 std::cout << ", ";
             }
         }
-        std::cout << "\n";
+        std::cout << (truncated ? " (search truncated)" : "") << "\n";
+    }
+}
+
+void printMisspelling(const spellcheck::Misspelling &error, const std::vector<std::string> &suggestions,
+                      const OutputOptions &options)
+{
+    const std::string &word = error.word;
+    size_t line = error.line;
+    size_t column = error.column;
+
+    if (options.show_line_numbers)
+    {
+        std::cout << "Line " << std::setw(4) << line;
+    }
+    if (options.show_column_numbers)
+    {
+        std::cout << (options.show_line_numbers ? ", " : "") << "Column " << std::setw(3) << column;
     }
+    if (options.show_line_numbers || options.show_column_numbers)
+    {
+        std::cout << ": ";
+    }
+    // Unknown words in red, suggestions in green
+    const char *word_color = options.colored ? "\033[1;31m" : "";
+    const char *suggestion_color = options.colored ? "\033[32m" : "";
+    const char *reset = options.colored ? "\033[0m" : "";
+    std::cout << "\"" << word_color << word << reset << "\"";
+
+    size_t shown = std::min(suggestions.size(), options.suggestions_per_word);
+    if (shown > 0)
+    {
+        std::cout << " -> ";
+        for (size_t i = 0; i < shown; ++i)
+        {
+            std::cout << suggestion_color << suggestions[i] << reset;
+            if (i < shown - 1)
+            {
+                std::cout << ", ";
+            }
+        }
+    }
+    std::cout << "\n";
 }
 
-void printFileResults(const std::vector<std::tuple<std::string, size_t, size_t>> &misspelled_words,
-                      spellcheck::SpellChecker &checker)
+void printSuggestionStats(const spellcheck::SuggestionBatch &batch, const spellcheck::SpellChecker &checker)
+{
+    std::cout << "Suggestions for " << batch.suggestions.size() << " distinct of " << batch.occurrences
+              << " misspelling(s) on " << batch.threads << " thread(s): "
+              << std::fixed << std::setprecision(1)
+              << (batch.wall_time.count() / 1000.0) << " ms wall, "
+              << (batch.cpu_time.count() / 1000.0) << " ms CPU\n";
+    std::cout.unsetf(std::ios::floatfield);
+
+    auto cache = checker.getSuggestionCacheStats();
+    if (cache.capacity > 0)
+    {
+        std::cout << "Suggestion cache: " << cache.entries << "/" << cache.capacity << " words, "
+                  << cache.hits << " hits, " << cache.misses << " misses, " << cache.evictions << " evictions, "
+                  << (cache.memory_bytes / 1024) << " KB\n";
+    }
+}
+
+void printFileResults(const std::vector<spellcheck::Misspelling> &misspelled_words,
+                      spellcheck::SpellChecker &checker, const OutputOptions &options)
 {
     if (misspelled_words.empty())
     {
@@ -57,33 +165,176 @@ void printFileResults(const std::vector<std::tuple<std::string, size_t, size_t>>
         return;
     }
 
+    // Suggestions for all errors are generated up front, in parallel
+    auto batch = checker.suggestAll(misspelled_words);
+
     std::cout << "Found " << misspelled_words.size() << " spelling error(s):\n\n";
 
     for (const auto &error : misspelled_words)
     {
-        const std::string &word = std::get<0>(error);
-        size_t line = std::get<1>(error);
-        size_t column = std::get<2>(error);
+        printMisspelling(error, batch.find(error), options);
+    }
 
-        std::cout << "Line " << std::setw(4) << line
-                  << ", Column " << std::setw(3) << column
-                  << ": \"" << word << "\"";
+    if (options.show_timing)
+    {
+        std::cout << "\n";
+        printSuggestionStats(batch, checker);
+    }
+}
 
-        auto suggestions = checker.getSuggestions(word);
-        if (!suggestions.empty())
+bool printBatchResults(const std::vector<spellcheck::FileCheckResult> &results,
+                       spellcheck::SpellChecker &checker, const OutputOptions &options)
+{
+    // Typos recur across files, so suggestions are generated once for the whole batch
+    std::vector<spellcheck::Misspelling> all_errors;
+    for (const auto &result : results)
+    {
+        all_errors.insert(all_errors.end(), result.misspellings.begin(), result.misspellings.end());
+    }
+    auto batch = checker.suggestAll(all_errors);
+
+    // Only files with errors are listed, so large trees stay readable
+    size_t checked = 0;
+    size_t cached = 0;
+    size_t errors = 0;
+    for (const auto &result : results)
+    {
+        if (!result.checked)
         {
-            std::cout << " -> ";
-            for (size_t i = 0; i < std::min(suggestions.size(), static_cast<size_t>(3)); ++i)
-            {
-                std::cout << suggestions[i];
-                if (i < std::min(suggestions.size(), static_cast<size_t>(3)) - 1)
-                {
-                    std::cout << ", ";
-                }
-            }
+            continue;
+        }
+        checked++;
+        cached += result.cached ? 1 : 0;
+        if (result.misspellings.empty())
+        {
+            continue;
+        }
+
+        errors += result.misspellings.size();
+        std::cout << result.path << ": Found " << result.misspellings.size() << " spelling error(s):\n\n";
+        for (const auto &error : result.misspellings)
+        {
+            printMisspelling(error, batch.find(error), options);
         }
         std::cout << "\n";
     }
+
+    std::cout << "Checked " << checked << " file(s), found " << errors << " spelling error(s).\n";
+    if (options.show_timing)
+    {
+        if (cached > 0)
+        {
+            std::cout << "Results reused for " << cached << " unchanged file(s)\n";
+        }
+        printSuggestionStats(batch, checker);
+    }
+    return checked == results.size();
+}
+
+bool streamFileResults(const std::string &file_path, spellcheck::SpellChecker &checker, const OutputOptions &options)
+{
+    // Errors are printed as they are found, so the count comes last
+    size_t count = 0;
+    auto print = [&](const spellcheck::Misspelling &error)
+    {
+        printMisspelling(error, checker.getSuggestionResult(error.word, error.previous, error.next).suggestions,
+                         options);
+        count++;
+        return true;
+    };
+
+    bool complete = file_path == "-" ? checker.checkStream(std::cin, spellcheck::DocumentFormat::PlainText, print)
+                                     : checker.checkFile(file_path, print);
+
+    if (count == 0)
+    {
+        std::cout << "No spelling errors found!\n";
+    }
+    else
+    {
+        std::cout << "\nFound " << count << " spelling error(s).\n";
+    }
+    return complete;
+}
+
+/**
+ * @brief Write each file's misspellings as soon as the file is checked
+ * @param file_paths Files to check
+ * @param checker Spell checker
+ * @param writer Machine-readable output
+ * @return false if a file could not be read
+ */
+bool writeBatchResults(const std::vector<std::string> &file_paths, spellcheck::SpellChecker &checker,
+                       spellcheck::ResultWriter &writer)
+{
+    size_t checked = 0;
+    checker.checkFiles(file_paths, true, [&checked, &writer](spellcheck::FileCheckResult &result)
+                       {
+                           checked += result.checked ? 1 : 0;
+                           writer.writeFile(result);
+                       });
+    return checked == file_paths.size();
+}
+
+/**
+ * @brief Write misspellings already found, such as those of a diff
+ * @param results Results without suggestions
+ * @param checker Spell checker
+ * @param writer Machine-readable output
+ * @return false if a file could not be read
+ */
+bool writeResults(const std::vector<spellcheck::FileCheckResult> &results, spellcheck::SpellChecker &checker,
+                  spellcheck::ResultWriter &writer)
+{
+    std::vector<spellcheck::Misspelling> all_errors;
+    for (const auto &result : results)
+    {
+        all_errors.insert(all_errors.end(), result.misspellings.begin(), result.misspellings.end());
+    }
+    auto batch = checker.suggestAll(all_errors);
+
+    bool complete = true;
+    for (const auto &result : results)
+    {
+        complete = complete && result.checked;
+        for (const auto &error : result.misspellings)
+        {
+            writer.write(result.path, error, batch.find(error));
+        }
+    }
+    return complete;
+}
+
+/**
+ * @brief Write a file's misspellings as they are found, reading it in blocks
+ * @param file_path File to check, or - for standard input
+ * @param checker Spell checker
+ * @param writer Machine-readable output
+ * @return false if the file could not be read
+ */
+bool writeStreamResults(const std::string &file_path, spellcheck::SpellChecker &checker,
+                        spellcheck::ResultWriter &writer)
+{
+    auto write = [&](const spellcheck::Misspelling &error)
+    {
+        writer.write(file_path, error, checker.getSuggestionResult(error.word, error.previous, error.next).suggestions);
+        return true;
+    };
+
+    return file_path == "-" ? checker.checkStream(std::cin, spellcheck::DocumentFormat::PlainText, write)
+                            : checker.checkFile(file_path, write);
+}
+
+/**
+ * @brief Finish machine-readable output
+ * @param writer Machine-readable output
+ * @param complete false if some input could not be checked
+ * @return Exit status
+ */
+int finishOutput(spellcheck::ResultWriter &writer, bool complete)
+{
+    writer.end();
+    return writer.flush() && complete ? 0 : 1;
 }
 
 void interactiveMode(spellcheck::SpellChecker &checker)
@@ -109,6 +360,7 @@ void interactiveMode(spellcheck::SpellChecker &checker)
                       << "  add <word>    Add word to dictionary\n"
                       << "  remove <word> Remove word from dictionary\n"
                       << "  stats         Show dictionary statistics\n"
+                      << "  compact       Rebuild dictionaries to release memory\n"
                       << "  quit/exit     Exit interactive mode\n";
             continue;
         }
@@ -149,6 +401,12 @@ void interactiveMode(spellcheck::SpellChecker &checker)
             std::cout << "Dictionary contains " << stats.first << " words, "
                       << "using " << (stats.second / 1024) << " KB of memory.\n";
         }
+        else if (command == "compact")
+        {
+            checker.compactDictionaries();
+            auto stats = checker.getDictionaryStats();
+            std::cout << "Compacted dictionaries to " << (stats.second / 1024) << " KB.\n";
+        }
         else
         {
             // Treat as word to check
@@ -159,26 +417,203 @@ void interactiveMode(spellcheck::SpellChecker &checker)
             }
             else
             {
-                auto suggestions = checker.getSuggestions(word);
-                printSuggestions(word, suggestions);
+                auto result = checker.getSuggestionResult(word);
+                printSuggestions(word, result.suggestions, result.truncated);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Load the configuration file
+ * @param config_path Explicit path, or empty to search the default locations
+ * @param config Configuration to fill
+ * @return false if an explicitly requested file could not be read
+ */
+bool loadConfig(const std::string &config_path, spellcheck::Config &config)
+{
+    if (!config_path.empty())
+    {
+        if (!config.loadFromFile(config_path))
+        {
+            std::cerr << "Error: Could not read configuration file: " << config_path << "\n";
+            return false;
+        }
+    }
+    else
+    {
+        std::vector<std::string> candidates;
+        if (const char *home = std::getenv("HOME"))
+        {
+            candidates.push_back(std::string(home) + "/.spellchecker.conf");
+        }
+        candidates.push_back("spellchecker.conf");
+
+        for (const auto &candidate : candidates)
+        {
+            if (config.loadFromFile(candidate))
+            {
+                break;
+            }
+        }
+    }
+
+    for (const auto &warning : config.getWarnings())
+    {
+        std::cerr << config.getPath() << ": " << warning << "\n";
+    }
+
+    return true;
+}
+
+/**
+ * @brief Build the rules for which files are checked from [File_Processing]
+ * @param config Loaded configuration
+ * @return File filter
+ */
+spellcheck::FileFilter fileFilterFromConfig(const spellcheck::Config &config)
+{
+    spellcheck::FileFilter filter;
+    filter.extensions = config.getList("File_Processing", "file_extensions");
+    filter.ignore_files = config.getList("File_Processing", "ignore_files");
+    filter.ignore_directories = config.getList("File_Processing", "ignore_directories");
+    filter.max_file_size = config.getSize("File_Processing", "max_file_size", 0) * 1024 * 1024;
+    return filter;
+}
+
+void onStopSignal(int)
+{
+    // Only wakes the watch loop, which then returns normally
+}
+
+/**
+ * @brief Check a directory, then re-check files as they change until SIGINT or SIGTERM
+ *
+ * The dictionaries stay loaded between checks, and edited plain-text
+ * files only have their changed lines tokenized again.
+ * @param directory Directory to watch
+ * @param checker Spell checker
+ * @param filter Rules for which files are checked
+ * @param debounce Quiet time that ends a burst of changes
+ * @param options Output options
+ * @param writer Machine-readable output, or null to print text
+ * @return false if the directory could not be watched
+ */
+bool watchDirectory(const std::string &directory, spellcheck::SpellChecker &checker,
+                    const spellcheck::FileFilter &filter, std::chrono::milliseconds debounce,
+                    const OutputOptions &options, spellcheck::ResultWriter *writer)
+{
+    // Delivered only while waiting for changes, so a check is never cut
+    // short and the caches are saved on the way out
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+    struct sigaction action = {};
+    action.sa_handler = onStopSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    // Watching starts first so files changed during the first check are not missed
+    spellcheck::DirectoryWatcher watcher(filter);
+    if (!watcher.watch(directory))
+    {
+        return false;
+    }
+    if (writer)
+    {
+        writeBatchResults(spellcheck::collectFiles({directory}, filter), checker, *writer);
+        writer->flush();
+    }
+    else
+    {
+        printBatchResults(checker.checkFiles(spellcheck::collectFiles({directory}, filter)), checker, options);
+    }
+    std::cout << "Watching " << directory << " for changes (press Ctrl-C to stop)\n" << std::flush;
+
+    spellcheck::IncrementalChecker incremental(checker);
+    spellcheck::WatchEvents events;
+    while (watcher.waitForChanges(debounce, events))
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (events.rescan)
+        {
+            incremental.clear();
+            events.changed = spellcheck::collectFiles({directory}, filter);
+        }
+        for (const auto &path : events.removed)
+        {
+            incremental.forget(path);
+            std::cout << path << ": Removed\n";
+        }
+        if (events.changed.empty())
+        {
+            std::cout << std::flush;
+            continue;
+        }
+
+        std::vector<spellcheck::FileCheckResult> results(events.changed.size());
+        size_t lines_checked = 0;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            results[i].path = events.changed[i];
+            results[i].checked = incremental.check(results[i].path, results[i].misspellings);
+            lines_checked += incremental.getLinesChecked();
+            if (results[i].checked && results[i].misspellings.empty())
+            {
+                std::cout << results[i].path << ": No spelling errors found!\n";
             }
         }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        if (writer)
+        {
+            writeResults(results, checker, *writer);
+            writer->flush();
+        }
+        else
+        {
+            printBatchResults(results, checker, options);
+        }
+        if (options.show_timing)
+        {
+            std::cout << "Re-checked " << lines_checked << " line(s) in " << std::fixed << std::setprecision(1)
+                      << (elapsed.count() / 1000.0) << " ms\n";
+            std::cout.unsetf(std::ios::floatfield);
+        }
+        std::cout << std::flush;
     }
+
+    return true;
 }
 
 int main(int argc, char *argv[])
 {
-    std::string dictionary_path = "dictionaries/en_US.dict";
-    std::string file_path;
+    std::string dictionary_path;
+    std::string config_path;
+    bool use_config = true;
+    std::vector<std::string> domain_dictionaries;
+    std::string personal_path;
+    std::vector<std::string> file_paths;
     std::string word_to_check;
     std::string word_to_add;
     std::string word_to_remove;
     bool interactive = false;
-    bool case_sensitive = false;
-    bool ignore_numbers = true;
-    bool ignore_urls = true;
+    std::optional<bool> case_sensitive;
+    std::optional<bool> ignore_numbers;
+    std::optional<bool> ignore_urls;
     bool show_stats = false;
-    size_t max_suggestions = 10;
+    bool freeze = false;
+    std::optional<size_t> max_suggestions;
+    std::string context_model_path;
+    bool stream_output = false;
+    bool show_timing = false;
+    std::optional<std::string> suggestion_cache_path;
+    std::optional<std::string> result_cache_path;
+    std::string diff_path;
+    std::string watch_path;
+    std::string format_name;
 
     // Parse command line arguments
     for (int i = 1; i < argc; ++i)
@@ -190,6 +625,22 @@ int main(int argc, char *argv[])
             printUsage(argv[0]);
             return 0;
         }
+        else if (arg == "--config")
+        {
+            if (i + 1 < argc)
+            {
+                config_path = argv[++i];
+            }
+            else
+            {
+                std::cerr << "Error: Configuration path required.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--no-config")
+        {
+            use_config = false;
+        }
         else if (arg == "-d" || arg == "--dictionary")
         {
             if (i + 1 < argc)
@@ -202,6 +653,30 @@ int main(int argc, char *argv[])
                 return 1;
             }
         }
+        else if (arg == "-D" || arg == "--add-dictionary")
+        {
+            if (i + 1 < argc)
+            {
+                domain_dictionaries.push_back(argv[++i]);
+            }
+            else
+            {
+                std::cerr << "Error: Dictionary path required.\n";
+                return 1;
+            }
+        }
+        else if (arg == "-p" || arg == "--personal")
+        {
+            if (i + 1 < argc)
+            {
+                personal_path = argv[++i];
+            }
+            else
+            {
+                std::cerr << "Error: Personal dictionary path required.\n";
+                return 1;
+            }
+        }
         else if (arg == "-i" || arg == "--interactive")
         {
             interactive = true;
@@ -266,13 +741,117 @@ int main(int argc, char *argv[])
                 return 1;
             }
         }
+        else if (arg == "--freeze")
+        {
+            freeze = true;
+        }
         else if (arg == "--stats")
         {
             show_stats = true;
         }
-        else if (arg[0] != '-')
+        else if (arg == "--stream")
+        {
+            stream_output = true;
+        }
+        else if (arg == "--timing")
+        {
+            show_timing = true;
+        }
+        else if (arg == "--diff")
+        {
+            if (i + 1 < argc)
+            {
+                diff_path = argv[++i];
+            }
+            else
+            {
+                std::cerr << "Error: Diff file required.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--watch")
+        {
+            if (i + 1 < argc)
+            {
+                watch_path = argv[++i];
+            }
+            else
+            {
+                std::cerr << "Error: Directory to watch required.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--format")
+        {
+            if (i + 1 < argc)
+            {
+                format_name = argv[++i];
+            }
+            else
+            {
+                std::cerr << "Error: Output format required.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--suggestion-cache")
         {
-            file_path = arg;
+            if (i + 1 < argc)
+            {
+                suggestion_cache_path = argv[++i];
+            }
+            else
+            {
+                std::cerr << "Error: Suggestion cache path required.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--result-cache")
+        {
+            if (i + 1 < argc)
+            {
+                result_cache_path = argv[++i];
+            }
+            else
+            {
+                std::cerr << "Error: Result cache path required.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--context-model")
+        {
+            if (i + 1 < argc)
+            {
+                context_model_path = argv[++i];
+            }
+            else
+            {
+                std::cerr << "Error: Context model path required.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--build-context-model")
+        {
+            if (i + 2 < argc)
+            {
+                std::string corpus_path = argv[++i];
+                std::string output_path = argv[++i];
+                if (!spellcheck::BigramModel::buildFromCorpus(corpus_path, output_path))
+                {
+                    std::cerr << "Error: Could not build context model from: " << corpus_path << "\n";
+                    return 1;
+                }
+                std::cout << "Wrote context model to " << output_path << "\n";
+                return 0;
+            }
+            else
+            {
+                std::cerr << "Error: Corpus and output paths required.\n";
+                return 1;
+            }
+        }
+        else if (arg[0] != '-' || arg == "-")
+        {
+            file_paths.push_back(arg);
         }
         else
         {
@@ -282,14 +861,89 @@ int main(int argc, char *argv[])
         }
     }
 
+    // Load configuration; command line options take precedence
+    spellcheck::Config config;
+    if (use_config && !loadConfig(config_path, config))
+    {
+        return 1;
+    }
+
+    if (dictionary_path.empty())
+    {
+        dictionary_path = config.getString("Dictionary", "default_dictionary", "dictionaries/en_US.dict");
+    }
+
+    OutputOptions output_options;
+    output_options.suggestions_per_word = config.getSize("Output", "suggestions_per_word", output_options.suggestions_per_word);
+    output_options.show_line_numbers = config.getBool("Output", "show_line_numbers", output_options.show_line_numbers);
+    output_options.show_column_numbers = config.getBool("Output", "show_column_numbers", output_options.show_column_numbers);
+    output_options.show_timing = show_timing;
+    if (format_name.empty())
+    {
+        format_name = config.getString("Output", "format", "text");
+    }
+    if (!spellcheck::parseOutputFormat(format_name, output_options.format))
+    {
+        std::cerr << "Error: Unknown output format: " << format_name << " (expected text, jsonl or sarif)\n";
+        return 1;
+    }
+    if (output_options.format == spellcheck::OutputFormat::Sarif && !watch_path.empty())
+    {
+        std::cerr << "Error: SARIF output is a single document and cannot be used with --watch.\n";
+        return 1;
+    }
+
+    // Machine-readable results own standard output; messages meant for people go to standard error
+    bool checks_files = word_to_check.empty() && !interactive && !show_stats;
+    if (output_options.format != spellcheck::OutputFormat::Text && checks_files)
+    {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+    // Escape codes only go to a terminal, never into a pipe or a file
+    output_options.colored = output_options.format == spellcheck::OutputFormat::Text &&
+                             config.getBool("Output", "colored_output", true) && isatty(STDOUT_FILENO);
+
     // Initialize spell checker
-    spellcheck::SpellChecker checker(dictionary_path);
+    spellcheck::SpellChecker checker;
+    checker.applyConfig(config);
+    checker.loadDictionary(dictionary_path);
+
+    for (const auto &domain_dictionary : domain_dictionaries)
+    {
+        checker.addDictionary(domain_dictionary);
+    }
+
+    if (!personal_path.empty())
+    {
+        checker.loadPersonalDictionary(personal_path);
+    }
 
     // Configure spell checker
-    checker.setCaseSensitive(case_sensitive);
-    checker.setIgnoreNumbers(ignore_numbers);
-    checker.setIgnoreUrls(ignore_urls);
-    checker.setMaxSuggestions(max_suggestions);
+    if (case_sensitive)
+    {
+        checker.setCaseSensitive(*case_sensitive);
+    }
+    if (ignore_numbers)
+    {
+        checker.setIgnoreNumbers(*ignore_numbers);
+    }
+    if (ignore_urls)
+    {
+        checker.setIgnoreUrls(*ignore_urls);
+    }
+    if (max_suggestions)
+    {
+        checker.setMaxSuggestions(*max_suggestions);
+    }
+    if (!context_model_path.empty() && !checker.loadContextModel(context_model_path))
+    {
+        return 1;
+    }
+
+    if (freeze && !checker.freezeDictionary())
+    {
+        std::cerr << "Warning: Could not freeze dictionary, using hash tables.\n";
+    }
 
     // Handle dictionary operations
     if (!word_to_add.empty())
@@ -304,13 +958,63 @@ int main(int argc, char *argv[])
         std::cout << "Removed \"" << word_to_remove << "\" from dictionary.\n";
     }
 
+    if (!personal_path.empty() && (!word_to_add.empty() || !word_to_remove.empty()))
+    {
+        if (!checker.savePersonalDictionary(personal_path))
+        {
+            std::cerr << "Warning: Could not save personal dictionary: " << personal_path << "\n";
+        }
+    }
+
+    // Opened once the dictionaries and settings are final, which version the stored suggestions and results
+    if (!suggestion_cache_path)
+    {
+        suggestion_cache_path = config.getString("Performance", "suggestion_cache_file");
+    }
+    if (!suggestion_cache_path->empty())
+    {
+        checker.openSuggestionStore(*suggestion_cache_path);
+    }
+    if (!result_cache_path)
+    {
+        result_cache_path = config.getString("Performance", "result_cache_file");
+    }
+    if (!result_cache_path->empty())
+    {
+        checker.openResultCache(*result_cache_path);
+    }
+
     // Show statistics
     if (show_stats)
     {
         auto stats = checker.getDictionaryStats();
+        auto memory = checker.getMemoryStats();
         std::cout << "Dictionary Statistics:\n";
         std::cout << "  Words: " << stats.first << "\n";
-        std::cout << "  Memory usage: " << (stats.second / 1024) << " KB\n";
+        if (config.getBool("Performance", "track_memory_usage", true))
+        {
+            std::cout << "  Memory usage: " << (stats.second / 1024) << " KB\n";
+            std::cout << "    Word set:      " << std::setw(8) << (memory.word_set / 1024) << " KB\n";
+            std::cout << "    Frequency map: " << std::setw(8) << (memory.frequency_map / 1024) << " KB\n";
+            std::cout << "    Trie:          " << std::setw(8) << (memory.trie / 1024) << " KB\n";
+            std::cout << "    Phonetic map:  " << std::setw(8) << (memory.phonetic_map / 1024) << " KB\n";
+            if (memory.static_index > 0 || memory.overlay > 0)
+            {
+                std::cout << "    Frozen index:  " << std::setw(8) << (memory.static_index / 1024) << " KB\n";
+                std::cout << "    Overlay:       " << std::setw(8) << (memory.overlay / 1024) << " KB\n";
+            }
+            if (memory.measured_at_load > 0)
+            {
+                std::cout << "  Measured by allocator at load: " << (memory.measured_at_load / 1024) << " KB\n";
+            }
+        }
+
+        auto phonetic = checker.getPhoneticStats();
+        std::cout << "  Phonetic buckets ("
+                  << (checker.getPhoneticAlgorithm() == spellcheck::PhoneticAlgorithm::DoubleMetaphone ? "double metaphone" : "soundex")
+                  << "): " << phonetic.buckets << "\n";
+        std::cout << "    Entries: " << phonetic.entries << ", median size: " << phonetic.median
+                  << ", p99: " << phonetic.p99 << ", largest: " << phonetic.largest << "\n";
         return 0;
     }
 
@@ -323,8 +1027,8 @@ int main(int argc, char *argv[])
         }
         else
         {
-            auto suggestions = checker.getSuggestions(word_to_check);
-            printSuggestions(word_to_check, suggestions);
+            auto result = checker.getSuggestionResult(word_to_check);
+            printSuggestions(word_to_check, result.suggestions, result.truncated);
         }
         return 0;
     }
@@ -336,14 +1040,91 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    auto writer = spellcheck::ResultWriter::create(output_options.format, STDOUT_FILENO,
+                                                   output_options.suggestions_per_word);
+    if (writer)
+    {
+        writer->begin();
+    }
+
+    // Handle watch mode
+    if (!watch_path.empty())
+    {
+        std::chrono::milliseconds debounce(config.getSize("Performance", "watch_debounce_ms", 50));
+        return watchDirectory(watch_path, checker, fileFilterFromConfig(config), debounce, output_options,
+                              writer.get())
+                   ? 0
+                   : 1;
+    }
+
+    // Handle diff checking
+    if (!diff_path.empty())
+    {
+        std::ifstream diff_file;
+        if (diff_path != "-")
+        {
+            diff_file.open(diff_path);
+            if (!diff_file)
+            {
+                std::cerr << "Error: Cannot open diff: " << diff_path << "\n";
+                return 1;
+            }
+        }
+
+        std::vector<spellcheck::DiffFile> diff;
+        if (!spellcheck::readUnifiedDiff(diff_path == "-" ? std::cin : diff_file, diff))
+        {
+            return 1;
+        }
+
+        spellcheck::FileFilter filter = fileFilterFromConfig(config);
+        diff.erase(std::remove_if(diff.begin(), diff.end(), [&filter](const spellcheck::DiffFile &file)
+                                  { return !spellcheck::acceptsPath(file.path, filter); }),
+                   diff.end());
+        if (writer)
+        {
+            return finishOutput(*writer, writeResults(checker.checkDiff(diff), checker, *writer));
+        }
+        return printBatchResults(checker.checkDiff(diff), checker, output_options) ? 0 : 1;
+    }
+
     // Handle file checking
-    if (!file_path.empty())
+    if (file_paths.size() == 1 && !std::filesystem::is_directory(file_paths[0]))
     {
+        const std::string &file_path = file_paths[0];
+        if (writer)
+        {
+            bool complete = stream_output || file_path == "-" ? writeStreamResults(file_path, checker, *writer)
+                                                              : writeBatchResults({file_path}, checker, *writer);
+            return finishOutput(*writer, complete);
+        }
+        if (stream_output || file_path == "-")
+        {
+            return streamFileResults(file_path, checker, output_options) ? 0 : 1;
+        }
+
         auto misspelled_words = checker.checkFile(file_path);
-        printFileResults(misspelled_words, checker);
+        printFileResults(misspelled_words, checker, output_options);
         return 0;
     }
 
+    if (!file_paths.empty())
+    {
+        if (std::find(file_paths.begin(), file_paths.end(), "-") != file_paths.end())
+        {
+            std::cerr << "Error: Standard input cannot be checked together with other files.\n";
+            return 1;
+        }
+
+        spellcheck::FileFilter filter = fileFilterFromConfig(config);
+        if (writer)
+        {
+            return finishOutput(*writer, writeBatchResults(spellcheck::collectFiles(file_paths, filter), checker, *writer));
+        }
+        auto results = checker.checkFiles(spellcheck::collectFiles(file_paths, filter));
+        return printBatchResults(results, checker, output_options) ? 0 : 1;
+    }
+
     // If no specific action, show usage
     printUsage(argv[0]);
     return 0;
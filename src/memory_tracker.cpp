@@ -0,0 +1,102 @@
+#include "memory_tracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace spellcheck
+{
+
+#ifdef SPELLCHECK_TRACK_ALLOCATIONS
+
+    namespace
+    {
+        std::atomic<size_t> live_bytes{0};
+
+        // Each block is prefixed with its size, padded to keep alignment
+        constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+        void *trackedAllocate(size_t size)
+        {
+            void *block = std::malloc(size + kHeaderSize);
+            if (!block)
+            {
+                throw std::bad_alloc();
+            }
+
+            *static_cast<size_t *>(block) = size;
+            live_bytes.fetch_add(size, std::memory_order_relaxed);
+            return static_cast<char *>(block) + kHeaderSize;
+        }
+
+        void trackedFree(void *ptr)
+        {
+            if (!ptr)
+            {
+                return;
+            }
+
+            void *block = static_cast<char *>(ptr) - kHeaderSize;
+            live_bytes.fetch_sub(*static_cast<size_t *>(block), std::memory_order_relaxed);
+            std::free(block);
+        }
+    } // namespace
+
+    bool MemoryTracker::isEnabled()
+    {
+        return true;
+    }
+
+    size_t MemoryTracker::currentBytes()
+    {
+        return live_bytes.load(std::memory_order_relaxed);
+    }
+
+#else
+
+    bool MemoryTracker::isEnabled()
+    {
+        return false;
+    }
+
+    size_t MemoryTracker::currentBytes()
+    {
+        return 0;
+    }
+
+#endif // SPELLCHECK_TRACK_ALLOCATIONS
+
+} // namespace spellcheck
+
+#ifdef SPELLCHECK_TRACK_ALLOCATIONS
+
+void *operator new(size_t size)
+{
+    return spellcheck::trackedAllocate(size);
+}
+
+void *operator new[](size_t size)
+{
+    return spellcheck::trackedAllocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    spellcheck::trackedFree(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    spellcheck::trackedFree(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    spellcheck::trackedFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    spellcheck::trackedFree(ptr);
+}
+
+#endif // SPELLCHECK_TRACK_ALLOCATIONS
@@ -0,0 +1,245 @@
+#include "perfect_hash.h"
+#include "hash_util.h"
+#include <algorithm>
+#include <numeric>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        // Displacements with this bit set store a slot index directly
+        constexpr uint32_t kDirectSlotFlag = 0x80000000u;
+
+        // Average number of words per bucket
+        constexpr size_t kBucketLoad = 4;
+
+        // Displacement attempts per bucket before giving up on a seed
+        constexpr uint32_t kMaxDisplacement = 1u << 20;
+
+        // Seeds to try before reporting failure
+        constexpr int kMaxSeedAttempts = 8;
+    } // namespace
+
+    PerfectHashIndex::PerfectHashIndex()
+        : seed_(0x5bd1e9955bd1e995ULL), size_(0)
+    {
+    }
+
+    bool PerfectHashIndex::build(const std::vector<std::pair<std::string, uint32_t>> &entries)
+    {
+        for (int attempt = 0; attempt < kMaxSeedAttempts; ++attempt)
+        {
+            if (tryBuild(entries))
+            {
+                return true;
+            }
+            seed_ = mix64(seed_ + attempt + 1);
+        }
+
+        displacements_.clear();
+        fingerprints_.clear();
+        frequencies_.clear();
+        size_ = 0;
+        return false;
+    }
+
+    bool PerfectHashIndex::tryBuild(const std::vector<std::pair<std::string, uint32_t>> &entries)
+    {
+        const size_t slot_count = entries.size();
+        const size_t bucket_count = std::max<size_t>(1, slot_count / kBucketLoad);
+
+        displacements_.assign(bucket_count, 0);
+        fingerprints_.assign(slot_count, 0);
+        frequencies_.assign(slot_count, 0);
+        size_ = 0;
+
+        if (slot_count == 0)
+        {
+            return true;
+        }
+
+        std::vector<uint64_t> hashes(slot_count);
+        std::vector<std::vector<uint32_t>> buckets(bucket_count);
+        for (size_t i = 0; i < slot_count; ++i)
+        {
+            hashes[i] = hashWord(entries[i].first);
+            buckets[(hashes[i] >> 32) % bucket_count].push_back(static_cast<uint32_t>(i));
+        }
+
+        // Place the largest buckets first while the table is still mostly empty
+        std::vector<uint32_t> order(bucket_count);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                  [&buckets](uint32_t a, uint32_t b)
+                  {
+                      return buckets[a].size() > buckets[b].size();
+                  });
+
+        std::vector<bool> occupied(slot_count, false);
+        std::vector<size_t> positions;
+        size_t next_free = 0;
+
+        for (uint32_t bucket : order)
+        {
+            const auto &members = buckets[bucket];
+            if (members.empty())
+            {
+                break;
+            }
+
+            if (members.size() == 1)
+            {
+                // Singletons take the next free slot directly
+                while (occupied[next_free])
+                {
+                    next_free++;
+                }
+                occupied[next_free] = true;
+                displacements_[bucket] = kDirectSlotFlag | static_cast<uint32_t>(next_free);
+                continue;
+            }
+
+            bool placed = false;
+            for (uint32_t displacement = 0; displacement < kMaxDisplacement && !placed; ++displacement)
+            {
+                positions.clear();
+                placed = true;
+
+                for (uint32_t index : members)
+                {
+                    size_t position = mix64(hashes[index] + displacement * 0x9e3779b97f4a7c15ULL) % slot_count;
+                    if (occupied[position] ||
+                        std::find(positions.begin(), positions.end(), position) != positions.end())
+                    {
+                        placed = false;
+                        break;
+                    }
+                    positions.push_back(position);
+                }
+
+                if (placed)
+                {
+                    for (size_t position : positions)
+                    {
+                        occupied[position] = true;
+                    }
+                    displacements_[bucket] = displacement;
+                }
+            }
+
+            if (!placed)
+            {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < slot_count; ++i)
+        {
+            size_t slot = slotFor(hashes[i]);
+            fingerprints_[slot] = fingerprintFor(hashes[i]);
+            frequencies_[slot] = entries[i].second;
+        }
+        size_ = slot_count;
+
+        return true;
+    }
+
+    bool PerfectHashIndex::contains(const std::string &word) const
+    {
+        if (fingerprints_.empty())
+        {
+            return false;
+        }
+
+        uint64_t hash = hashWord(word);
+        return fingerprints_[slotFor(hash)] == fingerprintFor(hash);
+    }
+
+    uint32_t PerfectHashIndex::frequency(const std::string &word) const
+    {
+        if (fingerprints_.empty())
+        {
+            return 0;
+        }
+
+        uint64_t hash = hashWord(word);
+        size_t slot = slotFor(hash);
+        return (fingerprints_[slot] == fingerprintFor(hash)) ? frequencies_[slot] : 0;
+    }
+
+    bool PerfectHashIndex::setFrequency(const std::string &word, uint32_t frequency)
+    {
+        if (fingerprints_.empty())
+        {
+            return false;
+        }
+
+        uint64_t hash = hashWord(word);
+        size_t slot = slotFor(hash);
+        if (fingerprints_[slot] != fingerprintFor(hash))
+        {
+            return false;
+        }
+
+        frequencies_[slot] = frequency;
+        return true;
+    }
+
+    bool PerfectHashIndex::erase(const std::string &word)
+    {
+        if (fingerprints_.empty())
+        {
+            return false;
+        }
+
+        uint64_t hash = hashWord(word);
+        size_t slot = slotFor(hash);
+        if (fingerprints_[slot] != fingerprintFor(hash))
+        {
+            return false;
+        }
+
+        fingerprints_[slot] = 0;
+        frequencies_[slot] = 0;
+        size_--;
+        return true;
+    }
+
+    size_t PerfectHashIndex::memoryUsage() const
+    {
+        return sizeof(PerfectHashIndex) +
+               displacements_.capacity() * sizeof(uint32_t) +
+               fingerprints_.capacity() * sizeof(uint32_t) +
+               frequencies_.capacity() * sizeof(uint32_t);
+    }
+
+    uint64_t PerfectHashIndex::hashWord(const std::string &word) const
+    {
+        // FNV-1a seeded with the index seed, then finalized
+        uint64_t hash = 0xcbf29ce484222325ULL ^ seed_;
+        for (unsigned char c : word)
+        {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        return mix64(hash);
+    }
+
+    size_t PerfectHashIndex::slotFor(uint64_t hash) const
+    {
+        uint32_t displacement = displacements_[(hash >> 32) % displacements_.size()];
+        if (displacement & kDirectSlotFlag)
+        {
+            return displacement & ~kDirectSlotFlag;
+        }
+        return mix64(hash + displacement * 0x9e3779b97f4a7c15ULL) % fingerprints_.size();
+    }
+
+    uint32_t PerfectHashIndex::fingerprintFor(uint64_t hash)
+    {
+        uint32_t fingerprint = static_cast<uint32_t>(mix64(hash ^ 0x2545f4914f6cdd1dULL));
+        return fingerprint == 0 ? 1 : fingerprint;
+    }
+
+} // namespace spellcheck
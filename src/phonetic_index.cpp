@@ -0,0 +1,330 @@
+#include "phonetic_index.h"
+#include "memory_tracker.h"
+#include <algorithm>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        // Pending and removed ids are folded in once they exceed this share
+        // of the built index (plus a floor, so small indexes stay pending)
+        constexpr size_t kRebuildDivisor = 4;
+        constexpr size_t kRebuildFloor = 256;
+
+        using PendingBucket = std::pair<const uint16_t, std::vector<uint32_t>>;
+    } // namespace
+
+    void PhoneticMatches::addSpan(const uint32_t *first, const uint32_t *last)
+    {
+        if (first != last)
+        {
+            spans_[span_count_++] = {first, last};
+        }
+    }
+
+    bool PhoneticMatches::accepts(size_t span, uint32_t id) const
+    {
+        if (index_->words_[id].empty())
+        {
+            return false;
+        }
+
+        // Words in both buckets were already yielded from the primary one
+        const PhoneticCodes &codes = index_->word_codes_[id];
+        return span < alternate_span_ || (codes.primary != primary_code_ && codes.alternate != primary_code_);
+    }
+
+    PhoneticMatches::iterator::iterator(const PhoneticMatches *view, size_t span, const uint32_t *current)
+        : view_(view), span_(span), current_(current)
+    {
+        skipDead();
+    }
+
+    const std::string &PhoneticMatches::iterator::operator*() const
+    {
+        return view_->index_->words_[*current_];
+    }
+
+    PhoneticMatches::iterator &PhoneticMatches::iterator::operator++()
+    {
+        ++current_;
+        skipDead();
+        return *this;
+    }
+
+    void PhoneticMatches::iterator::skipDead()
+    {
+        while (span_ < view_->span_count_)
+        {
+            if (current_ == view_->spans_[span_].second)
+            {
+                if (++span_ < view_->span_count_)
+                {
+                    current_ = view_->spans_[span_].first;
+                    continue;
+                }
+                current_ = nullptr;
+                return;
+            }
+            if (view_->accepts(span_, *current_))
+            {
+                return;
+            }
+            ++current_;
+        }
+    }
+
+    PhoneticIndex::PhoneticIndex()
+        : pending_count_(0), dead_count_(0), memory_(0)
+    {
+    }
+
+    void PhoneticIndex::build(std::vector<PhoneticEntry> entries)
+    {
+        clear();
+        if (entries.empty())
+        {
+            return;
+        }
+
+        words_.reserve(entries.size());
+        word_codes_.reserve(entries.size());
+        for (auto &entry : entries)
+        {
+            memory_ += stringHeapBytes(entry.word);
+            word_codes_.push_back(entry.codes);
+            words_.push_back(std::move(entry.word));
+        }
+        rebuild();
+    }
+
+    void PhoneticIndex::insert(const std::string &word, PhoneticCodes codes)
+    {
+        if (word.empty() || findId(word, codes.primary) != words_.size())
+        {
+            return;
+        }
+
+        uint32_t id = static_cast<uint32_t>(words_.size());
+        words_.push_back(word);
+        word_codes_.push_back(codes);
+        memory_ += stringHeapBytes(words_.back());
+
+        addPending(codes.primary, id);
+        if (codes.alternate != codes.primary)
+        {
+            addPending(codes.alternate, id);
+        }
+        pending_count_++;
+
+        maybeRebuild();
+    }
+
+    void PhoneticIndex::addPending(uint16_t code, uint32_t id)
+    {
+        auto inserted = pending_.try_emplace(code);
+        auto &bucket = inserted.first->second;
+        size_t buffer_before = vectorBufferBytes(bucket);
+        if (inserted.second)
+        {
+            memory_ += hashNodeBytes<PendingBucket, false>();
+        }
+        bucket.push_back(id);
+        memory_ += vectorBufferBytes(bucket) - buffer_before;
+    }
+
+    bool PhoneticIndex::erase(const std::string &word, PhoneticCodes codes)
+    {
+        size_t id = findId(word, codes.primary);
+        if (id == words_.size())
+        {
+            return false;
+        }
+
+        // The id stays in its bucket until the next rebuild
+        memory_ -= stringHeapBytes(words_[id]);
+        std::string().swap(words_[id]);
+        dead_count_++;
+
+        maybeRebuild();
+        return true;
+    }
+
+    PhoneticMatches PhoneticIndex::find(PhoneticCodes codes) const
+    {
+        PhoneticMatches matches;
+        matches.index_ = this;
+        matches.primary_code_ = codes.primary;
+
+        appendSpans(matches, codes.primary);
+        matches.alternate_span_ = matches.span_count_;
+        if (codes.alternate != codes.primary)
+        {
+            appendSpans(matches, codes.alternate);
+        }
+
+        return matches;
+    }
+
+    void PhoneticIndex::appendSpans(PhoneticMatches &matches, uint16_t code) const
+    {
+        auto found = std::lower_bound(codes_.begin(), codes_.end(), code);
+        if (found != codes_.end() && *found == code)
+        {
+            size_t bucket = static_cast<size_t>(found - codes_.begin());
+            matches.addSpan(ids_.data() + offsets_[bucket], ids_.data() + offsets_[bucket + 1]);
+        }
+
+        auto it = pending_.find(code);
+        if (it != pending_.end())
+        {
+            matches.addSpan(it->second.data(), it->second.data() + it->second.size());
+        }
+    }
+
+    PhoneticBucketStats PhoneticIndex::getBucketStats() const
+    {
+        std::unordered_map<uint16_t, size_t> pending_sizes;
+        for (const auto &bucket : pending_)
+        {
+            pending_sizes[bucket.first] = bucket.second.size();
+        }
+
+        std::vector<size_t> sizes;
+        for (size_t bucket = 0; bucket < codes_.size(); ++bucket)
+        {
+            size_t size = offsets_[bucket + 1] - offsets_[bucket];
+            auto it = pending_sizes.find(codes_[bucket]);
+            if (it != pending_sizes.end())
+            {
+                size += it->second;
+                pending_sizes.erase(it);
+            }
+            sizes.push_back(size);
+        }
+        for (const auto &bucket : pending_sizes)
+        {
+            sizes.push_back(bucket.second);
+        }
+
+        PhoneticBucketStats stats;
+        if (sizes.empty())
+        {
+            return stats;
+        }
+
+        std::sort(sizes.begin(), sizes.end());
+        stats.buckets = sizes.size();
+        for (size_t size : sizes)
+        {
+            stats.entries += size;
+        }
+        stats.largest = sizes.back();
+        stats.median = sizes[sizes.size() / 2];
+        stats.p99 = sizes[sizes.size() * 99 / 100];
+        return stats;
+    }
+
+    void PhoneticIndex::clear()
+    {
+        words_.clear();
+        word_codes_.clear();
+        codes_.clear();
+        offsets_.clear();
+        ids_.clear();
+        pending_.clear();
+        pending_count_ = 0;
+        dead_count_ = 0;
+        memory_ = 0;
+    }
+
+    size_t PhoneticIndex::memoryUsage() const
+    {
+        return memory_ + vectorBufferBytes(words_) + vectorBufferBytes(word_codes_) +
+               vectorBufferBytes(codes_) + vectorBufferBytes(offsets_) + vectorBufferBytes(ids_) + bucketBytes(pending_);
+    }
+
+    size_t PhoneticIndex::findId(const std::string &word, uint16_t code) const
+    {
+        for (const std::string &candidate : find({code, code}))
+        {
+            if (candidate == word)
+            {
+                return static_cast<size_t>(&candidate - words_.data());
+            }
+        }
+        return words_.size();
+    }
+
+    void PhoneticIndex::rebuild()
+    {
+        // Drop removed words, keeping the survivors in id order
+        if (dead_count_ > 0)
+        {
+            size_t live = 0;
+            for (size_t id = 0; id < words_.size(); ++id)
+            {
+                if (!words_[id].empty())
+                {
+                    words_[live] = std::move(words_[id]);
+                    word_codes_[live] = word_codes_[id];
+                    live++;
+                }
+            }
+            words_.resize(live);
+            word_codes_.resize(live);
+            words_.shrink_to_fit();
+            word_codes_.shrink_to_fit();
+            dead_count_ = 0;
+        }
+
+        for (const auto &bucket : pending_)
+        {
+            memory_ -= hashNodeBytes<PendingBucket, false>() + vectorBufferBytes(bucket.second);
+        }
+        std::unordered_map<uint16_t, std::vector<uint32_t>>().swap(pending_);
+        pending_count_ = 0;
+
+        // Sort (code, id) pairs; a word with a distinct alternate code is
+        // listed under both
+        std::vector<std::pair<uint16_t, uint32_t>> postings;
+        postings.reserve(word_codes_.size());
+        for (size_t id = 0; id < word_codes_.size(); ++id)
+        {
+            const PhoneticCodes &codes = word_codes_[id];
+            postings.emplace_back(codes.primary, static_cast<uint32_t>(id));
+            if (codes.alternate != codes.primary)
+            {
+                postings.emplace_back(codes.alternate, static_cast<uint32_t>(id));
+            }
+        }
+        std::sort(postings.begin(), postings.end());
+
+        codes_.clear();
+        offsets_.clear();
+        ids_.clear();
+        ids_.reserve(postings.size());
+        for (const auto &posting : postings)
+        {
+            if (codes_.empty() || codes_.back() != posting.first)
+            {
+                codes_.push_back(posting.first);
+                offsets_.push_back(static_cast<uint32_t>(ids_.size()));
+            }
+            ids_.push_back(posting.second);
+        }
+        offsets_.push_back(static_cast<uint32_t>(ids_.size()));
+        codes_.shrink_to_fit();
+        offsets_.shrink_to_fit();
+    }
+
+    void PhoneticIndex::maybeRebuild()
+    {
+        if (pending_count_ + dead_count_ > ids_.size() / kRebuildDivisor + kRebuildFloor)
+        {
+            rebuild();
+        }
+    }
+
+} // namespace spellcheck
@@ -0,0 +1,336 @@
+#include "result_cache.h"
+#include "hash_util.h"
+#include "file_source.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <sys/stat.h>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        constexpr char kMagic[4] = {'S', 'C', 'R', 'C'};
+        constexpr uint32_t kVersion = 2; // 2: columns count characters, not bytes
+
+        // Files changed more recently than this when stamped may change again unnoticed
+        constexpr int64_t kRacyWindowNs = 1000000000;
+
+        constexpr uint64_t kPrime1 = 0x9e3779b185ebca87ULL;
+        constexpr uint64_t kPrime2 = 0xc2b2ae3d27d4eb4fULL;
+
+        uint64_t rotl(uint64_t x, int bits)
+        {
+            return (x << bits) | (x >> (64 - bits));
+        }
+
+        int64_t mtimeOf(const struct stat &info)
+        {
+            return static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+        }
+
+        template <typename T>
+        void put(std::string &out, T value)
+        {
+            out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        void putString(std::string &out, const std::string &text)
+        {
+            put<uint32_t>(out, static_cast<uint32_t>(text.size()));
+            out += text;
+        }
+
+        // Bounds-checked reads from a loaded cache file
+        class Reader
+        {
+        private:
+            const std::string &data_;
+            size_t offset_;
+
+        public:
+            explicit Reader(const std::string &data) : data_(data), offset_(0) {}
+
+            template <typename T>
+            bool get(T &value)
+            {
+                if (data_.size() - offset_ < sizeof(T))
+                {
+                    return false;
+                }
+                std::memcpy(&value, data_.data() + offset_, sizeof(T));
+                offset_ += sizeof(T);
+                return true;
+            }
+
+            bool getString(std::string &text)
+            {
+                uint32_t length;
+                if (!get(length) || data_.size() - offset_ < length)
+                {
+                    return false;
+                }
+                text.assign(data_, offset_, length);
+                offset_ += length;
+                return true;
+            }
+
+            bool atEnd() const { return offset_ == data_.size(); }
+        };
+    } // namespace
+
+    bool FileStamp::read(const std::string &file_path, FileStamp &stamp)
+    {
+        struct stat info;
+        if (stat(file_path.c_str(), &info) != 0)
+        {
+            return false;
+        }
+        stamp.mtime_ns = mtimeOf(info);
+        stamp.size = static_cast<uint64_t>(info.st_size);
+        return true;
+    }
+
+    ContentHasher::ContentHasher()
+        : state_(kPrime2), length_(0), tail_size_(0)
+    {
+    }
+
+    void ContentHasher::mixWord(uint64_t word)
+    {
+        state_ = rotl(state_ ^ (word * kPrime1), 31) * kPrime2;
+    }
+
+    void ContentHasher::update(std::string_view bytes)
+    {
+        length_ += bytes.size();
+        const char *data = bytes.data();
+        size_t size = bytes.size();
+
+        // Complete a word left over from the previous chunk
+        if (tail_size_ > 0)
+        {
+            size_t take = std::min(size, sizeof(tail_) - tail_size_);
+            std::memcpy(tail_ + tail_size_, data, take);
+            tail_size_ += take;
+            data += take;
+            size -= take;
+            if (tail_size_ < sizeof(tail_))
+            {
+                return;
+            }
+
+            uint64_t word;
+            std::memcpy(&word, tail_, sizeof(word));
+            mixWord(word);
+            tail_size_ = 0;
+        }
+
+        for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            mixWord(word);
+        }
+
+        std::memcpy(tail_, data, size);
+        tail_size_ = size;
+    }
+
+    uint64_t ContentHasher::digest() const
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, tail_, tail_size_);
+        return mix64(rotl(state_ ^ (word * kPrime1), 31) * kPrime2 ^ length_);
+    }
+
+    ResultCache::ResultCache()
+        : dirty_(false)
+    {
+    }
+
+    void ResultCache::setStamp(Entry &entry, const FileStamp &stamp)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        int64_t now_ns = static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+
+        entry.stamp = stamp;
+        if (stamp.mtime_ns > now_ns - kRacyWindowNs)
+        {
+            entry.stamp.mtime_ns = -1; // Never matches; the contents are hashed instead
+        }
+    }
+
+    size_t ResultCache::load(const std::string &file_path, uint64_t fingerprint)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path_ = file_path;
+        entries_.clear();
+        dirty_ = false;
+
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file)
+        {
+            return 0;
+        }
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        Reader reader(data);
+        char magic[4];
+        uint32_t version;
+        uint64_t file_fingerprint;
+        if (!reader.get(magic) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !reader.get(version) ||
+            version != kVersion || !reader.get(file_fingerprint) || file_fingerprint != fingerprint)
+        {
+            return 0;
+        }
+
+        while (!reader.atEnd())
+        {
+            std::string path;
+            Entry entry;
+            uint64_t count;
+            if (!reader.getString(path) || !reader.get(entry.stamp.mtime_ns) || !reader.get(entry.stamp.size) ||
+                !reader.get(entry.content_hash) || !reader.get(count) || count > data.size())
+            {
+                std::cerr << "Ignoring damaged result cache: " << file_path << std::endl;
+                entries_.clear();
+                return 0;
+            }
+
+            entry.misspellings.resize(count);
+            for (auto &misspelling : entry.misspellings)
+            {
+                uint64_t line, column;
+                if (!reader.getString(misspelling.word) || !reader.get(line) || !reader.get(column) ||
+                    !reader.getString(misspelling.previous) || !reader.getString(misspelling.next))
+                {
+                    std::cerr << "Ignoring damaged result cache: " << file_path << std::endl;
+                    entries_.clear();
+                    return 0;
+                }
+                misspelling.line = static_cast<size_t>(line);
+                misspelling.column = static_cast<size_t>(column);
+            }
+            entries_[path] = std::move(entry);
+        }
+
+        return entries_.size();
+    }
+
+    bool ResultCache::save(uint64_t fingerprint)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (path_.empty() || !dirty_)
+        {
+            return true;
+        }
+
+        std::string out;
+        out.append(kMagic, sizeof(kMagic));
+        put<uint32_t>(out, kVersion);
+        put<uint64_t>(out, fingerprint);
+        for (auto it = entries_.begin(); it != entries_.end();)
+        {
+            // Entries of deleted or renamed files would never be used again
+            if (!FileSource::exists(it->first))
+            {
+                it = entries_.erase(it);
+                continue;
+            }
+
+            const Entry &entry = it->second;
+            putString(out, it->first);
+            put<int64_t>(out, entry.stamp.mtime_ns);
+            put<uint64_t>(out, entry.stamp.size);
+            put<uint64_t>(out, entry.content_hash);
+            put<uint64_t>(out, entry.misspellings.size());
+            for (const auto &misspelling : entry.misspellings)
+            {
+                putString(out, misspelling.word);
+                put<uint64_t>(out, misspelling.line);
+                put<uint64_t>(out, misspelling.column);
+                putString(out, misspelling.previous);
+                putString(out, misspelling.next);
+            }
+            ++it;
+        }
+
+        // Written beside the old file and renamed over it, so a crash never leaves half a file
+        std::string temp_path = path_ + ".tmp";
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), out.size());
+        file.close();
+        if (!file || std::rename(temp_path.c_str(), path_.c_str()) != 0)
+        {
+            std::cerr << "Cannot write result cache: " << path_ << std::endl;
+            std::remove(temp_path.c_str());
+            return false;
+        }
+
+        dirty_ = false;
+        return true;
+    }
+
+    bool ResultCache::lookup(const std::string &file_path, const FileStamp &stamp,
+                             std::vector<Misspelling> &misspellings) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(file_path);
+        if (it == entries_.end() || !(it->second.stamp == stamp))
+        {
+            return false;
+        }
+
+        misspellings = it->second.misspellings;
+        return true;
+    }
+
+    bool ResultCache::lookup(const std::string &file_path, const FileStamp &stamp, uint64_t content_hash,
+                             std::vector<Misspelling> &misspellings)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(file_path);
+        if (it == entries_.end() || it->second.content_hash != content_hash)
+        {
+            return false;
+        }
+
+        // Touched but unchanged; the new stamp spares hashing it next time
+        if (!(it->second.stamp == stamp))
+        {
+            setStamp(it->second, stamp);
+            dirty_ = true;
+        }
+        misspellings = it->second.misspellings;
+        return true;
+    }
+
+    void ResultCache::store(const std::string &file_path, const FileStamp &stamp, uint64_t content_hash,
+                            const std::vector<Misspelling> &misspellings)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry &entry = entries_[file_path];
+        setStamp(entry, stamp);
+        entry.content_hash = content_hash;
+        entry.misspellings = misspellings;
+        dirty_ = true;
+    }
+
+    void ResultCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!entries_.empty())
+        {
+            entries_.clear();
+            dirty_ = true;
+        }
+    }
+
+} // namespace spellcheck
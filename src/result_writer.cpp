@@ -0,0 +1,367 @@
+#include "result_writer.h"
+#include <algorithm>
+#include <iostream>
+#include <charconv>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        // Written out once this full; a record may take it a little past
+        constexpr size_t kBufferSize = 1024 * 1024;
+
+        constexpr std::string_view kRuleId = "spelling";
+
+        // Length of the valid UTF-8 sequence starting at index, or 0 if it is not valid
+        size_t utf8Length(std::string_view text, size_t index)
+        {
+            unsigned char lead = static_cast<unsigned char>(text[index]);
+            size_t length;
+            unsigned char low = 0x80; // Range of the second byte, ruling out overlong forms and surrogates
+            unsigned char high = 0xBF;
+            if (lead < 0x80)
+            {
+                return 1;
+            }
+            else if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                length = 2;
+            }
+            else if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                length = 3;
+                low = lead == 0xE0 ? 0xA0 : 0x80;
+                high = lead == 0xED ? 0x9F : 0xBF;
+            }
+            else if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                length = 4;
+                low = lead == 0xF0 ? 0x90 : 0x80;
+                high = lead == 0xF4 ? 0x8F : 0xBF;
+            }
+            else
+            {
+                return 0;
+            }
+
+            if (index + length > text.size())
+            {
+                return 0;
+            }
+            for (size_t i = 1; i < length; ++i)
+            {
+                unsigned char byte = static_cast<unsigned char>(text[index + i]);
+                if (byte < (i == 1 ? low : 0x80) || byte > (i == 1 ? high : 0xBF))
+                {
+                    return 0;
+                }
+            }
+            return length;
+        }
+
+        bool isUnreservedUriByte(unsigned char byte)
+        {
+            return (byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') || (byte >= '0' && byte <= '9') ||
+                   byte == '-' || byte == '.' || byte == '_' || byte == '~' || byte == '/';
+        }
+
+        /**
+         * @brief One JSON object per line:
+         * {"path":…,"line":…,"column":…,"word":…,"suggestions":[…]}
+         */
+        class JsonLinesWriter : public ResultWriter
+        {
+        public:
+            using ResultWriter::ResultWriter;
+
+            void write(const std::string &path, const Misspelling &misspelling,
+                       const std::vector<std::string> &suggestions) override
+            {
+                buffer_.append("{\"path\":");
+                appendJsonString(path);
+                buffer_.append(",\"line\":");
+                appendNumber(misspelling.line);
+                buffer_.append(",\"column\":");
+                appendNumber(misspelling.column);
+                buffer_.append(",\"word\":");
+                appendJsonString(misspelling.word);
+                buffer_.append(",\"suggestions\":[");
+                size_t shown = std::min(suggestions.size(), suggestions_per_word_);
+                for (size_t i = 0; i < shown; ++i)
+                {
+                    if (i > 0)
+                    {
+                        buffer_.push_back(',');
+                    }
+                    appendJsonString(suggestions[i]);
+                }
+                buffer_.append("]}\n");
+                commit();
+            }
+        };
+
+        /**
+         * @brief A SARIF 2.1.0 log with one run, whose results are written as they arrive
+         */
+        class SarifWriter : public ResultWriter
+        {
+        private:
+            bool first_ = true;
+
+        public:
+            using ResultWriter::ResultWriter;
+
+            void begin() override
+            {
+                buffer_.append("{\"version\":\"2.1.0\","
+                               "\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+                               "\"runs\":[{\"tool\":{\"driver\":{\"name\":\"spell_checker\",\"rules\":[{\"id\":\"");
+                buffer_.append(kRuleId);
+                buffer_.append("\",\"shortDescription\":{\"text\":\"Misspelled word\"},"
+                               "\"defaultConfiguration\":{\"level\":\"warning\"}}]}},"
+                               "\"columnKind\":\"unicodeCodePoints\",\"results\":[");
+                first_ = true;
+            }
+
+            void write(const std::string &path, const Misspelling &misspelling,
+                       const std::vector<std::string> &suggestions) override
+            {
+                size_t shown = std::min(suggestions.size(), suggestions_per_word_);
+
+                buffer_.append(first_ ? "\n" : ",\n");
+                first_ = false;
+                buffer_.append("{\"ruleId\":\"");
+                buffer_.append(kRuleId);
+                buffer_.append("\",\"level\":\"warning\",\"message\":{\"text\":\"Unknown word \\\"");
+                appendJsonText(misspelling.word);
+                buffer_.append("\\\"");
+                for (size_t i = 0; i < shown; ++i)
+                {
+                    buffer_.append(i == 0 ? "; did you mean " : ", ");
+                    appendJsonText(suggestions[i]);
+                }
+                buffer_.push_back('"');
+                buffer_.append("},\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":");
+                appendUri(path);
+                buffer_.append("},\"region\":{\"startLine\":");
+                appendNumber(misspelling.line);
+                buffer_.append(",\"startColumn\":");
+                appendNumber(misspelling.column);
+                buffer_.append("}}}],\"properties\":{\"word\":");
+                appendJsonString(misspelling.word);
+                buffer_.append(",\"suggestions\":[");
+                for (size_t i = 0; i < shown; ++i)
+                {
+                    if (i > 0)
+                    {
+                        buffer_.push_back(',');
+                    }
+                    appendJsonString(suggestions[i]);
+                }
+                buffer_.append("]}}");
+                commit();
+            }
+
+            void end() override
+            {
+                buffer_.append("\n]}]}\n");
+            }
+        };
+    } // namespace
+
+    bool parseOutputFormat(const std::string &name, OutputFormat &format)
+    {
+        if (name == "text")
+        {
+            format = OutputFormat::Text;
+        }
+        else if (name == "jsonl")
+        {
+            format = OutputFormat::JsonLines;
+        }
+        else if (name == "sarif")
+        {
+            format = OutputFormat::Sarif;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    ResultWriter::ResultWriter(int fd, size_t suggestions_per_word)
+        : fd_(fd), failed_(false), suggestions_per_word_(suggestions_per_word)
+    {
+        // Room for a full buffer plus the record that fills it, so appends rarely reallocate
+        buffer_.reserve(kBufferSize + 4096);
+    }
+
+    ResultWriter::~ResultWriter()
+    {
+        flush();
+    }
+
+    void ResultWriter::appendNumber(size_t value)
+    {
+        char digits[20];
+        auto converted = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer_.append(digits, converted.ptr - digits);
+    }
+
+    void ResultWriter::appendJsonString(std::string_view text)
+    {
+        buffer_.push_back('"');
+        appendJsonText(text);
+        buffer_.push_back('"');
+    }
+
+    void ResultWriter::appendJsonText(std::string_view text)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        size_t run = 0; // Start of the bytes not yet appended, which need no escaping
+        size_t i = 0;
+        while (i < text.size())
+        {
+            unsigned char byte = static_cast<unsigned char>(text[i]);
+            if (byte >= 0x20 && byte < 0x80 && byte != '"' && byte != '\\')
+            {
+                ++i;
+                continue;
+            }
+
+            size_t length = 0;
+            if (byte >= 0x80)
+            {
+                length = utf8Length(text, i);
+                if (length > 0)
+                {
+                    i += length;
+                    continue;
+                }
+            }
+
+            buffer_.append(text.data() + run, i - run);
+            switch (byte)
+            {
+            case '"':
+                buffer_.append("\\\"");
+                break;
+            case '\\':
+                buffer_.append("\\\\");
+                break;
+            case '\n':
+                buffer_.append("\\n");
+                break;
+            case '\r':
+                buffer_.append("\\r");
+                break;
+            case '\t':
+                buffer_.append("\\t");
+                break;
+            default:
+                if (byte >= 0x80)
+                {
+                    buffer_.append("\\ufffd");
+                }
+                else
+                {
+                    buffer_.append("\\u00");
+                    buffer_.push_back(hex[byte >> 4]);
+                    buffer_.push_back(hex[byte & 0xF]);
+                }
+                break;
+            }
+            ++i;
+            run = i;
+        }
+        buffer_.append(text.data() + run, text.size() - run);
+    }
+
+    void ResultWriter::appendUri(std::string_view path)
+    {
+        static const char hex[] = "0123456789ABCDEF";
+
+        buffer_.push_back('"');
+        if (!path.empty() && path.front() == '/')
+        {
+            buffer_.append("file://");
+        }
+        for (char c : path)
+        {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (isUnreservedUriByte(byte))
+            {
+                buffer_.push_back(c);
+            }
+            else
+            {
+                buffer_.push_back('%');
+                buffer_.push_back(hex[byte >> 4]);
+                buffer_.push_back(hex[byte & 0xF]);
+            }
+        }
+        buffer_.push_back('"');
+    }
+
+    void ResultWriter::commit()
+    {
+        if (buffer_.size() >= kBufferSize)
+        {
+            flush();
+        }
+    }
+
+    void ResultWriter::writeFile(const FileCheckResult &result)
+    {
+        static const std::vector<std::string> no_suggestions;
+        for (size_t i = 0; i < result.misspellings.size(); ++i)
+        {
+            write(result.path, result.misspellings[i],
+                  i < result.suggestions.size() ? result.suggestions[i] : no_suggestions);
+        }
+    }
+
+    bool ResultWriter::flush()
+    {
+        // After a failure the output is incomplete anyway, so the rest is dropped
+        size_t written = 0;
+        while (!failed_ && written < buffer_.size())
+        {
+            ssize_t count = ::write(fd_, buffer_.data() + written, buffer_.size() - written);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                std::cerr << "Could not write results: " << std::strerror(errno) << std::endl;
+                failed_ = true;
+                break;
+            }
+            written += static_cast<size_t>(count);
+        }
+        buffer_.clear();
+        return !failed_;
+    }
+
+    std::unique_ptr<ResultWriter> ResultWriter::create(OutputFormat format, int fd, size_t suggestions_per_word)
+    {
+        switch (format)
+        {
+        case OutputFormat::JsonLines:
+            return std::make_unique<JsonLinesWriter>(fd, suggestions_per_word);
+        case OutputFormat::Sarif:
+            return std::make_unique<SarifWriter>(fd, suggestions_per_word);
+        case OutputFormat::Text:
+            break;
+        }
+        return nullptr;
+    }
+
+} // namespace spellcheck
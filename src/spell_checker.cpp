@@ -1,18 +1,53 @@
 #include "spell_checker.h"
+#include "hash_util.h"
 #include "dictionary.h"
 #include "suggestion_engine.h"
 #include "text_processor.h"
+#include "stream_tokenizer.h"
+#include "file_source.h"
+#include "config.h"
+#include "bigram_model.h"
+#include "batch_reader.h"
+#include "thread_pool.h"
+#include "suggestion_cache.h"
+#include "suggestion_store.h"
+#include "result_cache.h"
+#include "unified_diff.h"
+#include <optional>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <ctime>
 
 namespace spellcheck
 {
 
+    namespace
+    {
+        // Words whose suggestions are cached unless configured otherwise
+        constexpr size_t kDefaultCacheSize = 1000;
+
+        uint64_t doubleBits(double value)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+    } // namespace
+
     SpellChecker::SpellChecker(const std::string &dict_path)
-        : case_sensitive_(false), ignore_numbers_(true), ignore_urls_(true), max_suggestions_(10)
+        : case_sensitive_(false), ignore_numbers_(true), ignore_urls_(true), max_suggestions_(10), backend_(DictionaryBackend::HashTable),
+          phonetic_algorithm_(PhoneticAlgorithm::Soundex), load_threads_(0), read_depth_(64), use_io_uring_(true),
+          threads_(0)
     {
+        thread_pool_ = std::make_unique<ThreadPool>(threads_);
+        suggestion_cache_ = std::make_unique<SuggestionCache>(kDefaultCacheSize);
 
         dictionary_ = std::make_unique<Dictionary>();
+        personal_dictionary_ = std::make_unique<Dictionary>();
         text_processor_ = std::make_unique<TextProcessor>();
         suggestion_engine_ = std::make_unique<SuggestionEngine>(dictionary_.get());
+        updateSuggestionLayers();
 
         // Configure text processor
         text_processor_->setCaseSensitive(case_sensitive_);
@@ -26,7 +61,11 @@ namespace spellcheck
         }
     }
 
-    SpellChecker::~SpellChecker() = default;
+    SpellChecker::~SpellChecker()
+    {
+        flushSuggestionStore();
+        saveResultCache();
+    }
 
     bool SpellChecker::loadDictionary(const std::string &dict_path)
     {
@@ -36,10 +75,28 @@ namespace spellcheck
             return false;
         }
 
+        dictionary_->setLoadThreads(load_threads_);
         bool success = dictionary_->loadFromFile(dict_path);
         if (success)
         {
-            suggestion_engine_->setDictionary(dictionary_.get());
+            // Report skipped lines without flooding the terminal
+            const auto &errors = dictionary_->getLoadErrors();
+            const size_t max_reported = 10;
+            for (size_t i = 0; i < errors.size() && i < max_reported; ++i)
+            {
+                std::cerr << dict_path << ":" << errors[i].line << ": " << errors[i].message << std::endl;
+            }
+            if (errors.size() > max_reported)
+            {
+                std::cerr << "... and " << (errors.size() - max_reported) << " more malformed line(s)" << std::endl;
+            }
+
+            if (backend_ == DictionaryBackend::PerfectHash && !dictionary_->freeze())
+            {
+                std::cerr << "Could not freeze dictionary, using hash tables" << std::endl;
+            }
+
+            updateSuggestionLayers();
             std::cout << "Loaded dictionary with " << dictionary_->size() << " words" << std::endl;
         }
         else
@@ -50,17 +107,381 @@ namespace spellcheck
         return success;
     }
 
+    bool SpellChecker::addDictionary(const std::string &dict_path)
+    {
+        if (!TextProcessor::fileExists(dict_path))
+        {
+            std::cerr << "Dictionary file not found: " << dict_path << std::endl;
+            return false;
+        }
+
+        auto layer = std::make_unique<Dictionary>();
+        layer->setLoadThreads(load_threads_);
+        layer->setPhoneticAlgorithm(phonetic_algorithm_);
+        if (!layer->loadFromFile(dict_path))
+        {
+            std::cerr << "Failed to load dictionary from: " << dict_path << std::endl;
+            return false;
+        }
+
+        if (backend_ == DictionaryBackend::PerfectHash && !layer->freeze())
+        {
+            std::cerr << "Could not freeze dictionary, using hash tables" << std::endl;
+        }
+
+        std::cout << "Loaded domain dictionary with " << layer->size() << " words" << std::endl;
+        domain_dictionaries_.push_back(std::move(layer));
+        updateSuggestionLayers();
+
+        return true;
+    }
+
+    bool SpellChecker::loadPersonalDictionary(const std::string &dict_path)
+    {
+        // A missing personal list is not an error; it is created on save
+        if (!TextProcessor::fileExists(dict_path))
+        {
+            return false;
+        }
+
+        // Loading replaces the layer, so words already added to it (such
+        // as the configuration's custom_words) are added back
+        std::vector<std::string> added = personal_dictionary_->getAllWords();
+        bool success = personal_dictionary_->loadFromFile(dict_path);
+        for (const auto &word : added)
+        {
+            personal_dictionary_->addWord(word);
+        }
+        invalidateSuggestions();
+        invalidateResults();
+        return success;
+    }
+
+    bool SpellChecker::savePersonalDictionary(const std::string &dict_path) const
+    {
+        return personal_dictionary_->saveToFile(dict_path);
+    }
+
     void SpellChecker::addWord(const std::string &word)
     {
         if (!word.empty())
         {
-            dictionary_->addWord(word);
+            // Only the small personal layer changes; nothing is rebuilt
+            personal_dictionary_->addWord(word);
+            invalidateSuggestions();
+            invalidateResults();
         }
     }
 
     void SpellChecker::removeWord(const std::string &word)
     {
         dictionary_->removeWord(word);
+        for (auto &layer : domain_dictionaries_)
+        {
+            layer->removeWord(word);
+        }
+        personal_dictionary_->removeWord(word);
+        invalidateSuggestions();
+        invalidateResults();
+    }
+
+    bool SpellChecker::containsWord(const std::string &word) const
+    {
+        if (personal_dictionary_->containsWord(word) || dictionary_->containsWord(word))
+        {
+            return true;
+        }
+
+        for (const auto &layer : domain_dictionaries_)
+        {
+            if (layer->containsWord(word))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void SpellChecker::updateSuggestionLayers()
+    {
+        std::vector<const Dictionary *> layers{dictionary_.get()};
+        for (const auto &layer : domain_dictionaries_)
+        {
+            layers.push_back(layer.get());
+        }
+        layers.push_back(personal_dictionary_.get());
+
+        suggestion_engine_->setDictionaryLayers(layers);
+        invalidateSuggestions();
+        invalidateResults();
+    }
+
+    void SpellChecker::invalidateSuggestions()
+    {
+        if (suggestion_cache_)
+        {
+            suggestion_cache_->invalidate();
+        }
+        if (suggestion_store_)
+        {
+            suggestion_store_->invalidate();
+        }
+    }
+
+    uint64_t SpellChecker::dictionaryHash() const
+    {
+        uint64_t hash = combineHash(0, dictionary_->contentHash());
+        for (const auto &layer : domain_dictionaries_)
+        {
+            hash = combineHash(hash, layer->contentHash());
+        }
+        return combineHash(hash, personal_dictionary_->contentHash());
+    }
+
+    uint64_t SpellChecker::settingsHash() const
+    {
+        // The time budget is left out: results it cut short are never stored
+        uint64_t hash = combineHash(0, max_suggestions_);
+        hash = combineHash(hash, static_cast<uint64_t>(phonetic_algorithm_));
+        hash = combineHash(hash, case_sensitive_);
+        hash = combineHash(hash, suggestion_engine_->getMaxEditDistance());
+        hash = combineHash(hash, suggestion_engine_->getMaxSuggestions());
+        hash = combineHash(hash, doubleBits(suggestion_engine_->getEditDistanceWeight()));
+        hash = combineHash(hash, doubleBits(suggestion_engine_->getFrequencyWeight()));
+        hash = combineHash(hash, doubleBits(suggestion_engine_->getPhoneticWeight()));
+        hash = combineHash(hash, doubleBits(suggestion_engine_->getPrefixWeight()));
+        hash = combineHash(hash, static_cast<uint64_t>(suggestion_engine_->getKeyboardLayout()));
+        return combineHash(hash, suggestion_engine_->getMaxSplitWords());
+    }
+
+    void SpellChecker::invalidateResults()
+    {
+        if (result_cache_)
+        {
+            result_cache_->clear();
+        }
+    }
+
+    uint64_t SpellChecker::checkFingerprint() const
+    {
+        uint64_t hash = combineHash(dictionaryHash(), case_sensitive_);
+        hash = combineHash(hash, ignore_numbers_);
+        hash = combineHash(hash, ignore_urls_);
+        hash = combineHash(hash, text_processor_->ignoreEmails());
+        hash = combineHash(hash, text_processor_->getMinWordLength());
+        hash = combineHash(hash, text_processor_->getMaxWordLength());
+        return combineHash(hash, text_processor_->splitIdentifiers());
+    }
+
+    SuggestionEngine &SpellChecker::getSuggestionEngine()
+    {
+        invalidateSuggestions();
+        return *suggestion_engine_;
+    }
+
+    void SpellChecker::applyConfig(const Config &config)
+    {
+        // [Performance] settings affect how dictionaries are loaded, so apply them first
+        setLoadThreads(config.getSize("Performance", "loader_threads", load_threads_));
+        setReadDepth(config.getSize("Performance", "read_depth", read_depth_));
+        setUseIoUring(config.getBool("Performance", "use_io_uring", use_io_uring_));
+        setThreads(config.getSize("Performance", "threads", threads_));
+        setSuggestionCache(config.getBool("Performance", "enable_suggestion_cache", suggestion_cache_ != nullptr),
+                           config.getSize("Performance", "max_cache_size", kDefaultCacheSize));
+
+        std::string backend = config.getString("Performance", "dictionary_backend", "hash");
+        if (backend == "perfect_hash")
+        {
+            setDictionaryBackend(DictionaryBackend::PerfectHash);
+        }
+        else if (backend == "hash")
+        {
+            setDictionaryBackend(DictionaryBackend::HashTable);
+        }
+        else
+        {
+            std::cerr << "Unknown dictionary_backend: " << backend << std::endl;
+        }
+
+        // [Suggestions] phonetic_algorithm decides how dictionaries are indexed
+        std::string phonetic = config.getString("Suggestions", "phonetic_algorithm", "soundex");
+        if (phonetic == "double_metaphone")
+        {
+            setPhoneticAlgorithm(PhoneticAlgorithm::DoubleMetaphone);
+        }
+        else if (phonetic == "soundex")
+        {
+            setPhoneticAlgorithm(PhoneticAlgorithm::Soundex);
+        }
+        else
+        {
+            std::cerr << "Unknown phonetic_algorithm: " << phonetic << std::endl;
+        }
+
+        // [Checking]
+        setCaseSensitive(config.getBool("Checking", "case_sensitive", case_sensitive_));
+        setIgnoreNumbers(config.getBool("Checking", "ignore_numbers", ignore_numbers_));
+        setIgnoreUrls(config.getBool("Checking", "ignore_urls", ignore_urls_));
+        setIgnoreEmails(config.getBool("Checking", "ignore_emails", text_processor_->ignoreEmails()));
+        setMinWordLength(config.getSize("Checking", "min_word_length", text_processor_->getMinWordLength()));
+        setMaxWordLength(config.getSize("Checking", "max_word_length", text_processor_->getMaxWordLength()));
+        setSplitIdentifiers(config.getBool("Checking", "split_identifiers", text_processor_->splitIdentifiers()));
+
+        // [Suggestions]
+        setMaxSuggestions(config.getSize("Suggestions", "max_suggestions", max_suggestions_));
+        SuggestionEngine &engine = *suggestion_engine_;
+        engine.setMaxEditDistance(config.getSize("Suggestions", "max_edit_distance", engine.getMaxEditDistance()));
+        engine.setEditDistanceWeight(config.getDouble("Suggestions", "edit_distance_weight", engine.getEditDistanceWeight()));
+        engine.setFrequencyWeight(config.getDouble("Suggestions", "frequency_weight", engine.getFrequencyWeight()));
+        engine.setPhoneticWeight(config.getDouble("Suggestions", "phonetic_weight", engine.getPhoneticWeight()));
+        engine.setPrefixWeight(config.getDouble("Suggestions", "prefix_weight", engine.getPrefixWeight()));
+        engine.setMaxSplitWords(config.getSize("Suggestions", "max_split_words", engine.getMaxSplitWords()));
+
+        std::string layout = config.getString("Suggestions", "keyboard_layout", "qwerty");
+        if (layout == "qwerty")
+        {
+            engine.setKeyboardLayout(KeyboardLayout::Qwerty);
+        }
+        else if (layout == "dvorak")
+        {
+            engine.setKeyboardLayout(KeyboardLayout::Dvorak);
+        }
+        else
+        {
+            std::cerr << "Unknown keyboard_layout: " << layout << std::endl;
+        }
+
+        SuggestionBudget budget = engine.getBudget();
+        budget.time_limit = std::chrono::microseconds(
+            config.getSize("Suggestions", "time_budget_us", static_cast<size_t>(budget.time_limit.count())));
+        budget.max_probes = config.getSize("Suggestions", "probe_budget", budget.max_probes);
+        engine.setBudget(budget);
+
+        engine.setContextShortlist(config.getSize("Suggestions", "context_shortlist", engine.getContextShortlist()));
+        std::string context_model = config.getString("Suggestions", "context_model");
+        if (!context_model.empty())
+        {
+            loadContextModel(context_model);
+        }
+
+        // [Dictionary]
+        for (const auto &dict_path : config.getList("Dictionary", "additional_dictionaries"))
+        {
+            addDictionary(dict_path);
+        }
+        for (const auto &word : config.getList("Dictionary", "custom_words"))
+        {
+            addWord(word);
+        }
+    }
+
+    void SpellChecker::setCaseSensitive(bool sensitive)
+    {
+        case_sensitive_ = sensitive;
+        text_processor_->setCaseSensitive(sensitive);
+        invalidateResults();
+    }
+
+    void SpellChecker::setIgnoreNumbers(bool ignore)
+    {
+        ignore_numbers_ = ignore;
+        text_processor_->setIgnoreNumbers(ignore);
+        invalidateResults();
+    }
+
+    void SpellChecker::setIgnoreUrls(bool ignore)
+    {
+        ignore_urls_ = ignore;
+        text_processor_->setIgnoreUrls(ignore);
+        invalidateResults();
+    }
+
+    void SpellChecker::setIgnoreEmails(bool ignore)
+    {
+        text_processor_->setIgnoreEmails(ignore);
+        invalidateResults();
+    }
+
+    void SpellChecker::setMinWordLength(size_t length)
+    {
+        text_processor_->setMinWordLength(length);
+        invalidateResults();
+    }
+
+    void SpellChecker::setMaxWordLength(size_t length)
+    {
+        text_processor_->setMaxWordLength(length);
+        invalidateResults();
+    }
+
+    void SpellChecker::setSplitIdentifiers(bool split)
+    {
+        text_processor_->setSplitIdentifiers(split);
+        invalidateResults();
+    }
+
+    void SpellChecker::setPhoneticAlgorithm(PhoneticAlgorithm algorithm)
+    {
+        phonetic_algorithm_ = algorithm;
+        dictionary_->setPhoneticAlgorithm(algorithm);
+        for (auto &layer : domain_dictionaries_)
+        {
+            layer->setPhoneticAlgorithm(algorithm);
+        }
+        personal_dictionary_->setPhoneticAlgorithm(algorithm);
+        invalidateSuggestions();
+    }
+
+    void SpellChecker::setThreads(size_t threads)
+    {
+        // Threads start on first use, so replacing an idle pool is cheap
+        threads_ = threads;
+        thread_pool_ = std::make_unique<ThreadPool>(threads);
+    }
+
+    void SpellChecker::setSuggestionCache(bool enable, size_t capacity)
+    {
+        suggestion_cache_ = enable && capacity > 0 ? std::make_unique<SuggestionCache>(capacity) : nullptr;
+    }
+
+    size_t SpellChecker::openSuggestionStore(const std::string &file_path)
+    {
+        flushSuggestionStore();
+        suggestion_store_ = std::make_unique<SuggestionStore>();
+        return suggestion_store_->open(file_path, dictionaryHash(), settingsHash());
+    }
+
+    bool SpellChecker::flushSuggestionStore()
+    {
+        if (!suggestion_store_)
+        {
+            return true;
+        }
+        return suggestion_store_->flush(dictionaryHash(), settingsHash());
+    }
+
+    size_t SpellChecker::openResultCache(const std::string &file_path)
+    {
+        saveResultCache();
+        result_cache_ = std::make_unique<ResultCache>();
+        return result_cache_->load(file_path, checkFingerprint());
+    }
+
+    bool SpellChecker::saveResultCache()
+    {
+        if (!result_cache_)
+        {
+            return true;
+        }
+        return result_cache_->save(checkFingerprint());
+    }
+
+    void SpellChecker::setMaxSuggestions(size_t max_suggestions)
+    {
+        max_suggestions_ = max_suggestions;
+        suggestion_engine_->setMaxSuggestions(max_suggestions);
+        invalidateSuggestions();
     }
 
     bool SpellChecker::isCorrect(const std::string &word) const
@@ -80,13 +501,13 @@ namespace spellcheck
         std::string normalized_word = text_processor_->normalizeWord(word);
 
         // Check in dictionary
-        bool found = dictionary_->containsWord(normalized_word);
+        bool found = containsWord(normalized_word);
 
         // If case insensitive and not found, try lowercase
         if (!found && !case_sensitive_)
         {
             std::string lowercase_word = text_processor_->toLowerCase(normalized_word);
-            found = dictionary_->containsWord(lowercase_word);
+            found = containsWord(lowercase_word);
         }
 
         return found;
@@ -99,19 +520,155 @@ namespace spellcheck
             return {};
         }
 
+        return getSuggestionResult(word).suggestions;
+    }
+
+    SuggestionResult SpellChecker::getSuggestionResult(const std::string &word) const
+    {
+        if (word.empty())
+        {
+            return {};
+        }
+
         // Normalize the word
         std::string normalized_word = text_processor_->normalizeWord(word);
 
+        SuggestionResult result;
+        if (suggestion_cache_ && suggestion_cache_->lookup(normalized_word, result.suggestions))
+        {
+            return result;
+        }
+        uint64_t generation = suggestion_cache_ ? suggestion_cache_->generation() : 0;
+
+        // Suggestions stored by an earlier run
+        if (suggestion_store_ && suggestion_store_->lookup(normalized_word, result.suggestions))
+        {
+            if (suggestion_cache_)
+            {
+                suggestion_cache_->insert(normalized_word, result.suggestions, generation);
+            }
+            return result;
+        }
+
         // Generate suggestions
-        std::vector<std::string> suggestions = suggestion_engine_->generateSuggestions(normalized_word);
+        result = suggestion_engine_->generateSuggestions(normalized_word, suggestion_engine_->getBudget());
 
         // Limit number of suggestions
-        if (suggestions.size() > max_suggestions_)
+        if (result.suggestions.size() > max_suggestions_)
         {
-            suggestions.resize(max_suggestions_);
+            result.suggestions.resize(max_suggestions_);
+        }
+
+        // A search cut short by the time budget may find more next time
+        if (!result.truncated)
+        {
+            if (suggestion_cache_)
+            {
+                suggestion_cache_->insert(normalized_word, result.suggestions, generation);
+            }
+            if (suggestion_store_)
+            {
+                suggestion_store_->record(normalized_word, result.suggestions);
+            }
         }
 
-        return suggestions;
+        return result;
+    }
+
+    SuggestionResult SpellChecker::getSuggestionResult(const std::string &word, const std::string &previous,
+                                                       const std::string &next) const
+    {
+        SuggestionResult result = getSuggestionResult(word);
+        if (context_model_)
+        {
+            result.suggestions = suggestion_engine_->rerankInContext(text_processor_->normalizeWord(word),
+                                                                     std::move(result.suggestions),
+                                                                     previous, next);
+        }
+
+        return result;
+    }
+
+    namespace
+    {
+        std::chrono::nanoseconds threadCpuTime()
+        {
+            timespec now;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+            return std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec);
+        }
+    } // namespace
+
+    const std::vector<std::string> &SuggestionBatch::find(const Misspelling &misspelling) const
+    {
+        static const std::vector<std::string> none;
+        auto found = suggestions.find(key(misspelling, in_context));
+        return found != suggestions.end() ? found->second : none;
+    }
+
+    std::string SuggestionBatch::key(const Misspelling &misspelling, bool in_context)
+    {
+        if (!in_context)
+        {
+            return misspelling.word;
+        }
+        // Words never contain line breaks
+        return misspelling.word + '\n' + misspelling.previous + '\n' + misspelling.next;
+    }
+
+    SuggestionBatch SpellChecker::suggestAll(const std::vector<Misspelling> &misspellings) const
+    {
+        auto wall_start = std::chrono::steady_clock::now();
+
+        SuggestionBatch batch;
+        batch.in_context = context_model_ != nullptr;
+        batch.occurrences = misspellings.size();
+        batch.threads = thread_pool_->size();
+
+        // Entries are created up front; tasks then fill distinct values in place
+        std::vector<std::pair<const Misspelling *, std::vector<std::string> *>> unique;
+        for (const auto &misspelling : misspellings)
+        {
+            auto inserted = batch.suggestions.emplace(SuggestionBatch::key(misspelling, batch.in_context),
+                                                      std::vector<std::string>());
+            if (inserted.second)
+            {
+                unique.emplace_back(&misspelling, &inserted.first->second);
+            }
+        }
+
+        std::atomic<int64_t> cpu_nanoseconds(0);
+        TaskGroup tasks(*thread_pool_);
+        for (const auto &entry : unique)
+        {
+            tasks.run([this, &entry, &cpu_nanoseconds]
+                      {
+                          auto cpu_start = threadCpuTime();
+                          const Misspelling &misspelling = *entry.first;
+                          *entry.second = getSuggestionResult(misspelling.word, misspelling.previous, misspelling.next)
+                                              .suggestions;
+                          cpu_nanoseconds.fetch_add((threadCpuTime() - cpu_start).count());
+                      });
+        }
+        tasks.wait();
+
+        batch.wall_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - wall_start);
+        batch.cpu_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(cpu_nanoseconds.load()));
+        return batch;
+    }
+
+    bool SpellChecker::loadContextModel(const std::string &model_path)
+    {
+        auto model = std::make_unique<BigramModel>();
+        if (!model->loadFromFile(model_path))
+        {
+            std::cerr << "Failed to load context model from: " << model_path << std::endl;
+            return false;
+        }
+
+        context_model_ = std::move(model);
+        suggestion_engine_->setContextModel(context_model_.get());
+        return true;
     }
 
     std::vector<std::pair<std::string, size_t>> SpellChecker::checkText(const std::string &text) const
@@ -136,45 +693,549 @@ namespace spellcheck
         return misspelled_words;
     }
 
-    std::vector<std::tuple<std::string, size_t, size_t>> SpellChecker::checkFile(const std::string &file_path) const
+    namespace
+    {
+        // Bytes read from a stream, or taken from a mapped file, per tokenizer call
+        constexpr size_t kStreamBlockSize = 64 * 1024;
+
+        // Distinct words whose verdicts are remembered within one document
+        constexpr size_t kMaxRememberedVerdicts = 1 << 16;
+
+        // Files up to this size are read whole when checking many files
+        constexpr size_t kMaxBatchedFileSize = 4 * 1024 * 1024;
+
+        // Unfinished tasks allowed per pool thread before checkFiles stops reading ahead
+        constexpr size_t kPendingTasksPerThread = 4;
+
+        /**
+         * @brief Turns a document's chunks into misspellings as they arrive
+         *
+         * A misspelling is held back until the word after it is known, so
+         * its context is complete when it is reported. Each distinct word
+         * is looked up once; documents, source files especially, repeat
+         * the same words many times.
+         */
+        class MisspellingStream
+        {
+        private:
+            const SpellChecker &checker_;
+            const MisspellingVisitor &visit_;
+            std::unique_ptr<StreamTokenizer> tokenizer_;
+            std::vector<WordToken> tokens_;
+            std::unordered_map<std::string, bool> verdicts_;
+            std::string previous_;
+            std::optional<Misspelling> held_;
+
+            bool isCorrect(const std::string &word)
+            {
+                auto verdict = verdicts_.find(word);
+                if (verdict != verdicts_.end())
+                {
+                    return verdict->second;
+                }
+
+                if (verdicts_.size() >= kMaxRememberedVerdicts)
+                {
+                    verdicts_.clear();
+                }
+                bool correct = checker_.isCorrect(word);
+                verdicts_.emplace(word, correct);
+                return correct;
+            }
+
+            bool drain()
+            {
+                for (auto &token : tokens_)
+                {
+                    std::string &word = std::get<0>(token);
+                    if (held_)
+                    {
+                        held_->next = word;
+                        if (!visit_(*held_))
+                        {
+                            return false;
+                        }
+                        held_.reset();
+                    }
+
+                    if (!isCorrect(word))
+                    {
+                        held_ = Misspelling{word, std::get<1>(token), std::get<2>(token), previous_, ""};
+                    }
+                    previous_ = std::move(word);
+                }
+                tokens_.clear();
+                return true;
+            }
+
+        public:
+            MisspellingStream(const SpellChecker &checker, const TextProcessor &processor, DocumentFormat format,
+                              const MisspellingVisitor &visit)
+                : checker_(checker), visit_(visit), tokenizer_(StreamTokenizer::create(format, processor))
+            {
+            }
+
+            bool feed(std::string_view chunk)
+            {
+                // Large chunks are tokenized in blocks so the token buffer stays small
+                for (size_t offset = 0; offset < chunk.size(); offset += kStreamBlockSize)
+                {
+                    tokenizer_->feed(chunk.substr(offset, kStreamBlockSize), tokens_);
+                    if (!drain())
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            bool finish()
+            {
+                tokenizer_->finish(tokens_);
+                if (!drain())
+                {
+                    return false;
+                }
+                if (held_ && !visit_(*held_))
+                {
+                    return false;
+                }
+                held_.reset();
+                return true;
+            }
+        };
+    } // namespace
+
+    std::vector<Misspelling> SpellChecker::checkFile(const std::string &file_path) const
     {
-        std::vector<std::tuple<std::string, size_t, size_t>> misspelled_words;
+        std::vector<Misspelling> misspelled_words;
+        checkFile(file_path, [&misspelled_words](const Misspelling &misspelling)
+                  {
+                      misspelled_words.push_back(misspelling);
+                      return true;
+                  });
+        return misspelled_words;
+    }
 
-        // Read file contents
-        std::string file_contents = TextProcessor::readFile(file_path);
-        if (file_contents.empty())
+    bool SpellChecker::checkFile(const std::string &file_path, const MisspellingVisitor &visit) const
+    {
+        FileSource source;
+        if (!source.open(file_path))
         {
             std::cerr << "Could not read file: " << file_path << std::endl;
-            return misspelled_words;
+            return false;
         }
 
-        // Extract words with line numbers
-        auto words_with_lines = text_processor_->extractWordsWithLines(file_contents);
+        // Chunks are views of the mapped file, tokenized without copying
+        MisspellingStream stream(*this, *text_processor_, documentFormatForPath(file_path), visit);
+        std::string_view chunk;
+        while (source.next(chunk))
+        {
+            if (!stream.feed(chunk))
+            {
+                return false;
+            }
+        }
 
-        // Check each word
-        for (const auto &word_info : words_with_lines)
+        return !source.failed() && stream.finish();
+    }
+
+    bool SpellChecker::checkStream(std::istream &input, DocumentFormat format, const MisspellingVisitor &visit) const
+    {
+        MisspellingStream stream(*this, *text_processor_, format, visit);
+        std::vector<char> block(kStreamBlockSize);
+
+        while (input)
+        {
+            input.read(block.data(), static_cast<std::streamsize>(block.size()));
+            std::streamsize count = input.gcount();
+            if (count > 0 && !stream.feed(std::string_view(block.data(), static_cast<size_t>(count))))
+            {
+                return false;
+            }
+        }
+
+        if (input.bad())
         {
-            const std::string &word = std::get<0>(word_info);
-            size_t line = std::get<1>(word_info);
-            size_t column = std::get<2>(word_info);
+            return false;
+        }
+        return stream.finish();
+    }
 
-            if (!isCorrect(word))
+    bool SpellChecker::checkFragment(std::string_view text, DocumentFormat format, size_t first_line,
+                                     const MisspellingVisitor &visit) const
+    {
+        // The tokenizer counts lines from the start of the fragment
+        MisspellingVisitor shift = [&visit, first_line](const Misspelling &misspelling)
+        {
+            Misspelling shifted = misspelling;
+            shifted.line += first_line - 1;
+            return visit(shifted);
+        };
+        MisspellingStream stream(*this, *text_processor_, format, shift);
+        return stream.feed(text) && stream.finish();
+    }
+
+    std::vector<FileCheckResult> SpellChecker::checkFiles(const std::vector<std::string> &file_paths,
+                                                          bool with_suggestions) const
+    {
+        std::vector<FileCheckResult> results;
+        results.reserve(file_paths.size());
+        checkFiles(file_paths, with_suggestions, [&results](FileCheckResult &result)
+                   { results.push_back(std::move(result)); });
+        return results;
+    }
+
+    void SpellChecker::checkFiles(const std::vector<std::string> &file_paths, bool with_suggestions,
+                                  const FileResultVisitor &visit) const
+    {
+        std::vector<FileCheckResult> results(file_paths.size());
+
+        // Finished results are handed over in order, then released
+        std::mutex visit_mutex;
+        std::vector<char> finished(file_paths.size(), 0);
+        size_t next_visit = 0;
+        auto finish = [&results, &visit_mutex, &finished, &next_visit, &visit](size_t index)
+        {
+            std::lock_guard<std::mutex> lock(visit_mutex);
+            finished[index] = 1;
+            while (next_visit < results.size() && finished[next_visit])
             {
-                misspelled_words.emplace_back(word, line, column);
+                visit(results[next_visit]);
+                results[next_visit] = FileCheckResult();
+                ++next_visit;
             }
+        };
+
+        auto suggest = [this](FileCheckResult &result)
+        {
+            // Runs as its own tasks; waiting here lets this thread help with them
+            SuggestionBatch batch = suggestAll(result.misspellings);
+            result.suggestions.reserve(result.misspellings.size());
+            for (const auto &misspelling : result.misspellings)
+            {
+                result.suggestions.push_back(batch.find(misspelling));
+            }
+        };
+
+        // Files unchanged since they were last checked are replayed without reading them
+        std::vector<FileStamp> stamps(file_paths.size());
+        std::vector<char> stamped(file_paths.size(), 0);
+        std::vector<std::string> read_paths;
+        std::vector<size_t> read_indices;
+
+        // Declared after everything its tasks use, so if a task throws the
+        // group's destructor still waits while those are alive
+        TaskGroup tasks(*thread_pool_);
+        for (size_t i = 0; i < file_paths.size(); ++i)
+        {
+            FileCheckResult &result = results[i];
+            result.path = file_paths[i];
+            if (result_cache_ && FileStamp::read(file_paths[i], stamps[i]))
+            {
+                stamped[i] = 1;
+                if (result_cache_->lookup(file_paths[i], stamps[i], result.misspellings))
+                {
+                    result.checked = true;
+                    result.cached = true;
+                    if (with_suggestions)
+                    {
+                        tasks.run([&suggest, &finish, &result, i]
+                                  {
+                                      suggest(result);
+                                      finish(i);
+                                  });
+                    }
+                    else
+                    {
+                        finish(i);
+                    }
+                    continue;
+                }
+            }
+            read_paths.push_back(file_paths[i]);
+            read_indices.push_back(i);
         }
+        BatchReader reader(read_paths, read_depth_, kMaxBatchedFileSize, use_io_uring_);
 
-        return misspelled_words;
+        // Each task fills only its own file's result
+        auto check = [this, &results, &stamps, &stamped, &read_indices, &suggest, with_suggestions](const FileBuffer &buffer)
+        {
+            size_t index = read_indices[buffer.index];
+            FileCheckResult &result = results[index];
+            MisspellingVisitor collect = [&result](const Misspelling &misspelling)
+            {
+                result.misspellings.push_back(misspelling);
+                return true;
+            };
+
+            if (buffer.error != 0)
+            {
+                std::cerr << ("Could not read file: " + buffer.path + " (" + std::strerror(buffer.error) + ")\n");
+                return;
+            }
+
+            // Touched but unchanged files are not tokenized again
+            bool use_cache = result_cache_ && stamped[index];
+            uint64_t content_hash = 0;
+            if (use_cache)
+            {
+                ContentHasher hasher;
+                if (buffer.deferred)
+                {
+                    FileSource source;
+                    std::string_view chunk;
+                    use_cache = source.open(buffer.path);
+                    while (use_cache && source.next(chunk))
+                    {
+                        hasher.update(chunk);
+                    }
+                    use_cache = use_cache && !source.failed();
+                }
+                else
+                {
+                    hasher.update(std::string_view(buffer.data.data(), buffer.data.size()));
+                }
+                content_hash = hasher.digest();
+            }
+
+            if (use_cache && result_cache_->lookup(buffer.path, stamps[index], content_hash, result.misspellings))
+            {
+                result.checked = true;
+                result.cached = true;
+            }
+            else
+            {
+                if (buffer.deferred)
+                {
+                    result.checked = checkFile(buffer.path, collect);
+                }
+                else
+                {
+                    MisspellingStream stream(*this, *text_processor_, documentFormatForPath(buffer.path), collect);
+                    result.checked = stream.feed(std::string_view(buffer.data.data(), buffer.data.size())) &&
+                                     stream.finish();
+                }
+
+                if (use_cache && result.checked)
+                {
+                    result_cache_->store(buffer.path, stamps[index], content_hash, result.misspellings);
+                }
+            }
+
+            if (with_suggestions)
+            {
+                suggest(result);
+            }
+        };
+
+        // This thread feeds files to the pool; unfinished work is bounded
+        // so file contents do not pile up faster than they are checked
+        const size_t max_pending = kPendingTasksPerThread * thread_pool_->size();
+        FileBuffer buffer;
+        while (reader.next(buffer))
+        {
+            tasks.wait(max_pending);
+            auto file = std::make_shared<FileBuffer>(std::move(buffer));
+            tasks.run([check, &finish, &read_indices, file]
+                      {
+                          check(*file);
+                          finish(read_indices[file->index]);
+                      });
+        }
+        tasks.wait();
+    }
+
+    namespace
+    {
+        // Line after the last line of a range
+        size_t rangeEnd(const DiffRange &range)
+        {
+            return range.first_line + static_cast<size_t>(std::count(range.text.begin(), range.text.end(), '\n'));
+        }
+
+        // Whether every added line is in contents at its line number, so the
+        // file on disk is the version the diff produced
+        bool hasAddedLines(std::string_view contents, const std::vector<DiffRange> &ranges)
+        {
+            size_t line = 1;
+            size_t offset = 0;
+            for (const auto &range : ranges)
+            {
+                while (line < range.first_line)
+                {
+                    size_t newline = contents.find('\n', offset);
+                    if (newline == std::string_view::npos)
+                    {
+                        return false;
+                    }
+                    offset = newline + 1;
+                    ++line;
+                }
+
+                std::string_view text(range.text);
+                if (offset > contents.size() || contents.compare(offset, text.size(), text) != 0)
+                {
+                    // The file's last line may have no newline
+                    if (offset + text.size() != contents.size() + 1 ||
+                        contents.substr(offset) != text.substr(0, text.size() - 1))
+                    {
+                        return false;
+                    }
+                }
+                offset += text.size();
+                line = rangeEnd(range);
+            }
+            return true;
+        }
+    } // namespace
+
+    std::vector<FileCheckResult> SpellChecker::checkDiff(const std::vector<DiffFile> &files) const
+    {
+        std::vector<FileCheckResult> results(files.size());
+        TaskGroup tasks(*thread_pool_);
+
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            tasks.run([this, &files, &results, i]
+                      {
+                          const DiffFile &file = files[i];
+                          FileCheckResult &result = results[i];
+                          result.path = file.path;
+                          DocumentFormat format = documentFormatForPath(file.path);
+
+                          MisspellingVisitor collect = [&result](const Misspelling &misspelling)
+                          {
+                              result.misspellings.push_back(misspelling);
+                              return true;
+                          };
+
+                          // A fence, comment or string holding the added lines may open
+                          // well before the hunk, so other formats are tokenized from the
+                          // top of the new file and only the added lines are reported
+                          if (format != DocumentFormat::PlainText)
+                          {
+                              FileSource source;
+                              std::string_view contents;
+                              if (source.open(file.path) && source.readAll(contents) &&
+                                  hasAddedLines(contents, file.ranges))
+                              {
+                                  size_t range = 0;
+                                  MisspellingVisitor added = [&file, &collect, &range](const Misspelling &misspelling)
+                                  {
+                                      while (range < file.ranges.size() && misspelling.line >= rangeEnd(file.ranges[range]))
+                                      {
+                                          ++range;
+                                      }
+                                      if (range < file.ranges.size() && misspelling.line >= file.ranges[range].first_line)
+                                      {
+                                          collect(misspelling);
+                                      }
+                                      return true;
+                                  };
+                                  result.checked = checkFragment(contents, format, 1, added);
+                                  return;
+                              }
+                          }
+
+                          // Plain text has no state across lines, and without the new
+                          // file the ranges are all there is
+                          for (const auto &range : file.ranges)
+                          {
+                              checkFragment(range.text, format, range.first_line, collect);
+                          }
+                          result.checked = true;
+                      });
+        }
+        tasks.wait();
+
+        return results;
     }
 
     std::pair<size_t, size_t> SpellChecker::getDictionaryStats() const
     {
-        return dictionary_->getStats();
+        auto stats = dictionary_->getStats();
+        for (const auto &layer : domain_dictionaries_)
+        {
+            auto layer_stats = layer->getStats();
+            stats.first += layer_stats.first;
+            stats.second += layer_stats.second;
+        }
+
+        auto personal_stats = personal_dictionary_->getStats();
+        stats.first += personal_stats.first;
+        stats.second += personal_stats.second;
+
+        return stats;
+    }
+
+    MemoryStats SpellChecker::getMemoryStats() const
+    {
+        MemoryStats stats = dictionary_->getMemoryStats();
+        for (const auto &layer : domain_dictionaries_)
+        {
+            stats += layer->getMemoryStats();
+        }
+        stats += personal_dictionary_->getMemoryStats();
+
+        return stats;
+    }
+
+    SuggestionCacheStats SpellChecker::getSuggestionCacheStats() const
+    {
+        return suggestion_cache_ ? suggestion_cache_->getStats() : SuggestionCacheStats();
+    }
+
+    PhoneticBucketStats SpellChecker::getPhoneticStats() const
+    {
+        return dictionary_->getPhoneticStats();
+    }
+
+    void SpellChecker::compactDictionaries()
+    {
+        dictionary_->compact();
+        for (auto &layer : domain_dictionaries_)
+        {
+            layer->compact();
+        }
+        personal_dictionary_->compact();
+    }
+
+    bool SpellChecker::freezeDictionary()
+    {
+        bool success = dictionary_->freeze();
+        for (auto &layer : domain_dictionaries_)
+        {
+            success = layer->freeze() && success;
+        }
+
+        return success;
     }
 
     bool SpellChecker::saveDictionary(const std::string &dict_path) const
     {
-        return dictionary_->saveToFile(dict_path);
+        // Merge the layers, keeping the highest frequency for shared words
+        Dictionary merged;
+        std::vector<const Dictionary *> layers{dictionary_.get()};
+        for (const auto &layer : domain_dictionaries_)
+        {
+            layers.push_back(layer.get());
+        }
+        layers.push_back(personal_dictionary_.get());
+
+        for (const Dictionary *layer : layers)
+        {
+            for (const auto &word : layer->getAllWords())
+            {
+                uint32_t frequency = layer->getWordFrequency(word);
+                if (!merged.containsWord(word) || frequency > merged.getWordFrequency(word))
+                {
+                    merged.addWord(word, frequency);
+                }
+            }
+        }
+
+        return merged.saveToFile(dict_path);
     }
 
 } // namespace spellcheck
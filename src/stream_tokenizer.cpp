@@ -0,0 +1,1507 @@
+#include "stream_tokenizer.h"
+#include "text_processor.h"
+#include <algorithm>
+#include <cctype>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        // Lines longer than this are scanned in pieces so memory stays bounded
+        constexpr size_t kMaxLineBytes = 1 << 20;
+
+        // Longest local part of an email address (RFC 5321)
+        constexpr size_t kMaxEmailLocalPart = 64;
+
+        // Longest HTML character reference, e.g. "&CounterClockwiseContourIntegral;"
+        constexpr size_t kMaxEntityLength = 33;
+
+        bool isLetter(char c)
+        {
+            return std::isalpha(static_cast<unsigned char>(c)) != 0;
+        }
+
+        bool isAlnum(char c)
+        {
+            return std::isalnum(static_cast<unsigned char>(c)) != 0;
+        }
+
+        bool isSpace(char c)
+        {
+            return std::isspace(static_cast<unsigned char>(c)) != 0;
+        }
+
+        bool startsWith(std::string_view text, size_t pos, std::string_view prefix)
+        {
+            return pos <= text.size() && text.substr(pos, prefix.size()) == prefix;
+        }
+
+        bool equalsIgnoreCase(std::string_view a, std::string_view b)
+        {
+            return a.size() == b.size() &&
+                   std::equal(a.begin(), a.end(), b.begin(),
+                              [](char x, char y)
+                              {
+                                  return std::tolower(static_cast<unsigned char>(x)) ==
+                                         std::tolower(static_cast<unsigned char>(y));
+                              });
+        }
+
+        size_t skipSpaces(std::string_view line, size_t pos)
+        {
+            while (pos < line.size() && isSpace(line[pos]))
+            {
+                ++pos;
+            }
+            return pos;
+        }
+
+        size_t countRun(std::string_view line, size_t pos, char c)
+        {
+            size_t end = pos;
+            while (end < line.size() && line[end] == c)
+            {
+                ++end;
+            }
+            return end - pos;
+        }
+
+        bool isBlankFrom(std::string_view line, size_t pos)
+        {
+            return skipSpaces(line, pos) == line.size();
+        }
+
+        template <size_t N>
+        bool isOneOf(std::string_view name, const std::string_view (&names)[N])
+        {
+            return std::find(std::begin(names), std::end(names), name) != std::end(names);
+        }
+
+        /**
+         * @brief Plain text: every line is prose
+         */
+        class PlainTextTokenizer : public StreamTokenizer
+        {
+        protected:
+            void scanLine(std::string_view line) override
+            {
+                emitWords(line, 0, line.size());
+            }
+
+        public:
+            using StreamTokenizer::StreamTokenizer;
+        };
+
+        /**
+         * @brief Markdown: skips fenced code, inline code, link targets,
+         * reference definitions and inline HTML
+         */
+        class MarkdownTokenizer : public StreamTokenizer
+        {
+        private:
+            char fence_char_ = 0; // '`' or '~' while inside a fenced code block
+            size_t fence_length_ = 0;
+            bool in_comment_ = false;
+
+            static size_t findBacktickRun(std::string_view line, size_t pos, size_t length)
+            {
+                while ((pos = line.find('`', pos)) != std::string_view::npos)
+                {
+                    size_t run = countRun(line, pos, '`');
+                    if (run == length)
+                    {
+                        return pos;
+                    }
+                    pos += run;
+                }
+                return std::string_view::npos;
+            }
+
+            static size_t findClosingBracket(std::string_view line, size_t open)
+            {
+                char open_char = line[open];
+                char close_char = open_char == '(' ? ')' : ']';
+                size_t depth = 0;
+                for (size_t i = open; i < line.size(); ++i)
+                {
+                    if (line[i] == open_char)
+                    {
+                        depth++;
+                    }
+                    else if (line[i] == close_char && --depth == 0)
+                    {
+                        return i;
+                    }
+                }
+                return std::string_view::npos;
+            }
+
+        protected:
+            void scanLine(std::string_view line) override
+            {
+                const size_t n = line.size();
+                size_t indent = countRun(line, 0, ' ');
+                size_t run = indent < n ? countRun(line, indent, line[indent]) : 0;
+
+                if (fence_char_ != 0)
+                {
+                    if (indent < 4 && run >= fence_length_ && line[indent] == fence_char_ && isBlankFrom(line, indent + run))
+                    {
+                        fence_char_ = 0;
+                    }
+                    return;
+                }
+                if (indent < 4 && run >= 3 && (line[indent] == '`' || line[indent] == '~'))
+                {
+                    fence_char_ = line[indent];
+                    fence_length_ = run;
+                    return;
+                }
+
+                size_t i = 0;
+                if (in_comment_)
+                {
+                    size_t close = line.find("-->");
+                    if (close == std::string_view::npos)
+                    {
+                        return;
+                    }
+                    in_comment_ = false;
+                    i = close + 3;
+                }
+                else if (indent < 4 && indent < n && line[indent] == '[' &&
+                         line.find("]:", indent) != std::string_view::npos)
+                {
+                    // Link reference definition: "[label]: url"
+                    return;
+                }
+
+                size_t prose = i;
+                while (i < n)
+                {
+                    char c = line[i];
+                    if (c == '\\')
+                    {
+                        i = std::min(i + 2, n);
+                        continue;
+                    }
+
+                    if (c == '`')
+                    {
+                        size_t length = countRun(line, i, '`');
+                        size_t close = findBacktickRun(line, i + length, length);
+                        if (close == std::string_view::npos)
+                        {
+                            i += length;
+                            continue;
+                        }
+                        emitWords(line, prose, i);
+                        i = prose = close + length;
+                        continue;
+                    }
+
+                    // "](target)" and "][label]" after link text
+                    if (c == ']' && i + 1 < n && (line[i + 1] == '(' || line[i + 1] == '['))
+                    {
+                        size_t close = findClosingBracket(line, i + 1);
+                        if (close != std::string_view::npos)
+                        {
+                            emitWords(line, prose, i);
+                            i = prose = close + 1;
+                            continue;
+                        }
+                    }
+
+                    if (c == '<')
+                    {
+                        if (startsWith(line, i, "<!--"))
+                        {
+                            emitWords(line, prose, i);
+                            size_t close = line.find("-->", i + 4);
+                            if (close == std::string_view::npos)
+                            {
+                                in_comment_ = true;
+                                return;
+                            }
+                            i = prose = close + 3;
+                            continue;
+                        }
+
+                        // Inline HTML tags and autolinks
+                        if (i + 1 < n && (isLetter(line[i + 1]) || line[i + 1] == '/'))
+                        {
+                            size_t close = line.find('>', i + 1);
+                            if (close != std::string_view::npos)
+                            {
+                                emitWords(line, prose, i);
+                                i = prose = close + 1;
+                                continue;
+                            }
+                        }
+                    }
+
+                    ++i;
+                }
+
+                emitWords(line, prose, n);
+            }
+
+        public:
+            using StreamTokenizer::StreamTokenizer;
+        };
+
+        /**
+         * @brief LaTeX: skips commands, comments, math, verbatim-like
+         * environments and arguments that name labels, files or URLs
+         */
+        class LatexTokenizer : public StreamTokenizer
+        {
+        private:
+            enum class Math
+            {
+                None,
+                Dollar,       // $...$
+                DoubleDollar, // $$...$$
+                Paren,        // \(...\)
+                Bracket       // \[...\]
+            };
+
+            Math math_ = Math::None;
+            std::string skip_until_; // "\end{env}" while inside a skipped environment
+            size_t argument_depth_ = 0;
+
+            static constexpr std::string_view kSkippedEnvironments[] = {
+                "verbatim", "Verbatim", "lstlisting", "minted", "comment", "tikzpicture",
+                "equation", "equation*", "align", "align*", "gather", "gather*", "multline", "multline*",
+                "eqnarray", "eqnarray*", "math", "displaymath", "flalign", "flalign*", "alignat", "alignat*"};
+
+            // Commands whose first argument is a key, path or URL rather than prose
+            static constexpr std::string_view kNonProseArgumentCommands[] = {
+                "label", "ref", "eqref", "pageref", "autoref", "cref", "Cref", "nameref",
+                "cite", "citep", "citet", "citeauthor", "citeyear", "nocite",
+                "url", "href", "input", "include", "includegraphics", "includeonly",
+                "usepackage", "RequirePackage", "documentclass", "bibliography", "bibliographystyle",
+                "newcommand", "renewcommand", "providecommand", "newenvironment", "renewenvironment",
+                "setlength", "addtolength", "setcounter", "addtocounter", "hspace", "vspace",
+                "pagestyle", "thispagestyle", "pagenumbering", "color", "textcolor", "definecolor"};
+
+            size_t skipMath(std::string_view line, size_t i)
+            {
+                const size_t n = line.size();
+                while (i < n)
+                {
+                    char c = line[i];
+                    if (c == '\\' && i + 1 < n)
+                    {
+                        if ((math_ == Math::Paren && line[i + 1] == ')') ||
+                            (math_ == Math::Bracket && line[i + 1] == ']'))
+                        {
+                            math_ = Math::None;
+                            return i + 2;
+                        }
+                        i += 2;
+                        continue;
+                    }
+                    if (c == '$')
+                    {
+                        if (math_ == Math::Dollar)
+                        {
+                            math_ = Math::None;
+                            return i + 1;
+                        }
+                        if (math_ == Math::DoubleDollar && i + 1 < n && line[i + 1] == '$')
+                        {
+                            math_ = Math::None;
+                            return i + 2;
+                        }
+                    }
+                    ++i;
+                }
+                return n;
+            }
+
+            size_t skipArgument(std::string_view line, size_t i)
+            {
+                const size_t n = line.size();
+                while (i < n)
+                {
+                    char c = line[i];
+                    if (c == '\\')
+                    {
+                        i += 2;
+                        continue;
+                    }
+                    if (c == '{')
+                    {
+                        argument_depth_++;
+                    }
+                    else if (c == '}' && --argument_depth_ == 0)
+                    {
+                        return i + 1;
+                    }
+                    ++i;
+                }
+                return n;
+            }
+
+            size_t skipOptionsAndArguments(std::string_view line, size_t i, bool first_argument_only)
+            {
+                const size_t n = line.size();
+                while (true)
+                {
+                    i = skipSpaces(line, i);
+                    if (i < n && line[i] == '[')
+                    {
+                        size_t close = line.find(']', i);
+                        if (close == std::string_view::npos)
+                        {
+                            return n;
+                        }
+                        i = close + 1;
+                        continue;
+                    }
+                    if (i < n && line[i] == '{')
+                    {
+                        argument_depth_ = 1;
+                        i = skipArgument(line, i + 1);
+                        if (argument_depth_ == 0 && !first_argument_only)
+                        {
+                            continue;
+                        }
+                    }
+                    return i;
+                }
+            }
+
+            size_t scanCommand(std::string_view line, size_t i)
+            {
+                const size_t n = line.size();
+                if (i + 1 >= n)
+                {
+                    return n;
+                }
+
+                char next = line[i + 1];
+                if (next == '(' || next == '[')
+                {
+                    math_ = next == '(' ? Math::Paren : Math::Bracket;
+                    return i + 2;
+                }
+                if (!isLetter(next))
+                {
+                    // Control symbol such as \\, \% or \&
+                    return i + 2;
+                }
+
+                size_t end = i + 1;
+                while (end < n && isLetter(line[end]))
+                {
+                    ++end;
+                }
+                std::string_view name = line.substr(i + 1, end - i - 1);
+
+                if (name == "verb")
+                {
+                    if (end < n && line[end] == '*')
+                    {
+                        ++end;
+                    }
+                    if (end >= n)
+                    {
+                        return n;
+                    }
+                    size_t close = line.find(line[end], end + 1);
+                    return close == std::string_view::npos ? n : close + 1;
+                }
+
+                if (name == "begin" || name == "end")
+                {
+                    size_t open = skipSpaces(line, end);
+                    if (open >= n || line[open] != '{')
+                    {
+                        return end;
+                    }
+                    size_t close = line.find('}', open);
+                    if (close == std::string_view::npos)
+                    {
+                        return n;
+                    }
+
+                    std::string_view environment = line.substr(open + 1, close - open - 1);
+                    if (name == "end")
+                    {
+                        return close + 1;
+                    }
+                    if (isOneOf(environment, kSkippedEnvironments))
+                    {
+                        skip_until_ = "\\end{";
+                        skip_until_.append(environment);
+                        skip_until_ += '}';
+                        return close + 1;
+                    }
+
+                    // Placement and column specifications, e.g. \begin{tabular}{lcr}
+                    return skipOptionsAndArguments(line, close + 1, false);
+                }
+
+                if (isOneOf(name, kNonProseArgumentCommands))
+                {
+                    return skipOptionsAndArguments(line, end, true);
+                }
+
+                return end;
+            }
+
+        protected:
+            void scanLine(std::string_view line) override
+            {
+                const size_t n = line.size();
+                size_t i = 0;
+                size_t prose = 0;
+
+                while (i < n)
+                {
+                    if (!skip_until_.empty())
+                    {
+                        size_t close = line.find(skip_until_, i);
+                        if (close == std::string_view::npos)
+                        {
+                            return;
+                        }
+                        i = prose = close + skip_until_.size();
+                        skip_until_.clear();
+                        continue;
+                    }
+                    if (argument_depth_ > 0)
+                    {
+                        i = prose = skipArgument(line, i);
+                        continue;
+                    }
+                    if (math_ != Math::None)
+                    {
+                        i = prose = skipMath(line, i);
+                        continue;
+                    }
+
+                    char c = line[i];
+                    if (c == '%')
+                    {
+                        // Comments are not checked, as in most TeX spell checkers
+                        emitWords(line, prose, i);
+                        return;
+                    }
+                    if (c == '$')
+                    {
+                        emitWords(line, prose, i);
+                        bool display = i + 1 < n && line[i + 1] == '$';
+                        math_ = display ? Math::DoubleDollar : Math::Dollar;
+                        i = prose = i + (display ? 2 : 1);
+                        continue;
+                    }
+                    if (c == '\\')
+                    {
+                        emitWords(line, prose, i);
+                        i = prose = scanCommand(line, i);
+                        continue;
+                    }
+                    ++i;
+                }
+
+                emitWords(line, prose, n);
+            }
+
+        public:
+            using StreamTokenizer::StreamTokenizer;
+        };
+
+        /**
+         * @brief HTML and XML: skips tags with their attributes, comments,
+         * character references and the contents of code-like elements
+         */
+        class HtmlTokenizer : public StreamTokenizer
+        {
+        private:
+            bool in_comment_ = false;
+            bool in_tag_ = false;
+            char quote_ = 0;           // Quote character while inside an attribute value
+            std::string opening_raw_;  // Code-like element whose opening tag is being read
+            std::string raw_element_;  // Code-like element whose contents are being skipped
+
+            static constexpr std::string_view kRawElements[] = {"script", "style", "pre", "code", "textarea"};
+
+            size_t skipTag(std::string_view line, size_t i)
+            {
+                for (; i < line.size(); ++i)
+                {
+                    char c = line[i];
+                    if (quote_ != 0)
+                    {
+                        if (c == quote_)
+                        {
+                            quote_ = 0;
+                        }
+                    }
+                    else if (c == '"' || c == '\'')
+                    {
+                        quote_ = c;
+                    }
+                    else if (c == '>')
+                    {
+                        in_tag_ = false;
+                        if (!opening_raw_.empty() && (i == 0 || line[i - 1] != '/'))
+                        {
+                            raw_element_ = opening_raw_;
+                        }
+                        opening_raw_.clear();
+                        return i + 1;
+                    }
+                }
+                return line.size();
+            }
+
+            size_t findRawElementEnd(std::string_view line, size_t i) const
+            {
+                while ((i = line.find("</", i)) != std::string_view::npos)
+                {
+                    if (equalsIgnoreCase(line.substr(i + 2, raw_element_.size()), raw_element_))
+                    {
+                        return i;
+                    }
+                    i += 2;
+                }
+                return line.size();
+            }
+
+        protected:
+            void scanLine(std::string_view line) override
+            {
+                const size_t n = line.size();
+                size_t i = 0;
+                size_t prose = 0;
+
+                while (i < n)
+                {
+                    if (in_comment_)
+                    {
+                        size_t close = line.find("-->", i);
+                        if (close == std::string_view::npos)
+                        {
+                            return;
+                        }
+                        in_comment_ = false;
+                        i = prose = close + 3;
+                        continue;
+                    }
+                    if (in_tag_)
+                    {
+                        i = prose = skipTag(line, i);
+                        continue;
+                    }
+                    if (!raw_element_.empty())
+                    {
+                        i = prose = findRawElementEnd(line, i);
+                        if (i < n)
+                        {
+                            raw_element_.clear();
+                        }
+                        continue;
+                    }
+
+                    char c = line[i];
+                    if (c == '<')
+                    {
+                        if (startsWith(line, i, "<!--"))
+                        {
+                            emitWords(line, prose, i);
+                            in_comment_ = true;
+                            i += 4;
+                            continue;
+                        }
+
+                        char next = i + 1 < n ? line[i + 1] : '\0';
+                        if (isLetter(next) || next == '/' || next == '!' || next == '?')
+                        {
+                            emitWords(line, prose, i);
+                            size_t end = isLetter(next) ? i + 1 : i + 2;
+                            std::string name;
+                            while (end < n && isAlnum(line[end]))
+                            {
+                                name += static_cast<char>(std::tolower(static_cast<unsigned char>(line[end])));
+                                ++end;
+                            }
+                            if (isLetter(next) && isOneOf(name, kRawElements))
+                            {
+                                opening_raw_ = name;
+                            }
+                            in_tag_ = true;
+                            i = end;
+                            continue;
+                        }
+                    }
+                    else if (c == '&')
+                    {
+                        // Character references like &amp; or &#8217; separate words
+                        size_t end = i + 1;
+                        while (end < n && end - i < kMaxEntityLength && (isAlnum(line[end]) || line[end] == '#'))
+                        {
+                            ++end;
+                        }
+                        if (end < n && line[end] == ';')
+                        {
+                            emitWords(line, prose, i);
+                            i = prose = end + 1;
+                            continue;
+                        }
+                    }
+                    ++i;
+                }
+
+                emitWords(line, prose, n);
+            }
+
+        public:
+            using StreamTokenizer::StreamTokenizer;
+        };
+
+        /**
+         * @brief reStructuredText: skips literal blocks, code and math
+         * directives, comments, inline literals, roles and link targets
+         */
+        class RstTokenizer : public StreamTokenizer
+        {
+        private:
+            enum class Block
+            {
+                None,
+                AwaitLiteral, // Previous paragraph ended with "::"
+                Skipped       // Inside an indented block that is not prose
+            };
+
+            Block block_ = Block::None;
+            size_t block_indent_ = 0;
+
+            // Directives whose arguments and bodies are prose
+            static constexpr std::string_view kProseDirectives[] = {
+                "note", "warning", "tip", "hint", "important", "attention", "caution", "danger",
+                "error", "admonition", "seealso", "topic", "sidebar", "rubric", "epigraph"};
+
+        protected:
+            void scanLine(std::string_view line) override
+            {
+                const size_t n = line.size();
+                size_t indent = 0;
+                while (indent < n && (line[indent] == ' ' || line[indent] == '\t'))
+                {
+                    ++indent;
+                }
+                bool blank = indent == n;
+
+                if (block_ == Block::Skipped)
+                {
+                    if (blank || indent > block_indent_)
+                    {
+                        return;
+                    }
+                    block_ = Block::None;
+                }
+                else if (block_ == Block::AwaitLiteral)
+                {
+                    if (blank)
+                    {
+                        return;
+                    }
+                    if (indent > block_indent_)
+                    {
+                        block_ = Block::Skipped;
+                        return;
+                    }
+                    block_ = Block::None;
+                }
+
+                // Explicit markup: directives, footnotes, link targets and comments
+                if (startsWith(line, indent, "..") && (indent + 2 == n || line[indent + 2] == ' '))
+                {
+                    size_t start = std::min(indent + 3, n);
+                    size_t marker = line.find("::", start);
+                    if (marker != std::string_view::npos &&
+                        isOneOf(line.substr(start, marker - start), kProseDirectives))
+                    {
+                        emitWords(line, marker + 2, n);
+                        return;
+                    }
+                    if (start < n && line[start] == '[')
+                    {
+                        size_t close = line.find(']', start);
+                        if (close != std::string_view::npos)
+                        {
+                            emitWords(line, close + 1, n);
+                            return;
+                        }
+                    }
+                    block_ = Block::Skipped;
+                    block_indent_ = indent;
+                    return;
+                }
+
+                size_t i = indent;
+                size_t prose = indent;
+                while (i < n)
+                {
+                    char c = line[i];
+                    if (c == '\\')
+                    {
+                        i = std::min(i + 2, n);
+                        continue;
+                    }
+
+                    if (c == '`')
+                    {
+                        if (i + 1 < n && line[i + 1] == '`')
+                        {
+                            size_t close = line.find("``", i + 2);
+                            if (close == std::string_view::npos)
+                            {
+                                i += 2;
+                                continue;
+                            }
+                            emitWords(line, prose, i);
+                            i = prose = close + 2;
+                            continue;
+                        }
+
+                        size_t close = line.find('`', i + 1);
+                        if (close == std::string_view::npos)
+                        {
+                            ++i;
+                            continue;
+                        }
+
+                        // `text <target>`_ checks only the link text
+                        size_t target = line.rfind('<', close);
+                        if (target != std::string_view::npos && target > i && line[close - 1] == '>')
+                        {
+                            emitWords(line, prose, i);
+                            emitWords(line, i + 1, target);
+                            i = prose = close + 1;
+                            continue;
+                        }
+                        i = close + 1;
+                        continue;
+                    }
+
+                    // ":field name:" at the start of a field list item
+                    if (c == ':' && i == indent)
+                    {
+                        size_t close = line.find(':', i + 1);
+                        if (close != std::string_view::npos && close > i + 1 && (close + 1 == n || line[close + 1] != '`'))
+                        {
+                            i = prose = close + 1;
+                            continue;
+                        }
+                    }
+
+                    if (c == ':' && i + 1 < n && isLetter(line[i + 1]))
+                    {
+                        size_t end = i + 1;
+                        while (end < n && (isAlnum(line[end]) || line[end] == '-' || line[end] == '_' || line[end] == '.'))
+                        {
+                            ++end;
+                        }
+                        // :role:`content`
+                        if (end + 1 < n && line[end] == ':' && line[end + 1] == '`')
+                        {
+                            size_t close = line.find('`', end + 2);
+                            emitWords(line, prose, i);
+                            i = prose = close == std::string_view::npos ? n : close + 1;
+                            continue;
+                        }
+                    }
+
+                    ++i;
+                }
+
+                emitWords(line, prose, n);
+
+                // A paragraph ending in "::" introduces a literal block
+                size_t last = n;
+                while (last > 0 && isSpace(line[last - 1]))
+                {
+                    --last;
+                }
+                if (last >= 2 && line[last - 1] == ':' && line[last - 2] == ':')
+                {
+                    block_ = Block::AwaitLiteral;
+                    block_indent_ = indent;
+                }
+            }
+
+        public:
+            using StreamTokenizer::StreamTokenizer;
+        };
+
+        /**
+         * @brief C/C++, JavaScript and Python: only comments and string
+         * literals are prose
+         *
+         * Escapes, printf-style format specifiers, interpolated
+         * expressions and documentation commands (@param, \brief) are
+         * skipped. When the TextProcessor splits identifiers, identifiers
+         * in code other than keywords are checked as well, and camelCase
+         * words are split everywhere (snake_case already splits on '_').
+         */
+        class SourceTokenizer : public StreamTokenizer
+        {
+        private:
+            enum class Region
+            {
+                Code,
+                BlockComment, // /* ... */
+                String,       // Quoted string; only triple-quoted and template strings span lines
+                RawString     // C++ R"delim(...)delim"
+            };
+
+            const DocumentFormat language_;
+            const bool check_identifiers_;
+            Region region_ = Region::Code;
+            char quote_ = 0;
+            size_t quote_length_ = 1;      // 3 for Python triple-quoted strings
+            bool raw_ = false;             // Backslashes are not escapes
+            bool interpolated_ = false;    // Python f-string or JavaScript template literal
+            std::string raw_delimiter_;    // ")delim\"" closing a C++ raw string
+
+            static constexpr std::string_view kCKeywords[] = {
+                "alignas", "alignof", "auto", "bool", "break", "case", "catch", "char", "class", "const",
+                "constexpr", "const_cast", "continue", "decltype", "default", "define", "delete", "double",
+                "dynamic_cast", "else", "endif", "enum", "explicit", "extern", "false", "final", "float",
+                "for", "friend", "goto", "if", "ifdef", "ifndef", "inline", "int", "long", "mutable",
+                "namespace", "noexcept", "nullptr", "operator", "override", "pragma", "private",
+                "protected", "public", "register", "reinterpret_cast", "return", "short", "signed",
+                "sizeof", "static", "static_assert", "static_cast", "std", "struct", "switch", "template",
+                "this", "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned",
+                "using", "virtual", "void", "volatile", "while"};
+
+            static constexpr std::string_view kJavaScriptKeywords[] = {
+                "async", "await", "break", "case", "catch", "class", "const", "continue", "debugger",
+                "default", "delete", "else", "enum", "export", "extends", "false", "finally", "for",
+                "from", "function", "get", "if", "implements", "import", "in", "instanceof", "interface",
+                "let", "new", "null", "of", "private", "protected", "public", "return", "set", "static",
+                "super", "switch", "this", "throw", "true", "try", "typeof", "undefined", "var", "void",
+                "while", "with", "yield"};
+
+            static constexpr std::string_view kPythonKeywords[] = {
+                "and", "as", "assert", "async", "await", "break", "class", "cls", "continue", "def",
+                "del", "elif", "else", "except", "False", "finally", "for", "from", "global", "if",
+                "import", "in", "is", "lambda", "None", "nonlocal", "not", "or", "pass", "raise",
+                "return", "self", "True", "try", "while", "with", "yield"};
+
+            bool cStyleComments() const { return language_ != DocumentFormat::Python; }
+
+            bool isKeyword(std::string_view identifier) const
+            {
+                switch (language_)
+                {
+                case DocumentFormat::JavaScript:
+                    return isOneOf(identifier, kJavaScriptKeywords);
+                case DocumentFormat::Python:
+                    return isOneOf(identifier, kPythonKeywords);
+                default:
+                    return isOneOf(identifier, kCKeywords);
+                }
+            }
+
+            static bool isIdentifierChar(char c)
+            {
+                return isAlnum(c) || c == '_' || c == '$';
+            }
+
+            /**
+             * @brief Emit comment text, skipping documentation commands
+             */
+            void emitComment(std::string_view line, size_t begin, size_t end)
+            {
+                size_t prose = begin;
+                for (size_t i = begin; i + 1 < end; ++i)
+                {
+                    bool command = (line[i] == '@' || line[i] == '\\') && isLetter(line[i + 1]) &&
+                                   (i == begin || isSpace(line[i - 1]) || line[i - 1] == '*' || line[i - 1] == '/');
+                    if (command)
+                    {
+                        emitWords(line, prose, i);
+                        i++;
+                        while (i < end && isLetter(line[i]))
+                        {
+                            ++i;
+                        }
+                        prose = i;
+                    }
+                }
+                emitWords(line, prose, end);
+            }
+
+            static size_t skipEscape(std::string_view line, size_t i)
+            {
+                const size_t n = line.size();
+                if (i + 1 >= n)
+                {
+                    return n;
+                }
+
+                char kind = line[i + 1];
+                size_t end = i + 2;
+                size_t max_digits = 0;
+                if (kind == 'x')
+                {
+                    max_digits = 2;
+                }
+                else if (kind == 'u')
+                {
+                    max_digits = 4;
+                }
+                else if (kind == 'U')
+                {
+                    max_digits = 8;
+                }
+                while (max_digits > 0 && end < n && std::isxdigit(static_cast<unsigned char>(line[end])))
+                {
+                    ++end;
+                    --max_digits;
+                }
+                return end;
+            }
+
+            static size_t skipFormatSpecifier(std::string_view line, size_t i)
+            {
+                const size_t n = line.size();
+                size_t end = i + 1;
+                if (end < n && line[end] == '(')
+                {
+                    // Python "%(name)s"
+                    size_t close = line.find(')', end);
+                    if (close == std::string_view::npos)
+                    {
+                        return i;
+                    }
+                    end = close + 1;
+                }
+                while (end < n && std::string_view("-+#0123456789.*").find(line[end]) != std::string_view::npos)
+                {
+                    ++end;
+                }
+                while (end < n && std::string_view("hlLqjzt").find(line[end]) != std::string_view::npos)
+                {
+                    ++end;
+                }
+                return end < n && isLetter(line[end]) ? end + 1 : i;
+            }
+
+            /**
+             * @brief Scan string contents up to the closing quote
+             * @return Position after the closing quote, or the line length
+             */
+            size_t scanString(std::string_view line, size_t i)
+            {
+                const size_t n = line.size();
+                size_t prose = i;
+                while (i < n)
+                {
+                    char c = line[i];
+                    if (c == '\\')
+                    {
+                        emitWords(line, prose, i);
+                        i = prose = raw_ ? std::min(i + 2, n) : skipEscape(line, i);
+                        continue;
+                    }
+                    if (c == quote_ && (quote_length_ == 1 || countRun(line, i, c) >= quote_length_))
+                    {
+                        emitWords(line, prose, i);
+                        region_ = Region::Code;
+                        return i + quote_length_;
+                    }
+                    if (c == '%' && quote_ != '`')
+                    {
+                        size_t end = skipFormatSpecifier(line, i);
+                        if (end != i)
+                        {
+                            emitWords(line, prose, i);
+                            i = prose = end;
+                            continue;
+                        }
+                    }
+                    if (interpolated_ && c == '{' && (quote_ != '`' || (i > 0 && line[i - 1] == '$')))
+                    {
+                        if (i + 1 < n && line[i + 1] == '{')
+                        {
+                            i += 2;
+                            continue;
+                        }
+                        emitWords(line, prose, i);
+                        size_t close = line.find('}', i);
+                        i = prose = close == std::string_view::npos ? n : close + 1;
+                        continue;
+                    }
+                    ++i;
+                }
+
+                emitWords(line, prose, n);
+                return n;
+            }
+
+            void openString(char quote, size_t length, std::string_view prefix)
+            {
+                region_ = Region::String;
+                quote_ = quote;
+                quote_length_ = length;
+                raw_ = prefix.find_first_of("rR") != std::string_view::npos;
+                interpolated_ = quote == '`' || prefix.find_first_of("fF") != std::string_view::npos;
+            }
+
+        protected:
+            void scanLine(std::string_view line) override
+            {
+                const size_t n = line.size();
+                size_t i = 0;
+
+                // Preprocessor directives: include paths are not prose
+                if (language_ == DocumentFormat::CSource && region_ == Region::Code)
+                {
+                    size_t hash = skipSpaces(line, 0);
+                    if (hash < n && line[hash] == '#')
+                    {
+                        size_t name = skipSpaces(line, hash + 1);
+                        if (startsWith(line, name, "include") || startsWith(line, name, "import"))
+                        {
+                            return;
+                        }
+                        i = name;
+                        while (i < n && isLetter(line[i]))
+                        {
+                            ++i;
+                        }
+                    }
+                }
+
+                while (i < n)
+                {
+                    if (region_ == Region::BlockComment)
+                    {
+                        size_t close = line.find("*/", i);
+                        emitComment(line, i, close == std::string_view::npos ? n : close);
+                        if (close == std::string_view::npos)
+                        {
+                            return;
+                        }
+                        region_ = Region::Code;
+                        i = close + 2;
+                        continue;
+                    }
+                    if (region_ == Region::String)
+                    {
+                        i = scanString(line, i);
+                        continue;
+                    }
+                    if (region_ == Region::RawString)
+                    {
+                        size_t close = line.find(raw_delimiter_, i);
+                        emitWords(line, i, close == std::string_view::npos ? n : close);
+                        if (close == std::string_view::npos)
+                        {
+                            return;
+                        }
+                        region_ = Region::Code;
+                        i = close + raw_delimiter_.size();
+                        continue;
+                    }
+
+                    char c = line[i];
+                    char next = i + 1 < n ? line[i + 1] : '\0';
+                    if (cStyleComments() && c == '/' && next == '/')
+                    {
+                        emitComment(line, i + 2, n);
+                        return;
+                    }
+                    if (cStyleComments() && c == '/' && next == '*')
+                    {
+                        region_ = Region::BlockComment;
+                        i += 2;
+                        continue;
+                    }
+                    if (language_ == DocumentFormat::Python && c == '#')
+                    {
+                        emitComment(line, i + 1, n);
+                        return;
+                    }
+
+                    if (c == '\'' && language_ == DocumentFormat::CSource)
+                    {
+                        // Character literal
+                        size_t end = i + 1;
+                        while (end < n && line[end] != '\'')
+                        {
+                            end += line[end] == '\\' ? 2 : 1;
+                        }
+                        i = std::min(end + 1, n);
+                        continue;
+                    }
+                    if (c == '"' || c == '\'' || (c == '`' && language_ == DocumentFormat::JavaScript))
+                    {
+                        size_t length = language_ == DocumentFormat::Python && countRun(line, i, c) >= 3 ? 3 : 1;
+                        openString(c, length, {});
+                        i += length;
+                        continue;
+                    }
+
+                    if (isLetter(c) || c == '_' || c == '$')
+                    {
+                        size_t end = i;
+                        while (end < n && isIdentifierChar(line[end]))
+                        {
+                            ++end;
+                        }
+                        std::string_view identifier = line.substr(i, end - i);
+
+                        // String prefixes: C++ R"(...)" and u8"...", Python r"..." and f"..."
+                        if (end < n && (line[end] == '"' || line[end] == '\''))
+                        {
+                            if (language_ == DocumentFormat::CSource && line[end] == '"' && identifier.back() == 'R' &&
+                                identifier.size() <= 3)
+                            {
+                                size_t paren = line.find('(', end + 1);
+                                if (paren != std::string_view::npos)
+                                {
+                                    raw_delimiter_ = ")";
+                                    raw_delimiter_.append(line.substr(end + 1, paren - end - 1));
+                                    raw_delimiter_ += '"';
+                                    region_ = Region::RawString;
+                                    i = paren + 1;
+                                    continue;
+                                }
+                            }
+                            if (language_ == DocumentFormat::Python && identifier.size() <= 2 &&
+                                identifier.find_first_not_of("rRbBuUfF") == std::string_view::npos)
+                            {
+                                char quote = line[end];
+                                size_t length = countRun(line, end, quote) >= 3 ? 3 : 1;
+                                openString(quote, length, identifier);
+                                i = end + length;
+                                continue;
+                            }
+                        }
+
+                        if (check_identifiers_ && !isKeyword(identifier))
+                        {
+                            emitWords(line, i, end);
+                        }
+                        i = end;
+                        continue;
+                    }
+
+                    if (std::isdigit(static_cast<unsigned char>(c)))
+                    {
+                        // Numbers, including suffixes and hex digits such as 0xFFul
+                        while (i < n && (isIdentifierChar(line[i]) || line[i] == '.' || line[i] == '\''))
+                        {
+                            ++i;
+                        }
+                        continue;
+                    }
+
+                    ++i;
+                }
+
+                // Only triple-quoted and template strings continue on the next line
+                if (region_ == Region::String && quote_length_ == 1 && quote_ != '`' &&
+                    (n == 0 || line[n - 1] != '\\'))
+                {
+                    region_ = Region::Code;
+                }
+            }
+
+        public:
+            SourceTokenizer(const TextProcessor &processor, DocumentFormat language)
+                : StreamTokenizer(processor), language_(language), check_identifiers_(processor.splitIdentifiers())
+            {
+                setSplitCamelCase(check_identifiers_);
+            }
+        };
+    } // namespace
+
+    DocumentFormat documentFormatForPath(const std::string &file_path)
+    {
+        size_t slash = file_path.find_last_of("/\\");
+        size_t dot = file_path.rfind('.');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        {
+            return DocumentFormat::PlainText;
+        }
+
+        std::string extension = file_path.substr(dot);
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+        if (extension == ".md" || extension == ".markdown" || extension == ".mdown" || extension == ".mkd")
+        {
+            return DocumentFormat::Markdown;
+        }
+        if (extension == ".tex" || extension == ".latex" || extension == ".sty" || extension == ".cls")
+        {
+            return DocumentFormat::LaTeX;
+        }
+        if (extension == ".html" || extension == ".htm" || extension == ".xhtml" || extension == ".xml")
+        {
+            return DocumentFormat::Html;
+        }
+        if (extension == ".rst" || extension == ".rest")
+        {
+            return DocumentFormat::ReStructuredText;
+        }
+        if (extension == ".c" || extension == ".h" || extension == ".cc" || extension == ".cpp" ||
+            extension == ".cxx" || extension == ".hh" || extension == ".hpp" || extension == ".hxx")
+        {
+            return DocumentFormat::CSource;
+        }
+        if (extension == ".js" || extension == ".mjs" || extension == ".cjs" || extension == ".jsx" ||
+            extension == ".ts" || extension == ".tsx")
+        {
+            return DocumentFormat::JavaScript;
+        }
+        if (extension == ".py" || extension == ".pyi")
+        {
+            return DocumentFormat::Python;
+        }
+        return DocumentFormat::PlainText;
+    }
+
+    StreamTokenizer::StreamTokenizer(const TextProcessor &processor)
+        : processor_(processor), line_(1), column_offset_(0), column_byte_(0), column_chars_(0), tokens_(nullptr), split_camel_case_(false)
+    {
+    }
+
+    std::unique_ptr<StreamTokenizer> StreamTokenizer::create(DocumentFormat format, const TextProcessor &processor)
+    {
+        switch (format)
+        {
+        case DocumentFormat::Markdown:
+            return std::make_unique<MarkdownTokenizer>(processor);
+        case DocumentFormat::LaTeX:
+            return std::make_unique<LatexTokenizer>(processor);
+        case DocumentFormat::Html:
+            return std::make_unique<HtmlTokenizer>(processor);
+        case DocumentFormat::ReStructuredText:
+            return std::make_unique<RstTokenizer>(processor);
+        case DocumentFormat::CSource:
+        case DocumentFormat::JavaScript:
+        case DocumentFormat::Python:
+            return std::make_unique<SourceTokenizer>(processor, format);
+        case DocumentFormat::PlainText:
+        default:
+            return std::make_unique<PlainTextTokenizer>(processor);
+        }
+    }
+
+    void StreamTokenizer::feed(std::string_view chunk, std::vector<WordToken> &tokens)
+    {
+        tokens_ = &tokens;
+
+        size_t start = 0;
+        while (start < chunk.size())
+        {
+            size_t newline = chunk.find('\n', start);
+            if (newline == std::string_view::npos)
+            {
+                pending_.append(chunk.substr(start));
+                if (pending_.size() > kMaxLineBytes)
+                {
+                    flushLongLine();
+                }
+                break;
+            }
+
+            // Complete lines are scanned in place unless they began in an earlier chunk
+            if (pending_.empty())
+            {
+                processLine(chunk.substr(start, newline - start));
+            }
+            else
+            {
+                pending_.append(chunk.substr(start, newline - start));
+                processLine(pending_);
+                pending_.clear();
+            }
+            start = newline + 1;
+        }
+
+        tokens_ = nullptr;
+    }
+
+    void StreamTokenizer::finish(std::vector<WordToken> &tokens)
+    {
+        if (!pending_.empty())
+        {
+            tokens_ = &tokens;
+            processLine(pending_);
+            pending_.clear();
+            tokens_ = nullptr;
+        }
+    }
+
+    void StreamTokenizer::processLine(std::string_view line)
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        column_byte_ = 0;
+        column_chars_ = 0;
+        scanLine(line);
+        line_++;
+        column_offset_ = 0;
+    }
+
+    void StreamTokenizer::flushLongLine()
+    {
+        // Cut after the last whitespace so no word is split
+        size_t cut = pending_.find_last_of(" \t");
+        cut = cut == std::string::npos ? pending_.size() : cut + 1;
+
+        std::string_view part = std::string_view(pending_).substr(0, cut);
+        column_byte_ = 0;
+        column_chars_ = 0;
+        scanLine(part);
+        column_offset_ = columnAt(part, cut) - 1;
+        pending_.erase(0, cut);
+    }
+
+    void StreamTokenizer::emitWords(std::string_view line, size_t begin, size_t end)
+    {
+        size_t i = begin;
+        while (i < end)
+        {
+            if (!isLetter(line[i]))
+            {
+                ++i;
+                continue;
+            }
+
+            size_t address_end = skipAddress(line, i, end);
+            if (address_end != i)
+            {
+                i = address_end;
+                continue;
+            }
+
+            // Letters, optionally followed by one apostrophe and more letters
+            size_t word_end = i;
+            while (word_end < end && isLetter(line[word_end]))
+            {
+                ++word_end;
+            }
+            if (word_end + 1 < end && line[word_end] == '\'' && isLetter(line[word_end + 1]))
+            {
+                word_end++;
+                while (word_end < end && isLetter(line[word_end]))
+                {
+                    ++word_end;
+                }
+            }
+
+            if (split_camel_case_)
+            {
+                // Split before an upper-case letter that follows a lower-case
+                // one, or that starts a word after an acronym
+                size_t part = i;
+                for (size_t k = i + 1; k < word_end; ++k)
+                {
+                    bool upper = std::isupper(static_cast<unsigned char>(line[k])) != 0;
+                    bool after_lower = std::islower(static_cast<unsigned char>(line[k - 1])) != 0;
+                    bool after_upper = std::isupper(static_cast<unsigned char>(line[k - 1])) != 0;
+                    bool before_lower = k + 1 < word_end && std::islower(static_cast<unsigned char>(line[k + 1]));
+                    if (upper && (after_lower || (after_upper && before_lower)))
+                    {
+                        emitWord(line, part, k);
+                        part = k;
+                    }
+                }
+                emitWord(line, part, word_end);
+            }
+            else
+            {
+                emitWord(line, i, word_end);
+            }
+            i = word_end;
+        }
+    }
+
+    void StreamTokenizer::emitWord(std::string_view line, size_t begin, size_t end)
+    {
+        std::string word(line.substr(begin, end - begin));
+        if (!processor_.shouldIgnoreWord(word))
+        {
+            tokens_->emplace_back(processor_.normalizeWord(word), line_, columnAt(line, begin));
+        }
+    }
+
+    size_t StreamTokenizer::columnAt(std::string_view line, size_t begin)
+    {
+        if (begin < column_byte_)
+        {
+            column_byte_ = 0;
+            column_chars_ = 0;
+        }
+        for (; column_byte_ < begin; ++column_byte_)
+        {
+            // Every byte but a UTF-8 continuation byte starts a character
+            if ((static_cast<unsigned char>(line[column_byte_]) & 0xC0) != 0x80)
+            {
+                ++column_chars_;
+            }
+        }
+        return column_offset_ + column_chars_ + 1;
+    }
+
+    size_t StreamTokenizer::skipAddress(std::string_view line, size_t begin, size_t end) const
+    {
+        if (processor_.ignoreUrls())
+        {
+            size_t scheme_end = begin;
+            while (scheme_end < end && isLetter(line[scheme_end]))
+            {
+                ++scheme_end;
+            }
+
+            if (startsWith(line.substr(0, end), scheme_end, "://") ||
+                (end - begin > 4 && equalsIgnoreCase(line.substr(begin, 4), "www.")))
+            {
+                size_t url_end = begin;
+                while (url_end < end && !isSpace(line[url_end]))
+                {
+                    ++url_end;
+                }
+                return url_end;
+            }
+        }
+
+        if (processor_.ignoreEmails())
+        {
+            size_t limit = std::min(end, begin + kMaxEmailLocalPart);
+            size_t at = begin;
+            while (at < limit && (isAlnum(line[at]) || line[at] == '.' || line[at] == '_' ||
+                                  line[at] == '%' || line[at] == '+' || line[at] == '-'))
+            {
+                ++at;
+            }
+
+            if (at + 1 < end && line[at] == '@' && isAlnum(line[at + 1]))
+            {
+                size_t address_end = at + 1;
+                while (address_end < end && (isAlnum(line[address_end]) || line[address_end] == '.' || line[address_end] == '-'))
+                {
+                    ++address_end;
+                }
+                return address_end;
+            }
+        }
+
+        return begin;
+    }
+
+} // namespace spellcheck
@@ -0,0 +1,346 @@
+#include "suggestion_cache.h"
+#include <algorithm>
+#include <functional>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        // Slots per set; a word can live in any slot of its set
+        constexpr size_t kWays = 8;
+
+        constexpr size_t kMaxShards = 64;
+
+        // Threads that can read without locking; later ones lock their shard
+        constexpr size_t kMaxReaders = 256;
+
+        // Retired entries collected per shard before trying to free them
+        constexpr size_t kRetireBatch = 32;
+
+        /**
+         * @brief Epoch-based reclamation shared by every cache
+         *
+         * A reader announces the global epoch while it reads. An entry
+         * retired at epoch E may be freed once every announced epoch is
+         * past E: readers that announced later started after the entry
+         * was unlinked, so they cannot hold it.
+         */
+        class EpochDomain
+        {
+        private:
+            struct alignas(64) ReaderSlot
+            {
+                std::atomic<uint64_t> epoch{0}; // 0 while not reading
+                std::atomic<bool> in_use{false};
+            };
+
+            // Returns a thread's reader slot when the thread exits
+            struct SlotHandle
+            {
+                ReaderSlot *slot = nullptr;
+                ~SlotHandle()
+                {
+                    if (slot)
+                    {
+                        slot->in_use.store(false);
+                    }
+                }
+            };
+
+            std::atomic<uint64_t> global_{1};
+            ReaderSlot slots_[kMaxReaders];
+
+            ReaderSlot *threadSlot()
+            {
+                thread_local SlotHandle handle;
+                if (!handle.slot)
+                {
+                    for (auto &slot : slots_)
+                    {
+                        bool expected = false;
+                        if (slot.in_use.compare_exchange_strong(expected, true))
+                        {
+                            handle.slot = &slot;
+                            break;
+                        }
+                    }
+                }
+                return handle.slot;
+            }
+
+        public:
+            static EpochDomain &instance()
+            {
+                // Never destroyed: threads may exit after static destructors run
+                static EpochDomain *domain = new EpochDomain();
+                return *domain;
+            }
+
+            void *enter()
+            {
+                ReaderSlot *slot = threadSlot();
+                if (!slot)
+                {
+                    return nullptr;
+                }
+
+                // Re-check so the announced epoch is never older than the one in force
+                uint64_t epoch = global_.load();
+                while (true)
+                {
+                    slot->epoch.store(epoch);
+                    uint64_t now = global_.load();
+                    if (now == epoch)
+                    {
+                        break;
+                    }
+                    epoch = now;
+                }
+                return slot;
+            }
+
+            void exit(void *slot)
+            {
+                static_cast<ReaderSlot *>(slot)->epoch.store(0, std::memory_order_release);
+            }
+
+            uint64_t current() const { return global_.load(); }
+
+            void advance() { global_.fetch_add(1); }
+
+            uint64_t oldestActive() const
+            {
+                uint64_t oldest = UINT64_MAX;
+                for (const auto &slot : slots_)
+                {
+                    uint64_t epoch = slot.epoch.load();
+                    if (epoch != 0)
+                    {
+                        oldest = std::min(oldest, epoch);
+                    }
+                }
+                return oldest;
+            }
+        };
+
+        class EpochGuard
+        {
+        private:
+            void *slot_;
+
+        public:
+            EpochGuard() : slot_(EpochDomain::instance().enter()) {}
+            ~EpochGuard()
+            {
+                if (slot_)
+                {
+                    EpochDomain::instance().exit(slot_);
+                }
+            }
+            bool active() const { return slot_ != nullptr; }
+        };
+    } // namespace
+
+    struct SuggestionCache::Entry
+    {
+        uint64_t hash;
+        uint64_t generation;
+        std::string word;
+        std::vector<std::string> suggestions;
+        size_t bytes;
+    };
+
+    struct alignas(64) SuggestionCache::Shard
+    {
+        struct Set
+        {
+            std::atomic<Entry *> ways[kWays] = {};
+            std::atomic<bool> referenced[kWays] = {};
+            size_t hand = 0; // CLOCK hand, moved under the shard lock
+        };
+
+        std::mutex mutex;
+        std::unique_ptr<Set[]> sets;
+        std::vector<std::pair<Entry *, uint64_t>> retired; // Entry and the epoch it was retired in
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> misses{0};
+        std::atomic<size_t> evictions{0};
+        std::atomic<size_t> entries{0};
+        std::atomic<size_t> memory_bytes{0};
+    };
+
+    SuggestionCache::SuggestionCache(size_t capacity)
+        : shard_count_(1), sets_per_shard_(1), capacity_(0), generation_(1)
+    {
+        size_t sets = std::max<size_t>(1, (capacity + kWays - 1) / kWays);
+        while (shard_count_ * 2 <= std::min(sets, kMaxShards))
+        {
+            shard_count_ *= 2;
+        }
+        sets_per_shard_ = (sets + shard_count_ - 1) / shard_count_;
+        capacity_ = shard_count_ * sets_per_shard_ * kWays;
+
+        shards_ = std::make_unique<Shard[]>(shard_count_);
+        for (size_t i = 0; i < shard_count_; ++i)
+        {
+            shards_[i].sets = std::make_unique<Shard::Set[]>(sets_per_shard_);
+        }
+    }
+
+    SuggestionCache::~SuggestionCache()
+    {
+        for (size_t i = 0; i < shard_count_; ++i)
+        {
+            Shard &shard = shards_[i];
+            for (size_t set = 0; set < sets_per_shard_; ++set)
+            {
+                for (auto &way : shard.sets[set].ways)
+                {
+                    delete way.load();
+                }
+            }
+            for (const auto &retired : shard.retired)
+            {
+                delete retired.first;
+            }
+        }
+    }
+
+    bool SuggestionCache::lookup(const std::string &word, std::vector<std::string> &suggestions) const
+    {
+        uint64_t hash = std::hash<std::string>()(word);
+        Shard &shard = shards_[hash & (shard_count_ - 1)];
+        Shard::Set &set = shard.sets[(hash >> 6) % sets_per_shard_];
+        uint64_t generation = generation_.load();
+
+        EpochGuard guard;
+        std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+        if (!guard.active())
+        {
+            lock.lock();
+        }
+
+        for (size_t way = 0; way < kWays; ++way)
+        {
+            const Entry *entry = set.ways[way].load(std::memory_order_acquire);
+            if (entry && entry->hash == hash && entry->generation == generation && entry->word == word)
+            {
+                // Skip the store when already set, to keep the line shared
+                if (!set.referenced[way].load(std::memory_order_relaxed))
+                {
+                    set.referenced[way].store(true, std::memory_order_relaxed);
+                }
+                suggestions = entry->suggestions;
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void SuggestionCache::insert(const std::string &word, const std::vector<std::string> &suggestions,
+                                 uint64_t generation)
+    {
+        uint64_t hash = std::hash<std::string>()(word);
+        Shard &shard = shards_[hash & (shard_count_ - 1)];
+        Shard::Set &set = shard.sets[(hash >> 6) % sets_per_shard_];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (generation != generation_.load())
+        {
+            return;
+        }
+
+        // Prefer the word's own slot, then a free or stale one
+        size_t victim = kWays;
+        for (size_t way = 0; way < kWays && victim == kWays; ++way)
+        {
+            const Entry *entry = set.ways[way].load(std::memory_order_relaxed);
+            if (!entry || (entry->hash == hash && entry->word == word))
+            {
+                victim = way;
+            }
+        }
+        for (size_t way = 0; way < kWays && victim == kWays; ++way)
+        {
+            if (set.ways[way].load(std::memory_order_relaxed)->generation != generation)
+            {
+                victim = way;
+            }
+        }
+
+        // CLOCK: clear reference bits until an unreferenced slot comes round
+        while (victim == kWays)
+        {
+            size_t way = set.hand;
+            set.hand = (set.hand + 1) % kWays;
+            if (!set.referenced[way].exchange(false, std::memory_order_relaxed))
+            {
+                victim = way;
+                shard.evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        Entry *entry = new Entry{hash, generation, word, suggestions, 0};
+        entry->bytes = sizeof(Entry) + entry->word.capacity() + entry->suggestions.capacity() * sizeof(std::string);
+        for (const auto &suggestion : entry->suggestions)
+        {
+            entry->bytes += suggestion.capacity();
+        }
+        shard.memory_bytes.fetch_add(entry->bytes, std::memory_order_relaxed);
+
+        set.referenced[victim].store(false, std::memory_order_relaxed);
+        Entry *replaced = set.ways[victim].exchange(entry, std::memory_order_acq_rel);
+        if (replaced)
+        {
+            retire(shard, replaced);
+        }
+        else
+        {
+            shard.entries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void SuggestionCache::retire(Shard &shard, Entry *entry)
+    {
+        EpochDomain &domain = EpochDomain::instance();
+        shard.retired.emplace_back(entry, domain.current());
+        domain.advance();
+
+        if (shard.retired.size() < kRetireBatch)
+        {
+            return;
+        }
+
+        uint64_t oldest = domain.oldestActive();
+        auto still_visible = std::partition(shard.retired.begin(), shard.retired.end(),
+                                            [oldest](const std::pair<Entry *, uint64_t> &retired)
+                                            { return retired.second >= oldest; });
+        for (auto it = still_visible; it != shard.retired.end(); ++it)
+        {
+            shard.memory_bytes.fetch_sub(it->first->bytes, std::memory_order_relaxed);
+            delete it->first;
+        }
+        shard.retired.erase(still_visible, shard.retired.end());
+    }
+
+    SuggestionCacheStats SuggestionCache::getStats() const
+    {
+        SuggestionCacheStats stats;
+        stats.capacity = capacity_;
+        for (size_t i = 0; i < shard_count_; ++i)
+        {
+            const Shard &shard = shards_[i];
+            stats.entries += shard.entries.load(std::memory_order_relaxed);
+            stats.hits += shard.hits.load(std::memory_order_relaxed);
+            stats.misses += shard.misses.load(std::memory_order_relaxed);
+            stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+            stats.memory_bytes += shard.memory_bytes.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+} // namespace spellcheck
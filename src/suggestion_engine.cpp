@@ -1,132 +1,365 @@
 #include "suggestion_engine.h"
 #include "dictionary.h"
+#include "bigram_model.h"
 #include <algorithm>
 #include <unordered_set>
-#include <unordered_map>
 #include <cmath>
+#include <cctype>
+#include <limits>
 
 namespace spellcheck
 {
 
     SuggestionEngine::SuggestionEngine(const Dictionary *dictionary)
-        : dictionary_(dictionary), max_edit_distance_(2), max_suggestions_(10), edit_distance_weight_(1.0), frequency_weight_(0.5), phonetic_weight_(0.3), prefix_weight_(0.2)
+        : layers_(dictionary ? 1 : 0, dictionary), max_edit_distance_(2), max_suggestions_(10), edit_distance_weight_(1.0), frequency_weight_(0.5), phonetic_weight_(0.3), prefix_weight_(0.2),
+          keyboard_layout_(KeyboardLayout::Qwerty), key_costs_(&keyboardCostTable(KeyboardLayout::Qwerty)),
+          max_split_words_(3), context_model_(nullptr), context_shortlist_(5)
     {
     }
 
-    std::vector<std::string> SuggestionEngine::generateSuggestions(const std::string &word) const
+    namespace
     {
-        if (!dictionary_ || word.empty())
+        // Channel model: log10 probability lost per weighted edit
+        constexpr double kChannelLog10PerEdit = -2.0;
+
+        /**
+         * @brief Tracks probes and elapsed time against a SuggestionBudget
+         */
+        class BudgetTracker
         {
-            return {};
-        }
+        private:
+            const SuggestionBudget &budget_;
+            std::chrono::steady_clock::time_point deadline_;
+            size_t probes_;
+            bool exhausted_;
+
+            // Reading the clock on every probe would dominate the cost
+            static constexpr size_t kClockInterval = 32;
+
+        public:
+            explicit BudgetTracker(const SuggestionBudget &budget)
+                : budget_(budget), deadline_(std::chrono::steady_clock::now() + budget.time_limit), probes_(0), exhausted_(false)
+            {
+            }
 
-        std::unordered_set<std::string> candidate_set;
+            /**
+             * @brief Account for work about to be done
+             * @param units Number of candidate probes
+             * @return false once the budget is exhausted
+             */
+            bool consume(size_t units = 1)
+            {
+                if (exhausted_)
+                {
+                    return false;
+                }
 
-        // Generate candidates using various methods
-        auto deletions = generateDeletionCandidates(word);
-        auto insertions = generateInsertionCandidates(word);
-        auto substitutions = generateSubstitutionCandidates(word);
-        auto transpositions = generateTranspositionCandidates(word);
-        auto splits = generateSplitCandidates(word);
-        auto phonetic = generatePhoneticSuggestions(word);
-        auto prefix = generatePrefixSuggestions(word);
+                size_t before = probes_;
+                probes_ += units;
 
-        // Combine all candidates
-        for (const auto &candidate : deletions)
+                if (budget_.max_probes > 0 && probes_ > budget_.max_probes)
+                {
+                    exhausted_ = true;
+                }
+                else if (budget_.time_limit.count() > 0 &&
+                         (before / kClockInterval != probes_ / kClockInterval || units > 1) &&
+                         std::chrono::steady_clock::now() >= deadline_)
+                {
+                    exhausted_ = true;
+                }
+
+                return !exhausted_;
+            }
+
+            bool exhausted() const { return exhausted_; }
+        };
+
+        /**
+         * @brief Depth-first trie walk collecting words within a weighted distance
+         *
+         * Each trie node extends the Damerau-Levenshtein table by one row.
+         * Because no substitution costs more than a transposition, a row
+         * whose smallest entry exceeds the limit can only grow further down,
+         * so the whole subtree is skipped. With a budget tracker, each
+         * node visited counts as one probe and the walk stops when it runs out.
+         */
+        class BoundedTrieSearch
         {
-            if (dictionary_->containsWord(candidate))
+        private:
+            const std::string &word_;
+            const KeyboardCostTable &costs_;
+            double max_distance_;
+            std::vector<std::vector<double>> rows_; // rows_[d]: distances after d trie characters
+            std::string prefix_;
+            std::vector<std::pair<std::string, double>> &matches_;
+            BudgetTracker *tracker_;
+
+            void visit(const TrieNode *node, size_t depth)
             {
-                candidate_set.insert(candidate);
+                if (tracker_ && !tracker_->consume())
+                {
+                    return;
+                }
+                if (depth >= rows_.size())
+                {
+                    rows_.emplace_back(word_.length() + 1);
+                }
+
+                const std::vector<double> &previous = rows_[depth - 1];
+                std::vector<double> &row = rows_[depth];
+                const char c = prefix_[depth - 1];
+
+                row[0] = previous[0] + 1.0;
+                double row_min = row[0];
+                for (size_t j = 1; j <= word_.length(); ++j)
+                {
+                    double distance = std::min({row[j - 1] + 1.0,     // deletion
+                                                previous[j] + 1.0,    // insertion
+                                                previous[j - 1] + costs_.substitution(word_[j - 1], c)});
+
+                    // Transposition of the last two characters
+                    if (j > 1 && depth > 1 && word_[j - 1] == prefix_[depth - 2] && word_[j - 2] == c)
+                    {
+                        distance = std::min(distance, rows_[depth - 2][j - 2] + 1.0);
+                    }
+
+                    row[j] = distance;
+                    row_min = std::min(row_min, distance);
+                }
+
+                if (node->is_word && row[word_.length()] <= max_distance_)
+                {
+                    matches_.emplace_back(prefix_, row[word_.length()]);
+                }
+
+                if (row_min > max_distance_)
+                {
+                    return;
+                }
+
+                for (const auto &child : node->children)
+                {
+                    prefix_.push_back(child.first);
+                    visit(child.second.get(), depth + 1);
+                    prefix_.pop_back();
+                }
             }
-        }
 
-        for (const auto &candidate : insertions)
-        {
-            if (dictionary_->containsWord(candidate))
+        public:
+            BoundedTrieSearch(const std::string &word, const KeyboardCostTable &costs, double max_distance,
+                              std::vector<std::pair<std::string, double>> &matches, BudgetTracker *tracker = nullptr)
+                : word_(word), costs_(costs), max_distance_(max_distance), matches_(matches), tracker_(tracker)
             {
-                candidate_set.insert(candidate);
+                rows_.emplace_back(word_.length() + 1);
+                for (size_t j = 0; j <= word_.length(); ++j)
+                {
+                    rows_[0][j] = static_cast<double>(j);
+                }
             }
-        }
 
-        for (const auto &candidate : substitutions)
-        {
-            if (dictionary_->containsWord(candidate))
+            void run(const TrieNode *root)
             {
-                candidate_set.insert(candidate);
+                for (const auto &child : root->children)
+                {
+                    prefix_.assign(1, child.first);
+                    visit(child.second.get(), 1);
+                }
             }
+        };
+    } // namespace
+
+    std::vector<std::string> SuggestionEngine::generateSuggestions(const std::string &word) const
+    {
+        return generateSuggestions(word, budget_).suggestions;
+    }
+
+    SuggestionResult SuggestionEngine::generateSuggestions(const std::string &word,
+                                                           const SuggestionBudget &budget) const
+    {
+        SuggestionResult result;
+        if (layers_.empty() || word.empty())
+        {
+            return result;
         }
 
-        for (const auto &candidate : transpositions)
+        BudgetTracker tracker(budget);
+        std::unordered_set<std::string> candidate_set;
+
+        auto probe = [this, &tracker, &candidate_set](const std::string &candidate)
         {
-            if (dictionary_->containsWord(candidate))
+            if (!tracker.consume())
+            {
+                return false;
+            }
+            if (containsWord(candidate))
             {
                 candidate_set.insert(candidate);
             }
-        }
-
-        for (const auto &candidate : splits)
+            return true;
+        };
+
+        // Tier 1: O(n) edits; tier 2: O(26n) edits
+        bool complete = generateDeletionCandidates(word, probe) &&
+                        generateTranspositionCandidates(word, probe) &&
+                        generateSubstitutionCandidates(word, probe) &&
+                        generateInsertionCandidates(word, probe);
+
+        // Tier 3: words up to max_edit_distance_ away, from a bounded trie walk.
+        // It visits far more nodes than the edits above probe, so it only runs
+        // when no single edit is a word
+        if (complete && max_edit_distance_ > 1 && candidate_set.empty())
         {
-            if (dictionary_->containsWord(candidate))
+            std::string normalized_word = word;
+            std::transform(normalized_word.begin(), normalized_word.end(), normalized_word.begin(), ::tolower);
+
+            std::vector<std::pair<std::string, double>> matches;
+            for (const Dictionary *layer : layers_)
             {
-                candidate_set.insert(candidate);
+                BoundedTrieSearch search(normalized_word, *key_costs_, static_cast<double>(max_edit_distance_),
+                                         matches, &tracker);
+                search.run(layer->getTrieRoot());
+            }
+            for (auto &match : matches)
+            {
+                candidate_set.insert(std::move(match.first));
             }
+            complete = !tracker.exhausted();
         }
 
-        for (const auto &candidate : phonetic)
+        // Tier 4: phonetic matches are already dictionary words
+        if (complete && tracker.consume())
         {
-            candidate_set.insert(candidate);
+            auto phonetic = generatePhoneticSuggestions(word);
+            candidate_set.insert(phonetic.begin(), phonetic.end());
+            complete = tracker.consume(phonetic.size());
         }
 
-        for (const auto &candidate : prefix)
+        // Tier 5: prefix matches
+        if (complete && tracker.consume())
         {
-            candidate_set.insert(candidate);
+            auto prefix = generatePrefixSuggestions(word);
+            candidate_set.insert(prefix.begin(), prefix.end());
+            complete = tracker.consume(prefix.size());
         }
 
+        // Tier 6: split candidates are made of dictionary words only
+        if (complete && tracker.consume(word.length()))
+        {
+            auto splits = generateSplitCandidates(word);
+            candidate_set.insert(splits.begin(), splits.end());
+        }
+
+        result.truncated = tracker.exhausted();
+
         // Convert set to vector for ranking
         std::vector<std::string> candidates(candidate_set.begin(), candidate_set.end());
 
         // Rank and return suggestions
-        return rankCandidates(word, candidates);
+        result.suggestions = rankCandidates(word, candidates);
+        return result;
+    }
+
+    std::vector<std::string> SuggestionEngine::rerankInContext(const std::string &word,
+                                                               std::vector<std::string> suggestions,
+                                                               const std::string &previous,
+                                                               const std::string &next) const
+    {
+        if (!context_model_ || !context_model_->isLoaded() || suggestions.size() < 2 ||
+            (previous.empty() && next.empty()))
+        {
+            return suggestions;
+        }
+
+        BigramModel::Context context = context_model_->makeContext(previous, next);
+        size_t shortlist = std::min(context_shortlist_, suggestions.size());
+
+        std::vector<std::pair<double, size_t>> scored;
+        scored.reserve(shortlist);
+        for (size_t i = 0; i < shortlist; ++i)
+        {
+            double channel = kChannelLog10PerEdit * calculateWeightedDistance(word, suggestions[i]);
+            scored.emplace_back(context_model_->score(context, suggestions[i]) + channel, i);
+        }
+
+        // Ties keep the context-free order
+        std::stable_sort(scored.begin(), scored.end(),
+                         [](const auto &a, const auto &b)
+                         {
+                             return a.first > b.first;
+                         });
+
+        std::vector<std::string> reranked;
+        reranked.reserve(suggestions.size());
+        for (const auto &entry : scored)
+        {
+            reranked.push_back(std::move(suggestions[entry.second]));
+        }
+        for (size_t i = shortlist; i < suggestions.size(); ++i)
+        {
+            reranked.push_back(std::move(suggestions[i]));
+        }
+
+        return reranked;
     }
 
     std::vector<std::string> SuggestionEngine::generateEditDistanceSuggestions(const std::string &word,
                                                                                size_t max_distance) const
     {
-        if (!dictionary_)
+        if (layers_.empty())
         {
             return {};
         }
 
-        std::vector<std::string> suggestions;
-        auto all_words = dictionary_->getAllWords();
+        std::string normalized_word = word;
+        std::transform(normalized_word.begin(), normalized_word.end(), normalized_word.begin(), ::tolower);
 
-        for (const auto &dict_word : all_words)
+        std::vector<std::pair<std::string, double>> matches;
+        for (const Dictionary *layer : layers_)
         {
-            size_t distance = calculateEditDistance(word, dict_word);
-            if (distance <= max_distance)
-            {
-                suggestions.push_back(dict_word);
-            }
+            BoundedTrieSearch search(normalized_word, *key_costs_, static_cast<double>(max_distance), matches);
+            search.run(layer->getTrieRoot());
         }
 
+        // A word may appear in more than one layer
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end(),
+                                  [](const auto &a, const auto &b)
+                                  {
+                                      return a.first == b.first;
+                                  }),
+                      matches.end());
+
         // Sort by edit distance and frequency
-        std::sort(suggestions.begin(), suggestions.end(),
-                  [this, &word](const std::string &a, const std::string &b)
+        std::vector<std::pair<uint32_t, size_t>> frequencies(matches.size());
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+            frequencies[i] = {getWordFrequency(matches[i].first), i};
+        }
+        std::sort(frequencies.begin(), frequencies.end(),
+                  [&matches](const auto &a, const auto &b)
                   {
-                      size_t dist_a = calculateEditDistance(word, a);
-                      size_t dist_b = calculateEditDistance(word, b);
+                      double dist_a = matches[a.second].second;
+                      double dist_b = matches[b.second].second;
 
                       if (dist_a != dist_b)
                       {
                           return dist_a < dist_b;
                       }
-
-                      return dictionary_->getWordFrequency(a) > dictionary_->getWordFrequency(b);
+                      if (a.first != b.first)
+                      {
+                          return a.first > b.first;
+                      }
+                      return a.second < b.second;
                   });
 
-        if (suggestions.size() > max_suggestions_)
+        std::vector<std::string> suggestions;
+        for (const auto &entry : frequencies)
         {
-            suggestions.resize(max_suggestions_);
+            if (suggestions.size() >= max_suggestions_)
+            {
+                break;
+            }
+            suggestions.push_back(matches[entry.second].first);
         }
 
         return suggestions;
@@ -134,17 +367,27 @@ namespace spellcheck
 
     std::vector<std::string> SuggestionEngine::generatePhoneticSuggestions(const std::string &word) const
     {
-        if (!dictionary_)
+        std::vector<std::string> suggestions;
+        for (const Dictionary *layer : layers_)
         {
-            return {};
+            for (const auto &match : layer->getPhoneticMatches(word))
+            {
+                // Sound-alikes far longer or shorter than the word rank poorly anyway
+                size_t length_difference = match.length() > word.length() ? match.length() - word.length()
+                                                                           : word.length() - match.length();
+                if (length_difference <= max_edit_distance_)
+                {
+                    suggestions.push_back(match);
+                }
+            }
         }
 
-        return dictionary_->getPhoneticMatches(word);
+        return suggestions;
     }
 
     std::vector<std::string> SuggestionEngine::generatePrefixSuggestions(const std::string &word) const
     {
-        if (!dictionary_)
+        if (layers_.empty())
         {
             return {};
         }
@@ -155,9 +398,11 @@ namespace spellcheck
         for (size_t len = std::min(word.length(), static_cast<size_t>(3)); len <= word.length(); ++len)
         {
             std::string prefix = word.substr(0, len);
-            auto prefix_matches = dictionary_->getWordsWithPrefix(prefix, 20);
-
-            suggestions.insert(suggestions.end(), prefix_matches.begin(), prefix_matches.end());
+            for (const Dictionary *layer : layers_)
+            {
+                auto prefix_matches = layer->getWordsWithPrefix(prefix, 20);
+                suggestions.insert(suggestions.end(), prefix_matches.begin(), prefix_matches.end());
+            }
         }
 
         // Remove duplicates
@@ -167,75 +412,30 @@ namespace spellcheck
         return suggestions;
     }
 
-    size_t SuggestionEngine::calculateEditDistance(const std::string &word1, const std::string &word2) const
+    double SuggestionEngine::calculateWeightedDistance(const std::string &word1, const std::string &word2) const
     {
         const size_t len1 = word1.length();
         const size_t len2 = word2.length();
 
-        std::vector<std::vector<size_t>> dp(len1 + 1, std::vector<size_t>(len2 + 1));
+        // Only the last three rows are needed, including the one for transpositions
+        std::vector<double> before_previous(len2 + 1);
+        std::vector<double> previous(len2 + 1);
+        std::vector<double> current(len2 + 1);
 
-        // Initialize base cases
-        for (size_t i = 0; i <= len1; ++i)
-        {
-            dp[i][0] = i;
-        }
         for (size_t j = 0; j <= len2; ++j)
         {
-            dp[0][j] = j;
+            previous[j] = static_cast<double>(j);
         }
 
-        // Fill the DP table
         for (size_t i = 1; i <= len1; ++i)
         {
+            current[0] = static_cast<double>(i);
             for (size_t j = 1; j <= len2; ++j)
             {
-                if (word1[i - 1] == word2[j - 1])
-                {
-                    dp[i][j] = dp[i - 1][j - 1];
-                }
-                else
-                {
-                    dp[i][j] = 1 + std::min({
-                                       dp[i - 1][j],    // deletion
-                                       dp[i][j - 1],    // insertion
-                                       dp[i - 1][j - 1] // substitution
-                                   });
-                }
-            }
-        }
-
-        return dp[len1][len2];
-    }
-
-    size_t SuggestionEngine::calculateDamerauLevenshteinDistance(const std::string &word1,
-                                                                 const std::string &word2) const
-    {
-        const size_t len1 = word1.length();
-        const size_t len2 = word2.length();
-
-        std::vector<std::vector<size_t>> dp(len1 + 1, std::vector<size_t>(len2 + 1));
-
-        // Initialize base cases
-        for (size_t i = 0; i <= len1; ++i)
-        {
-            dp[i][0] = i;
-        }
-        for (size_t j = 0; j <= len2; ++j)
-        {
-            dp[0][j] = j;
-        }
-
-        // Fill the DP table
-        for (size_t i = 1; i <= len1; ++i)
-        {
-            for (size_t j = 1; j <= len2; ++j)
-            {
-                size_t cost = (word1[i - 1] == word2[j - 1]) ? 0 : 1;
-
-                dp[i][j] = std::min({
-                    dp[i - 1][j] + 1,       // deletion
-                    dp[i][j - 1] + 1,       // insertion
-                    dp[i - 1][j - 1] + cost // substitution
+                current[j] = std::min({
+                    previous[j] + 1.0,                                                 // deletion
+                    current[j - 1] + 1.0,                                              // insertion
+                    previous[j - 1] + key_costs_->substitution(word1[i - 1], word2[j - 1]) // substitution
                 });
 
                 // Transposition
@@ -243,48 +443,63 @@ namespace spellcheck
                     word1[i - 1] == word2[j - 2] &&
                     word1[i - 2] == word2[j - 1])
                 {
-                    dp[i][j] = std::min(dp[i][j], dp[i - 2][j - 2] + cost);
+                    current[j] = std::min(current[j], before_previous[j - 2] + 1.0);
                 }
             }
+
+            std::swap(before_previous, previous);
+            std::swap(previous, current);
         }
 
-        return dp[len1][len2];
+        return previous[len2];
     }
 
-    std::vector<std::string> SuggestionEngine::generateDeletionCandidates(const std::string &word) const
+    bool SuggestionEngine::generateDeletionCandidates(const std::string &word,
+                                                      const CandidateVisitor &visit) const
     {
-        std::vector<std::string> candidates;
+        std::string candidate;
 
         for (size_t i = 0; i < word.length(); ++i)
         {
-            std::string candidate = word.substr(0, i) + word.substr(i + 1);
-            candidates.push_back(candidate);
+            candidate.assign(word, 0, i);
+            candidate.append(word, i + 1, std::string::npos);
+            if (!visit(candidate))
+            {
+                return false;
+            }
         }
 
-        return candidates;
+        return true;
     }
 
-    std::vector<std::string> SuggestionEngine::generateInsertionCandidates(const std::string &word) const
+    bool SuggestionEngine::generateInsertionCandidates(const std::string &word,
+                                                       const CandidateVisitor &visit) const
     {
-        std::vector<std::string> candidates;
         const std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+        std::string candidate;
 
         for (size_t i = 0; i <= word.length(); ++i)
         {
+            candidate = word;
+            candidate.insert(candidate.begin() + i, ' ');
             for (char c : alphabet)
             {
-                std::string candidate = word.substr(0, i) + c + word.substr(i);
-                candidates.push_back(candidate);
+                candidate[i] = c;
+                if (!visit(candidate))
+                {
+                    return false;
+                }
             }
         }
 
-        return candidates;
+        return true;
     }
 
-    std::vector<std::string> SuggestionEngine::generateSubstitutionCandidates(const std::string &word) const
+    bool SuggestionEngine::generateSubstitutionCandidates(const std::string &word,
+                                                          const CandidateVisitor &visit) const
     {
-        std::vector<std::string> candidates;
         const std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+        std::string candidate = word;
 
         for (size_t i = 0; i < word.length(); ++i)
         {
@@ -292,45 +507,130 @@ namespace spellcheck
             {
                 if (c != word[i])
                 {
-                    std::string candidate = word;
                     candidate[i] = c;
-                    candidates.push_back(candidate);
+                    if (!visit(candidate))
+                    {
+                        return false;
+                    }
                 }
             }
+            candidate[i] = word[i];
         }
 
-        return candidates;
+        return true;
     }
 
-    std::vector<std::string> SuggestionEngine::generateTranspositionCandidates(const std::string &word) const
+    bool SuggestionEngine::generateTranspositionCandidates(const std::string &word,
+                                                           const CandidateVisitor &visit) const
     {
-        std::vector<std::string> candidates;
+        std::string candidate = word;
 
-        for (size_t i = 0; i < word.length() - 1; ++i)
+        for (size_t i = 0; i + 1 < word.length(); ++i)
         {
-            std::string candidate = word;
             std::swap(candidate[i], candidate[i + 1]);
-            candidates.push_back(candidate);
+            if (!visit(candidate))
+            {
+                return false;
+            }
+            std::swap(candidate[i], candidate[i + 1]);
         }
 
-        return candidates;
+        return true;
     }
 
     std::vector<std::string> SuggestionEngine::generateSplitCandidates(const std::string &word) const
     {
-        std::vector<std::string> candidates;
+        const size_t length = word.length();
+        const size_t max_words = max_split_words_;
+        if (layers_.empty() || length < 2 || max_words < 2)
+        {
+            return {};
+        }
+
+        std::string normalized_word = word;
+        std::transform(normalized_word.begin(), normalized_word.end(), normalized_word.begin(), ::tolower);
+
+        // score[k][j]: best summed log frequency of k words covering word[0, j);
+        // start[k][j]: where the last of those words begins
+        const double unreachable = -std::numeric_limits<double>::infinity();
+        std::vector<std::vector<double>> score(max_words + 1, std::vector<double>(length + 1, unreachable));
+        std::vector<std::vector<size_t>> start(max_words + 1, std::vector<size_t>(length + 1, 0));
+        score[0][0] = 0.0;
 
-        for (size_t i = 1; i < word.length(); ++i)
+        // Dictionary words starting at the current offset: (end, log frequency)
+        std::vector<std::pair<size_t, double>> words;
+
+        for (size_t i = 0; i < length; ++i)
         {
-            std::string first_part = word.substr(0, i);
-            std::string second_part = word.substr(i);
+            bool reachable = false;
+            for (size_t k = 0; k < max_words && !reachable; ++k)
+            {
+                reachable = score[k][i] != unreachable;
+            }
+            if (!reachable)
+            {
+                continue;
+            }
 
-            if (dictionary_->containsWord(first_part) && dictionary_->containsWord(second_part))
+            // One walk down each trie finds every word starting at i
+            words.clear();
+            for (const Dictionary *layer : layers_)
             {
-                candidates.push_back(first_part + " " + second_part);
+                const TrieNode *node = layer->getTrieRoot();
+                for (size_t j = i; j < length && node; ++j)
+                {
+                    auto child = node->children.find(normalized_word[j]);
+                    node = child == node->children.end() ? nullptr : child->second.get();
+                    if (node && node->is_word)
+                    {
+                        words.emplace_back(j + 1, std::log1p(static_cast<double>(node->frequency)));
+                    }
+                }
+            }
+
+            for (size_t k = 0; k < max_words; ++k)
+            {
+                if (score[k][i] == unreachable)
+                {
+                    continue;
+                }
+                for (const auto &entry : words)
+                {
+                    double candidate = score[k][i] + entry.second;
+                    if (candidate > score[k + 1][entry.first])
+                    {
+                        score[k + 1][entry.first] = candidate;
+                        start[k + 1][entry.first] = i;
+                    }
+                }
             }
         }
 
+        std::vector<std::string> candidates;
+        for (size_t k = 2; k <= max_words; ++k)
+        {
+            if (score[k][length] == unreachable)
+            {
+                continue;
+            }
+
+            std::vector<std::string> parts;
+            for (size_t end = length, count = k; count > 0; --count)
+            {
+                size_t begin = start[count][end];
+                parts.push_back(normalized_word.substr(begin, end - begin));
+                end = begin;
+            }
+
+            std::string candidate = parts.back();
+            for (auto it = parts.rbegin() + 1; it != parts.rend(); ++it)
+            {
+                candidate += ' ';
+                candidate += *it;
+            }
+            candidates.push_back(std::move(candidate));
+        }
+
         return candidates;
     }
 
@@ -371,13 +671,14 @@ namespace spellcheck
     {
         double score = 0.0;
 
-        // Edit distance component (lower distance = higher score)
-        size_t edit_distance = calculateEditDistance(original, candidate);
+        // Edit distance component (lower distance = higher score); typos on
+        // neighbouring keys count as less than a full edit
+        double edit_distance = calculateWeightedDistance(original, candidate);
         double edit_score = 1.0 / (1.0 + edit_distance);
         score += edit_distance_weight_ * edit_score;
 
         // Frequency component
-        uint32_t frequency = dictionary_->getWordFrequency(candidate);
+        uint32_t frequency = getWordFrequency(candidate);
         double freq_score = std::log(1.0 + frequency) / 10.0; // Normalized log frequency
         score += frequency_weight_ * freq_score;
 
@@ -396,27 +697,50 @@ namespace spellcheck
         double prefix_score = static_cast<double>(common_prefix) / original.length();
         score += prefix_weight_ * prefix_score;
 
+        // Sound-alike bonus
+        if (phonetic_weight_ > 0.0 && soundsAlike(original, candidate))
+        {
+            score += phonetic_weight_;
+        }
+
         return score;
     }
 
-    double SuggestionEngine::getKeyboardDistance(char c1, char c2) const
+    bool SuggestionEngine::containsWord(const std::string &word) const
     {
-        // QWERTY keyboard layout distances (simplified)
-        static const std::unordered_map<char, std::pair<int, int>> qwerty_positions = {
-            {'q', {0, 0}}, {'w', {0, 1}}, {'e', {0, 2}}, {'r', {0, 3}}, {'t', {0, 4}}, {'y', {0, 5}}, {'u', {0, 6}}, {'i', {0, 7}}, {'o', {0, 8}}, {'p', {0, 9}}, {'a', {1, 0}}, {'s', {1, 1}}, {'d', {1, 2}}, {'f', {1, 3}}, {'g', {1, 4}}, {'h', {1, 5}}, {'j', {1, 6}}, {'k', {1, 7}}, {'l', {1, 8}}, {'z', {2, 0}}, {'x', {2, 1}}, {'c', {2, 2}}, {'v', {2, 3}}, {'b', {2, 4}}, {'n', {2, 5}}, {'m', {2, 6}}};
+        for (const Dictionary *layer : layers_)
+        {
+            if (layer->containsWord(word))
+            {
+                return true;
+            }
+        }
 
-        auto it1 = qwerty_positions.find(std::tolower(c1));
-        auto it2 = qwerty_positions.find(std::tolower(c2));
+        return false;
+    }
 
-        if (it1 == qwerty_positions.end() || it2 == qwerty_positions.end())
+    bool SuggestionEngine::soundsAlike(const std::string &word, const std::string &candidate) const
+    {
+        for (const Dictionary *layer : layers_)
         {
-            return 10.0; // Large distance for unknown characters
+            if (layer->soundsAlike(word, candidate))
+            {
+                return true;
+            }
         }
 
-        int dx = it1->second.first - it2->second.first;
-        int dy = it1->second.second - it2->second.second;
+        return false;
+    }
+
+    uint32_t SuggestionEngine::getWordFrequency(const std::string &word) const
+    {
+        uint32_t frequency = 0;
+        for (const Dictionary *layer : layers_)
+        {
+            frequency = std::max(frequency, layer->getWordFrequency(word));
+        }
 
-        return std::sqrt(dx * dx + dy * dy);
+        return frequency;
     }
 
 } // namespace spellcheck
@@ -0,0 +1,303 @@
+#include "suggestion_store.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        constexpr char kMagic[4] = {'S', 'C', 'S', 'S'};
+        constexpr uint32_t kVersion = 1;
+
+        struct FileHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint64_t dictionary_hash;
+            uint64_t settings_hash;
+        };
+
+        // Record: word length, payload length, word, suggestions separated by '\n'
+        struct RecordHeader
+        {
+            uint32_t word_length;
+            uint32_t payload_length;
+        };
+
+        FileHeader makeHeader(uint64_t dictionary_hash, uint64_t settings_hash)
+        {
+            FileHeader header;
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kVersion;
+            header.dictionary_hash = dictionary_hash;
+            header.settings_hash = settings_hash;
+            return header;
+        }
+
+        void writeRecord(std::ofstream &file, std::string_view word, const std::vector<std::string> &suggestions)
+        {
+            std::string payload;
+            for (const auto &suggestion : suggestions)
+            {
+                if (!payload.empty())
+                {
+                    payload += '\n';
+                }
+                payload += suggestion;
+            }
+
+            RecordHeader record{static_cast<uint32_t>(word.size()), static_cast<uint32_t>(payload.size())};
+            file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+            file.write(word.data(), word.size());
+            file.write(payload.data(), payload.size());
+        }
+
+        void splitPayload(std::string_view payload, std::vector<std::string> &suggestions)
+        {
+            suggestions.clear();
+            if (payload.empty())
+            {
+                return;
+            }
+
+            size_t start = 0;
+            while (true)
+            {
+                size_t end = payload.find('\n', start);
+                if (end == std::string_view::npos)
+                {
+                    suggestions.emplace_back(payload.substr(start));
+                    return;
+                }
+                suggestions.emplace_back(payload.substr(start, end - start));
+                start = end + 1;
+            }
+        }
+    } // namespace
+
+    SuggestionStore::SuggestionStore()
+        : data_(nullptr), size_(0), end_(0), dictionary_hash_(0), settings_hash_(0), valid_(false)
+    {
+    }
+
+    SuggestionStore::~SuggestionStore()
+    {
+        close();
+    }
+
+    void SuggestionStore::close()
+    {
+        if (data_)
+        {
+            munmap(const_cast<char *>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        end_ = 0;
+        index_.clear();
+        valid_ = false;
+    }
+
+    size_t SuggestionStore::open(const std::string &file_path, uint64_t dictionary_hash, uint64_t settings_hash)
+    {
+        close();
+        path_ = file_path;
+        dictionary_hash_ = dictionary_hash;
+        settings_hash_ = settings_hash;
+
+        int fd = ::open(file_path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return 0;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FileHeader))
+        {
+            ::close(fd);
+            return 0;
+        }
+
+        size_t size = static_cast<size_t>(info.st_size);
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+        {
+            return 0;
+        }
+
+        // Records for other dictionaries or settings are left for flush to replace
+        FileHeader header;
+        std::memcpy(&header, mapped, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+            header.dictionary_hash != dictionary_hash || header.settings_hash != settings_hash)
+        {
+            munmap(mapped, size);
+            return 0;
+        }
+
+        data_ = static_cast<const char *>(mapped);
+        size_ = size;
+
+        // Later records for a word replace earlier ones; a partial record ends the log
+        size_t offset = sizeof(FileHeader);
+        while (size_ - offset >= sizeof(RecordHeader))
+        {
+            RecordHeader record;
+            std::memcpy(&record, data_ + offset, sizeof(record));
+            size_t length = static_cast<size_t>(record.word_length) + record.payload_length;
+            if (record.word_length == 0 || length > size_ - offset - sizeof(RecordHeader))
+            {
+                break;
+            }
+
+            const char *word = data_ + offset + sizeof(RecordHeader);
+            index_[std::string_view(word, record.word_length)] =
+                std::string_view(word + record.word_length, record.payload_length);
+            offset += sizeof(RecordHeader) + length;
+        }
+        end_ = offset;
+        valid_ = true;
+
+        return index_.size();
+    }
+
+    bool SuggestionStore::lookup(const std::string &word, std::vector<std::string> &suggestions) const
+    {
+        if (!valid_.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        auto it = index_.find(word);
+        if (it == index_.end())
+        {
+            return false;
+        }
+
+        splitPayload(it->second, suggestions);
+        return true;
+    }
+
+    void SuggestionStore::record(const std::string &word, const std::vector<std::string> &suggestions)
+    {
+        if (!isOpen() || word.empty())
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (pending_words_.insert(word).second)
+        {
+            pending_.emplace_back(word, suggestions);
+        }
+    }
+
+    void SuggestionStore::invalidate()
+    {
+        valid_ = false;
+
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_.clear();
+        pending_words_.clear();
+    }
+
+    bool SuggestionStore::rewrite(uint64_t dictionary_hash, uint64_t settings_hash)
+    {
+        // Written beside the old file and renamed over it, so readers never see half a file
+        std::string temp_path = path_ + ".tmp";
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "Cannot write suggestion cache: " << temp_path << std::endl;
+            return false;
+        }
+
+        FileHeader header = makeHeader(dictionary_hash, settings_hash);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        // Keep the records still valid for these versions
+        bool keep = valid_ && dictionary_hash == dictionary_hash_ && settings_hash == settings_hash_;
+        if (keep)
+        {
+            std::vector<std::string> suggestions;
+            for (const auto &entry : index_)
+            {
+                if (pending_words_.count(std::string(entry.first)) == 0)
+                {
+                    splitPayload(entry.second, suggestions);
+                    writeRecord(file, entry.first, suggestions);
+                }
+            }
+        }
+        for (const auto &entry : pending_)
+        {
+            writeRecord(file, entry.first, entry.second);
+        }
+
+        file.close();
+        if (!file || std::rename(temp_path.c_str(), path_.c_str()) != 0)
+        {
+            std::cerr << "Cannot write suggestion cache: " << path_ << std::endl;
+            std::remove(temp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool SuggestionStore::flush(uint64_t dictionary_hash, uint64_t settings_hash)
+    {
+        if (!isOpen())
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        bool matches = valid_ && dictionary_hash == dictionary_hash_ && settings_hash == settings_hash_;
+        if (pending_.empty() && (matches || !data_))
+        {
+            return true;
+        }
+
+        // Appending is only safe onto a complete log written for the same versions
+        bool success;
+        if (matches && end_ == size_)
+        {
+            std::ofstream file(path_, std::ios::binary | std::ios::app);
+            for (const auto &entry : pending_)
+            {
+                writeRecord(file, entry.first, entry.second);
+            }
+            file.close();
+            success = static_cast<bool>(file);
+            if (!success)
+            {
+                std::cerr << "Cannot write suggestion cache: " << path_ << std::endl;
+            }
+        }
+        else
+        {
+            success = rewrite(dictionary_hash, settings_hash);
+        }
+
+        pending_.clear();
+        pending_words_.clear();
+        if (!success)
+        {
+            return false;
+        }
+
+        // Map the file again so the records just written are served too
+        std::string path = path_;
+        open(path, dictionary_hash, settings_hash);
+        return true;
+    }
+
+} // namespace spellcheck
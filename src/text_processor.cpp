@@ -1,6 +1,7 @@
 #include "text_processor.h"
+#include "stream_tokenizer.h"
+#include "file_source.h"
 #include <fstream>
-#include <sstream>
 #include <algorithm>
 #include <cctype>
 
@@ -8,7 +9,7 @@ namespace spellcheck
 {
 
     TextProcessor::TextProcessor()
-        : url_regex_(R"(https?://[^\s]+|www\.[^\s]+|[a-zA-Z0-9][a-zA-Z0-9-]*\.[a-zA-Z]{2,})"), email_regex_(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})"), number_regex_(R"(\d+(?:\.\d+)?)"), word_regex_(R"([a-zA-Z]+(?:'[a-zA-Z]+)?)"), ignore_urls_(true), ignore_emails_(true), ignore_numbers_(true), case_sensitive_(false)
+        : url_regex_(R"(https?://[^\s]+|www\.[^\s]+|[a-zA-Z0-9][a-zA-Z0-9-]*\.[a-zA-Z]{2,})"), email_regex_(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})"), number_regex_(R"(\d+(?:\.\d+)?)"), word_regex_(R"([a-zA-Z]+(?:'[a-zA-Z]+)?)"), ignore_urls_(true), ignore_emails_(true), ignore_numbers_(true), case_sensitive_(false), min_word_length_(3), max_word_length_(0), split_identifiers_(false)
     {
     }
 
@@ -38,37 +39,9 @@ namespace spellcheck
     {
         std::vector<std::tuple<std::string, size_t, size_t>> words;
 
-        size_t line_number = 1;
-        size_t line_start = 0;
-
-        std::sregex_iterator word_iter(text.begin(), text.end(), word_regex_);
-        std::sregex_iterator word_end;
-
-        for (; word_iter != word_end; ++word_iter)
-        {
-            const std::smatch &match = *word_iter;
-            std::string word = match.str();
-            size_t position = match.position();
-
-            // Update line number and line start
-            while (line_start <= position)
-            {
-                size_t next_newline = text.find('\n', line_start);
-                if (next_newline == std::string::npos || next_newline > position)
-                {
-                    break;
-                }
-                line_number++;
-                line_start = next_newline + 1;
-            }
-
-            size_t column = position - line_start + 1;
-
-            if (!shouldIgnoreWord(word))
-            {
-                words.emplace_back(normalizeWord(word), line_number, column);
-            }
-        }
+        auto tokenizer = StreamTokenizer::create(DocumentFormat::PlainText, *this);
+        tokenizer->feed(text, words);
+        tokenizer->finish(words);
 
         return words;
     }
@@ -92,37 +65,16 @@ namespace spellcheck
             return true;
         }
 
-        // Check if it's a URL
-        if (ignore_urls_ && isUrl(word))
+        // Ignore words outside the configured length range
+        if (word.length() < min_word_length_ ||
+            (max_word_length_ > 0 && word.length() > max_word_length_))
         {
             return true;
         }
 
-        // Check if it's an email
-        if (ignore_emails_ && isEmail(word))
-        {
-            return true;
-        }
-
-        // Check if it's a number
-        if (ignore_numbers_ && isNumber(word))
-        {
-            return true;
-        }
-
-        // Ignore very short words (1-2 characters)
-        if (word.length() <= 2)
-        {
-            return true;
-        }
-
-        // Ignore words that are not alphabetic
-        if (!isAlphabetic(word))
-        {
-            return true;
-        }
-
-        return false;
+        // Ignore words that are not alphabetic. URLs, emails and numbers
+        // all contain other characters, so no pattern match is needed.
+        return !isAlphabetic(word);
     }
 
     std::string TextProcessor::removePunctuation(const std::string &word) const
@@ -218,17 +170,14 @@ namespace spellcheck
 
     std::string TextProcessor::readFile(const std::string &file_path)
     {
-        std::ifstream file(file_path);
-        if (!file.is_open())
+        FileSource source;
+        std::string_view contents;
+        if (!source.open(file_path) || !source.readAll(contents))
         {
             return "";
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        file.close();
-
-        return buffer.str();
+        return std::string(contents);
     }
 
     bool TextProcessor::writeFile(const std::string &file_path, const std::string &content)
@@ -247,8 +196,7 @@ namespace spellcheck
 
     bool TextProcessor::fileExists(const std::string &file_path)
     {
-        std::ifstream file(file_path);
-        return file.good();
+        return FileSource::exists(file_path);
     }
 
 } // namespace spellcheck
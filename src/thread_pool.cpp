@@ -0,0 +1,207 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        // Pool and deque of the worker running on this thread, if any
+        thread_local const ThreadPool *current_pool = nullptr;
+        thread_local size_t current_worker = 0;
+    } // namespace
+
+    ThreadPool::ThreadPool(size_t threads)
+        : thread_count_(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())),
+          queued_(0), next_queue_(0), stopping_(false)
+    {
+        for (size_t i = 0; i < thread_count_; ++i)
+        {
+            queues_.push_back(std::make_unique<WorkQueue>());
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::submit(Task task)
+    {
+        std::call_once(started_, [this]
+                       {
+                           for (size_t i = 0; i < thread_count_; ++i)
+                           {
+                               threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+                           }
+                       });
+
+        // Counted before it is queued, so a thief never takes the count below zero
+        queued_.fetch_add(1);
+        size_t target = current_pool == this ? current_worker : next_queue_.fetch_add(1) % thread_count_;
+        {
+            std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+            queues_[target]->tasks.push_back(std::move(task));
+        }
+
+        // Taking the lock orders this wake-up after a worker's check of queued_
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        wake_.notify_one();
+    }
+
+    bool ThreadPool::takeTask(size_t home, bool from_back, Task &task)
+    {
+        for (size_t i = 0; i < thread_count_; ++i)
+        {
+            WorkQueue &queue = *queues_[(home + i) % thread_count_];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+            {
+                continue;
+            }
+
+            // Owners work newest-first; thieves take the oldest task
+            if (i == 0 && from_back)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            queued_.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    bool ThreadPool::runPendingTask()
+    {
+        bool own_worker = current_pool == this;
+        size_t home = own_worker ? current_worker : next_queue_.load() % thread_count_;
+
+        Task task;
+        if (!takeTask(home, own_worker, task))
+        {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+    void ThreadPool::workerLoop(size_t index)
+    {
+        current_pool = this;
+        current_worker = index;
+
+        Task task;
+        while (true)
+        {
+            if (takeTask(index, true, task))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [this]
+                       { return stopping_ || queued_.load() > 0; });
+            if (stopping_ && queued_.load() == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    TaskGroup::TaskGroup(ThreadPool &pool)
+        : pool_(pool), pending_(0), wait_limit_(0)
+    {
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+        try
+        {
+            wait();
+        }
+        catch (...)
+        {
+            // The group is being destroyed during unwinding or was never waited for
+        }
+    }
+
+    void TaskGroup::run(std::function<void()> task)
+    {
+        pending_.fetch_add(1);
+        pool_.submit([this, task = std::move(task)]
+                     {
+                         // A throwing task must still be counted, or wait() would never return
+                         std::exception_ptr error;
+                         try
+                         {
+                             task();
+                         }
+                         catch (...)
+                         {
+                             error = std::current_exception();
+                         }
+
+                         // Decrement under the lock: once the waiter sees the
+                         // count drop it may destroy the group
+                         std::lock_guard<std::mutex> lock(mutex_);
+                         if (error && !error_)
+                         {
+                             error_ = error;
+                         }
+                         if (pending_.fetch_sub(1) - 1 <= wait_limit_.load())
+                         {
+                             done_.notify_all();
+                         }
+                     });
+    }
+
+    void TaskGroup::wait(size_t max_pending)
+    {
+        wait_limit_ = max_pending;
+        while (pending_.load() > max_pending)
+        {
+            // Help with queued work rather than sleep
+            if (pool_.runPendingTask())
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this, max_pending]
+                       { return pending_.load() <= max_pending; });
+        }
+
+        // The last task to finish may still hold the lock
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wait_limit_ = 0;
+            error = std::move(error_);
+            error_ = nullptr;
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+} // namespace spellcheck
@@ -0,0 +1,149 @@
+#include "unified_diff.h"
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+
+namespace spellcheck
+{
+
+    namespace
+    {
+        bool startsWith(const std::string &text, const char *prefix)
+        {
+            return text.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+        }
+
+        // Name from a "+++ " line: tab-separated timestamps and git's "b/" are dropped
+        std::string newFileName(const std::string &line)
+        {
+            std::string name = line.substr(4);
+            size_t tab = name.find('\t');
+            if (tab != std::string::npos)
+            {
+                name.resize(tab);
+            }
+            if (name == "/dev/null")
+            {
+                return "";
+            }
+            if (startsWith(name, "b/"))
+            {
+                name.erase(0, 2);
+            }
+            return name;
+        }
+
+        // Parse "@@ -a[,b] +c[,d] @@": the first new line and the counts of old and new lines
+        bool parseHunkHeader(const std::string &line, size_t &old_count, size_t &new_first, size_t &new_count)
+        {
+            const char *cursor = line.c_str() + 3;
+            char *end;
+            if (*cursor != '-')
+            {
+                return false;
+            }
+            std::strtoul(cursor + 1, &end, 10);
+            old_count = 1;
+            if (*end == ',')
+            {
+                old_count = std::strtoul(end + 1, &end, 10);
+            }
+
+            if (end[0] != ' ' || end[1] != '+')
+            {
+                return false;
+            }
+            new_first = std::strtoul(end + 2, &end, 10);
+            new_count = 1;
+            if (*end == ',')
+            {
+                new_count = std::strtoul(end + 1, &end, 10);
+            }
+            return *end == ' ';
+        }
+    } // namespace
+
+    bool readUnifiedDiff(std::istream &input, std::vector<DiffFile> &files)
+    {
+        DiffFile *file = nullptr;
+        size_t old_left = 0; // Lines of the current hunk not yet seen
+        size_t new_left = 0;
+        size_t new_line = 0; // New-file line number of the next added or context line
+        bool extending = false;
+        std::string line;
+
+        while (std::getline(input, line))
+        {
+            if (old_left > 0 || new_left > 0)
+            {
+                char kind = line.empty() ? ' ' : line[0];
+                if (kind == '+' && new_left > 0)
+                {
+                    if (file)
+                    {
+                        // A run of added lines becomes one range, so words keep their neighbours
+                        if (!extending)
+                        {
+                            file->ranges.push_back(DiffRange{new_line, ""});
+                        }
+                        file->ranges.back().text.append(line, 1, std::string::npos).push_back('\n');
+                        extending = true;
+                    }
+                    ++new_line;
+                    --new_left;
+                }
+                else if (kind == '-' && old_left > 0)
+                {
+                    // Removed lines sit between added ones without breaking the run
+                    --old_left;
+                }
+                else if (kind == ' ' && old_left > 0 && new_left > 0)
+                {
+                    extending = false;
+                    ++new_line;
+                    --old_left;
+                    --new_left;
+                }
+                else if (kind != '\\') // "\ No newline at end of file" may follow any line
+                {
+                    std::cerr << "Malformed diff hunk at: " << line << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            if (startsWith(line, "diff "))
+            {
+                // A binary file's section has no "+++" line to replace the previous file
+                file = nullptr;
+            }
+            else if (startsWith(line, "+++ "))
+            {
+                std::string path = newFileName(line);
+                file = nullptr;
+                if (!path.empty())
+                {
+                    files.push_back(DiffFile{path, {}});
+                    file = &files.back();
+                }
+            }
+            else if (startsWith(line, "@@ "))
+            {
+                if (!parseHunkHeader(line, old_left, new_line, new_left))
+                {
+                    std::cerr << "Malformed diff hunk header: " << line << std::endl;
+                    return false;
+                }
+                extending = false;
+            }
+        }
+
+        // Files whose changes only removed lines have nothing to check
+        files.erase(std::remove_if(files.begin(), files.end(), [](const DiffFile &entry)
+                                   { return entry.ranges.empty(); }),
+                    files.end());
+
+        return !input.bad();
+    }
+
+} // namespace spellcheck
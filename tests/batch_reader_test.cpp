@@ -0,0 +1,125 @@
+#include "test_support.h"
+#include "batch_reader.h"
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace spellcheck;
+
+namespace
+{
+    struct Expected
+    {
+        std::string path;
+        std::string contents;
+        int error = 0;
+        bool deferred = false;
+    };
+
+    // Files read whole are at most this large
+    constexpr size_t kMaxFileSize = 4096;
+
+    std::vector<Expected> makeFiles(const std::filesystem::path &directory)
+    {
+        std::vector<Expected> files;
+        std::mt19937 rng(7);
+
+        auto add = [&files, &directory](const std::string &name, const std::string &contents)
+        {
+            std::string path = (directory / name).string();
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+            files.push_back(Expected{path, contents, 0, false});
+        };
+
+        add("empty.txt", "");
+        add("exact.txt", std::string(kMaxFileSize, 'x'));
+        add("large.txt", std::string(kMaxFileSize + 1, 'y'));
+        files.back().contents.clear();
+        files.back().deferred = true;
+
+        files.push_back(Expected{(directory / "missing.txt").string(), "", ENOENT, false});
+
+        std::filesystem::create_directories(directory / "subdir");
+        files.push_back(Expected{(directory / "subdir").string(), "", EISDIR, false});
+
+        // Arbitrary bytes, including NULs, of many sizes
+        for (size_t i = 0; i < 200; ++i)
+        {
+            std::string contents(rng() % kMaxFileSize + 1, '\0');
+            for (char &c : contents)
+            {
+                c = static_cast<char>(rng());
+            }
+            add("file" + std::to_string(i) + ".bin", contents);
+        }
+        return files;
+    }
+
+    void testRead(const std::vector<Expected> &files, bool use_io_uring)
+    {
+        std::vector<std::string> paths;
+        for (const auto &file : files)
+        {
+            paths.push_back(file.path);
+        }
+
+        BatchReader reader(paths, 8, kMaxFileSize, use_io_uring);
+        CHECK(use_io_uring || reader.backend() == BatchReader::Backend::ThreadPool);
+
+        std::vector<size_t> seen(files.size(), 0);
+        FileBuffer buffer;
+        while (reader.next(buffer))
+        {
+            CHECK(buffer.index < files.size());
+            if (buffer.index >= files.size())
+            {
+                continue;
+            }
+            ++seen[buffer.index];
+
+            const Expected &expected = files[buffer.index];
+            CHECK(buffer.path == expected.path);
+            CHECK(buffer.error == expected.error);
+            CHECK(buffer.deferred == expected.deferred);
+            CHECK(std::string(buffer.data.begin(), buffer.data.end()) == expected.contents);
+        }
+
+        for (size_t count : seen)
+        {
+            CHECK(count == 1);
+        }
+    }
+
+    void testEarlyDestruction(const std::vector<Expected> &files, bool use_io_uring)
+    {
+        std::vector<std::string> paths;
+        for (const auto &file : files)
+        {
+            paths.push_back(file.path);
+        }
+
+        // Reads still in flight must be stopped without leaks or hangs
+        BatchReader reader(paths, 8, kMaxFileSize, use_io_uring);
+        FileBuffer buffer;
+        CHECK(reader.next(buffer));
+    }
+} // namespace
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "batch_reader_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::vector<Expected> files = makeFiles(directory);
+
+    for (bool use_io_uring : {false, true})
+    {
+        testRead(files, use_io_uring);
+        testEarlyDestruction(files, use_io_uring);
+    }
+
+    std::filesystem::remove_all(directory);
+    return test::result();
+}
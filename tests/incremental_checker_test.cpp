@@ -0,0 +1,134 @@
+#include "test_support.h"
+#include "incremental_checker.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace spellcheck;
+
+namespace
+{
+    void writeLines(const std::string &path, const std::vector<std::string> &lines, bool final_newline)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            file << lines[i];
+            if (i + 1 < lines.size() || final_newline)
+            {
+                file << '\n';
+            }
+        }
+    }
+
+    // Neighbouring words are not compared; they are not refreshed next to an edit
+    bool samePositions(const std::vector<Misspelling> &a, const std::vector<Misspelling> &b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].word != b[i].word || a[i].line != b[i].line || a[i].column != b[i].column)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Apply random line edits and compare each incremental check with a full one
+     */
+    void testRandomEdits(const SpellChecker &checker, const std::string &path)
+    {
+        static const char *const kWords[] = {"the", "teh", "word", "wrod", "hello", "helo", "line", "lnie", "```"};
+
+        IncrementalChecker incremental(checker);
+        std::mt19937 rng(1);
+        std::vector<std::string> lines;
+        size_t mismatches = 0;
+
+        for (int edit = 0; edit < 500; ++edit)
+        {
+            std::string line;
+            for (size_t count = rng() % 4; count > 0; --count)
+            {
+                line += kWords[rng() % (sizeof(kWords) / sizeof(kWords[0]))];
+                line += ' ';
+            }
+
+            size_t position = lines.empty() ? 0 : rng() % (lines.size() + 1);
+            size_t operation = rng() % 3;
+            if (operation == 0 || lines.empty())
+            {
+                lines.insert(lines.begin() + position, line);
+            }
+            else if (operation == 1 && position < lines.size())
+            {
+                lines.erase(lines.begin() + position);
+            }
+            else if (position < lines.size())
+            {
+                lines[position] = line;
+            }
+            writeLines(path, lines, rng() % 2 == 0);
+
+            std::vector<Misspelling> misspellings;
+            CHECK(incremental.check(path, misspellings));
+            if (!samePositions(misspellings, checker.checkFile(path)))
+            {
+                ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    void testChangedLinesOnly(const SpellChecker &checker, const std::string &directory)
+    {
+        std::string path = directory + "/lines.txt";
+        std::vector<std::string> lines(100, "some of this");
+        lines[50] = "a wrod with that";
+        writeLines(path, lines, true);
+
+        IncrementalChecker incremental(checker);
+        std::vector<Misspelling> misspellings;
+        CHECK(incremental.check(path, misspellings));
+        CHECK(incremental.getLinesChecked() == 100);
+
+        // Only the edited line is tokenized; the misspelling below it moves down
+        lines[10] = "a helo with that";
+        lines.insert(lines.begin() + 20, "new");
+        writeLines(path, lines, true);
+        CHECK(incremental.check(path, misspellings));
+        CHECK(incremental.getLinesChecked() <= 11);
+        CHECK(samePositions(misspellings, checker.checkFile(path)));
+        CHECK(misspellings.size() == 2 && misspellings[1].line == 52);
+
+        // Formats with multi-line constructs are checked in full
+        std::string markdown = directory + "/lines.md";
+        writeLines(markdown, lines, true);
+        CHECK(incremental.check(markdown, misspellings));
+        lines[0] = "```";
+        writeLines(markdown, lines, true);
+        CHECK(incremental.check(markdown, misspellings));
+        CHECK(incremental.getLinesChecked() == lines.size());
+        CHECK(misspellings.empty());
+    }
+} // namespace
+
+int main()
+{
+    SpellChecker checker("dictionaries/en_US.dict");
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "incremental_checker_test";
+    std::filesystem::create_directories(directory);
+
+    testRandomEdits(checker, (directory / "random.txt").string());
+    testRandomEdits(checker, (directory / "random.md").string());
+    testChangedLinesOnly(checker, directory.string());
+
+    std::filesystem::remove_all(directory);
+    return test::result();
+}
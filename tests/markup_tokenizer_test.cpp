@@ -0,0 +1,83 @@
+#include "test_support.h"
+
+using namespace spellcheck;
+using test::tokenize;
+using test::words;
+
+using Words = std::vector<std::string>;
+
+namespace
+{
+    void testMarkdown()
+    {
+        CHECK(words(DocumentFormat::Markdown, "Intro text\n```cpp\nint skipped = 0;\n```\nAfter fence\n") ==
+              (Words{"intro", "text", "after", "fence"}));
+
+        // A fence closes only with its own character, at least as long
+        CHECK(words(DocumentFormat::Markdown, "~~~~\ncode\n```\nstill code\n~~~\nmore code\n~~~~\nprose\n") ==
+              (Words{"prose"}));
+
+        // An unclosed fence runs to the end of the document
+        CHECK(words(DocumentFormat::Markdown, "start\n```\nnever closed\n").size() == 1);
+
+        CHECK(words(DocumentFormat::Markdown, "Use `inline code` here\n") == (Words{"use", "here"}));
+        CHECK(words(DocumentFormat::Markdown, "See [link text](https://example.com/somepath) now\n") ==
+              (Words{"see", "link", "text", "now"}));
+        CHECK(words(DocumentFormat::Markdown, "[label]: https://example.com/target\n").empty());
+        CHECK(words(DocumentFormat::Markdown, "<span class=\"classname\">inner</span> tail\n") ==
+              (Words{"inner", "tail"}));
+    }
+
+    void testLatex()
+    {
+        CHECK(words(DocumentFormat::LaTeX, "Prose $xyz + abc$ more \\(uvw\\) end\n") ==
+              (Words{"prose", "more", "end"}));
+        CHECK(words(DocumentFormat::LaTeX, "Before\n$$\nabc def\n$$\nafter\n") == (Words{"before", "after"}));
+        CHECK(words(DocumentFormat::LaTeX, "\\begin{equation}\nabc def\n\\end{equation}\nafter\n") ==
+              (Words{"after"}));
+        CHECK(words(DocumentFormat::LaTeX, "\\begin{verbatim}\nraw stuff\n\\end{verbatim}\nafter\n") ==
+              (Words{"after"}));
+        CHECK(words(DocumentFormat::LaTeX, "\\textbf{bold words} \\cite{keyname} plain\n") ==
+              (Words{"bold", "words", "plain"}));
+        CHECK(words(DocumentFormat::LaTeX, "text % comment words\nnext\n") == (Words{"text", "next"}));
+        CHECK(words(DocumentFormat::LaTeX, "cost 100\\% sure\n") == (Words{"cost", "sure"}));
+    }
+
+    void testHtml()
+    {
+        CHECK(words(DocumentFormat::Html, "<p class=\"intro\">Hello world</p>\n") == (Words{"hello", "world"}));
+        CHECK(words(DocumentFormat::Html, "<!-- hidden\ncomment -->visible\n") == (Words{"visible"}));
+        CHECK(words(DocumentFormat::Html, "<script>\nvar hidden = 1;\n</script>shown\n") == (Words{"shown"}));
+        CHECK(words(DocumentFormat::Html, "<a\n href=\"target\">link</a>\n") == (Words{"link"}));
+        CHECK(words(DocumentFormat::Html, "one&amp;two&#8217;three\n") == (Words{"one", "two", "three"}));
+    }
+
+    void testRst()
+    {
+        CHECK(words(DocumentFormat::ReStructuredText, "Para::\n\n    literal block\n\nBack here\n") ==
+              (Words{"para", "back", "here"}));
+        CHECK(words(DocumentFormat::ReStructuredText, ".. code-block:: python\n\n   skipped code\n\nText\n") ==
+              (Words{"text"}));
+        CHECK(words(DocumentFormat::ReStructuredText, "Inline :math:`xyz` and ``literal text`` done\n") ==
+              (Words{"inline", "and", "done"}));
+        CHECK(words(DocumentFormat::ReStructuredText, "`link text <https://example.com/>`_\n") ==
+              (Words{"link", "text"}));
+    }
+
+    void testPositions()
+    {
+        // Lines and columns are those of the original document; columns count characters
+        auto tokens = tokenize(DocumentFormat::Markdown, "```\ncode\n```\n«quoted» word\n");
+        CHECK(tokens == (std::vector<WordToken>{{"quoted", 4, 2}, {"word", 4, 10}}));
+    }
+} // namespace
+
+int main()
+{
+    testMarkdown();
+    testLatex();
+    testHtml();
+    testRst();
+    testPositions();
+    return test::result();
+}
@@ -0,0 +1,140 @@
+#include "test_support.h"
+#include "perfect_hash.h"
+#include "dictionary.h"
+#include <random>
+#include <unordered_map>
+
+using namespace spellcheck;
+
+namespace
+{
+    std::string randomWord(std::mt19937 &rng)
+    {
+        std::string word(3 + rng() % 10, 'a');
+        for (char &c : word)
+        {
+            c = static_cast<char>('a' + rng() % 26);
+        }
+        return word;
+    }
+
+    // Unique random words with frequencies
+    std::unordered_map<std::string, uint32_t> makeWords(size_t count, std::mt19937 &rng)
+    {
+        std::unordered_map<std::string, uint32_t> words;
+        while (words.size() < count)
+        {
+            words.emplace(randomWord(rng), 1 + rng() % 1000);
+        }
+        return words;
+    }
+
+    void testIndex()
+    {
+        std::mt19937 rng(26);
+        auto words = makeWords(20000, rng);
+        std::vector<std::pair<std::string, uint32_t>> entries(words.begin(), words.end());
+
+        PerfectHashIndex index;
+        CHECK(index.build(entries));
+        CHECK(index.size() == words.size());
+
+        size_t wrong = 0;
+        for (const auto &entry : entries)
+        {
+            wrong += !index.contains(entry.first) || index.frequency(entry.first) != entry.second;
+        }
+        CHECK(wrong == 0);
+
+        // Non-words land on occupied slots and must be told apart by fingerprint
+        size_t false_positives = 0;
+        for (size_t i = 0; i < 100000; ++i)
+        {
+            std::string word = randomWord(rng) + "q";
+            if (!words.count(word))
+            {
+                false_positives += index.contains(word) || index.frequency(word) != 0;
+            }
+        }
+        CHECK(false_positives == 0);
+
+        const std::string &word = entries[0].first;
+        CHECK(index.setFrequency(word, 5) && index.frequency(word) == 5);
+        CHECK(index.erase(word));
+        CHECK(!index.contains(word) && index.frequency(word) == 0);
+        CHECK(!index.erase(word));
+        CHECK(!index.setFrequency(word, 6));
+        CHECK(index.size() == words.size() - 1);
+        CHECK(index.contains(entries[1].first));
+
+        PerfectHashIndex empty;
+        CHECK(empty.build({}));
+        CHECK(!empty.contains("anything") && empty.size() == 0);
+    }
+
+    void testFrozenDictionary()
+    {
+        std::mt19937 rng(27);
+        auto words = makeWords(5000, rng);
+
+        Dictionary dictionary;
+        for (const auto &entry : words)
+        {
+            dictionary.addWord(entry.first, entry.second);
+        }
+        CHECK(dictionary.freeze());
+        CHECK(dictionary.isFrozen());
+
+        auto checkAll = [&dictionary, &words]()
+        {
+            size_t wrong = 0;
+            for (const auto &entry : words)
+            {
+                wrong += !dictionary.containsWord(entry.first) ||
+                         dictionary.getWordFrequency(entry.first) != entry.second;
+            }
+            CHECK(wrong == 0);
+            CHECK(dictionary.size() == words.size());
+        };
+        checkAll();
+        CHECK(dictionary.containsWord("ZZZ") == (words.count("zzz") > 0));
+
+        size_t false_positives = 0;
+        for (size_t i = 0; i < 20000; ++i)
+        {
+            std::string word = randomWord(rng) + "q";
+            false_positives += !words.count(word) && dictionary.containsWord(word);
+        }
+        CHECK(false_positives == 0);
+
+        // Changes while frozen go to the overlay or mark index slots removed
+        auto it = words.begin();
+        std::string removed = it->first;
+        std::string updated = (++it)->first;
+        CHECK(dictionary.removeWord(removed));
+        CHECK(!dictionary.removeWord(removed));
+        words.erase(removed);
+        dictionary.addWord(updated, 4242);
+        words[updated] = 4242;
+        dictionary.addWord("overlayword", 9);
+        words["overlayword"] = 9;
+        dictionary.addWord("transient", 3);
+        CHECK(dictionary.removeWord("transient"));
+        CHECK(dictionary.isFrozen());
+        checkAll();
+        CHECK(!dictionary.containsWord(removed) && !dictionary.containsWord("transient"));
+
+        // Compaction folds the overlay into a new index
+        dictionary.compact();
+        CHECK(dictionary.isFrozen());
+        checkAll();
+        CHECK(!dictionary.containsWord(removed) && !dictionary.containsWord("transient"));
+    }
+} // namespace
+
+int main()
+{
+    testIndex();
+    testFrozenDictionary();
+    return test::result();
+}
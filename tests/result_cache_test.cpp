@@ -0,0 +1,127 @@
+#include "test_support.h"
+#include "result_cache.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+using namespace spellcheck;
+
+namespace
+{
+    const std::vector<Misspelling> kMisspellings = {{"teh", 1, 5, "", "cat"}, {"wrod", 3, 1, "the", ""}};
+
+    bool sameMisspellings(const std::vector<Misspelling> &a, const std::vector<Misspelling> &b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].word != b[i].word || a[i].line != b[i].line || a[i].column != b[i].column ||
+                a[i].previous != b[i].previous || a[i].next != b[i].next)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void writeFile(const std::string &path, const std::string &contents)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << contents;
+    }
+
+    uint64_t hashOf(const std::string &contents)
+    {
+        ContentHasher hasher;
+        hasher.update(contents);
+        return hasher.digest();
+    }
+
+    void testRacyStamp(const std::filesystem::path &directory)
+    {
+        std::string path = (directory / "racy.txt").string();
+        std::string contents = "teh cat\n";
+        writeFile(path, contents);
+
+        ResultCache cache;
+        FileStamp stamp;
+        CHECK(FileStamp::read(path, stamp));
+        cache.store(path, stamp, hashOf(contents), kMisspellings);
+
+        // Modified just now, so the same stamp could hide a later change
+        std::vector<Misspelling> found;
+        CHECK(!cache.lookup(path, stamp, found));
+        CHECK(cache.lookup(path, stamp, hashOf(contents), found));
+        CHECK(sameMisspellings(found, kMisspellings));
+        CHECK(!cache.lookup(path, stamp, hashOf("changed\n"), found));
+
+        // Touched long ago: the hash lookup hits and records the trusted stamp
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+        FileStamp old_stamp;
+        CHECK(FileStamp::read(path, old_stamp));
+        CHECK(!cache.lookup(path, old_stamp, found));
+        CHECK(cache.lookup(path, old_stamp, hashOf(contents), found));
+        found.clear();
+        CHECK(cache.lookup(path, old_stamp, found));
+        CHECK(sameMisspellings(found, kMisspellings));
+    }
+
+    void testLoad(const std::filesystem::path &directory)
+    {
+        std::string path = (directory / "stored.txt").string();
+        std::string cache_path = (directory / "results.cache").string();
+        writeFile(path, "teh cat\n");
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+        FileStamp stamp;
+        CHECK(FileStamp::read(path, stamp));
+
+        const uint64_t fingerprint = 42;
+        {
+            ResultCache cache;
+            CHECK(cache.load(cache_path, fingerprint) == 0);
+            cache.store(path, stamp, 7, kMisspellings);
+            CHECK(cache.save(fingerprint));
+        }
+
+        ResultCache cache;
+        std::vector<Misspelling> found;
+        CHECK(cache.load(cache_path, fingerprint) == 1);
+        CHECK(cache.lookup(path, stamp, found));
+        CHECK(sameMisspellings(found, kMisspellings));
+
+        // Other dictionaries or settings: nothing is kept
+        CHECK(cache.load(cache_path, fingerprint + 1) == 0);
+        CHECK(!cache.lookup(path, stamp, found));
+
+        // Every truncation of a one-entry file is rejected
+        std::ifstream file(cache_path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+        size_t accepted = 0;
+        for (size_t length = 0; length < data.size(); ++length)
+        {
+            writeFile(cache_path, data.substr(0, length));
+            accepted += cache.load(cache_path, fingerprint);
+        }
+        CHECK(accepted == 0);
+
+        writeFile(cache_path, data);
+        CHECK(cache.load(cache_path, fingerprint) == 1);
+    }
+} // namespace
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "result_cache_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    testRacyStamp(directory);
+    testLoad(directory);
+
+    std::filesystem::remove_all(directory);
+    return test::result();
+}
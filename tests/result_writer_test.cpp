@@ -0,0 +1,440 @@
+#include "test_support.h"
+#include "result_writer.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace spellcheck;
+
+namespace
+{
+    /**
+     * @brief A parsed JSON value; missing members and items read as Null
+     */
+    struct Json
+    {
+        enum class Kind
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        Kind kind = Kind::Null;
+        std::string text; // String value, or the digits of a number
+        std::vector<Json> items;
+        std::vector<std::pair<std::string, Json>> members;
+
+        const Json &operator[](const std::string &key) const
+        {
+            static const Json missing;
+            for (const auto &member : members)
+            {
+                if (member.first == key)
+                {
+                    return member.second;
+                }
+            }
+            return missing;
+        }
+
+        const Json &operator[](size_t index) const
+        {
+            static const Json missing;
+            return index < items.size() ? items[index] : missing;
+        }
+    };
+
+    bool validUtf8(std::string_view text)
+    {
+        for (size_t i = 0; i < text.size();)
+        {
+            unsigned char lead = static_cast<unsigned char>(text[i]);
+            size_t length = lead < 0x80 ? 1 : lead >= 0xC2 && lead <= 0xDF ? 2
+                                          : lead >= 0xE0 && lead <= 0xEF   ? 3
+                                          : lead >= 0xF0 && lead <= 0xF4   ? 4
+                                                                           : 0;
+            if (length == 0 || i + length > text.size())
+            {
+                return false;
+            }
+            uint32_t code_point = length == 1 ? lead : lead & (0x3F >> (length - 1));
+            for (size_t k = 1; k < length; ++k)
+            {
+                unsigned char byte = static_cast<unsigned char>(text[i + k]);
+                if ((byte & 0xC0) != 0x80)
+                {
+                    return false;
+                }
+                code_point = (code_point << 6) | (byte & 0x3F);
+            }
+            static const uint32_t kSmallest[] = {0, 0, 0x80, 0x800, 0x10000};
+            if (code_point < kSmallest[length] || code_point > 0x10FFFF ||
+                (code_point >= 0xD800 && code_point <= 0xDFFF))
+            {
+                return false;
+            }
+            i += length;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Strict parser: rejects raw control characters and invalid UTF-8 in strings
+     */
+    class JsonParser
+    {
+    private:
+        std::string_view input_;
+        size_t position_ = 0;
+        bool ok_ = true;
+
+        void skipSpace()
+        {
+            while (position_ < input_.size() && std::string_view(" \t\r\n").find(input_[position_]) != std::string_view::npos)
+            {
+                ++position_;
+            }
+        }
+
+        bool consume(char c)
+        {
+            skipSpace();
+            if (position_ < input_.size() && input_[position_] == c)
+            {
+                ++position_;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c)
+        {
+            if (!consume(c))
+            {
+                ok_ = false;
+            }
+        }
+
+        std::string parseString()
+        {
+            std::string value;
+            expect('"');
+            while (ok_ && position_ < input_.size() && input_[position_] != '"')
+            {
+                unsigned char c = static_cast<unsigned char>(input_[position_++]);
+                if (c < 0x20)
+                {
+                    ok_ = false;
+                }
+                else if (c != '\\')
+                {
+                    value.push_back(static_cast<char>(c));
+                }
+                else if (position_ < input_.size())
+                {
+                    char escape = input_[position_++];
+                    static const std::string_view kShort = "\"\\/bfnrt";
+                    static const std::string_view kDecoded = "\"\\/\b\f\n\r\t";
+                    if (kShort.find(escape) != std::string_view::npos)
+                    {
+                        value.push_back(kDecoded[kShort.find(escape)]);
+                    }
+                    else if (escape == 'u' && position_ + 4 <= input_.size())
+                    {
+                        uint32_t code = std::stoul(std::string(input_.substr(position_, 4)), nullptr, 16);
+                        position_ += 4;
+                        // The writer has no reason to escape anything outside the BMP
+                        if (code >= 0xD800 && code <= 0xDFFF)
+                        {
+                            ok_ = false;
+                        }
+                        else if (code < 0x80)
+                        {
+                            value.push_back(static_cast<char>(code));
+                        }
+                        else if (code < 0x800)
+                        {
+                            value.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                            value.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                        }
+                        else
+                        {
+                            value.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                            value.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                            value.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                        }
+                    }
+                    else
+                    {
+                        ok_ = false;
+                    }
+                }
+            }
+            expect('"');
+            if (!validUtf8(value))
+            {
+                ok_ = false;
+            }
+            return value;
+        }
+
+        Json parseValue()
+        {
+            Json value;
+            skipSpace();
+            if (!ok_ || position_ >= input_.size())
+            {
+                ok_ = false;
+                return value;
+            }
+
+            char c = input_[position_];
+            if (c == '{')
+            {
+                value.kind = Json::Kind::Object;
+                ++position_;
+                if (!consume('}'))
+                {
+                    do
+                    {
+                        skipSpace();
+                        std::string key = parseString();
+                        expect(':');
+                        value.members.emplace_back(std::move(key), parseValue());
+                    } while (ok_ && consume(','));
+                    expect('}');
+                }
+            }
+            else if (c == '[')
+            {
+                value.kind = Json::Kind::Array;
+                ++position_;
+                if (!consume(']'))
+                {
+                    do
+                    {
+                        value.items.push_back(parseValue());
+                    } while (ok_ && consume(','));
+                    expect(']');
+                }
+            }
+            else if (c == '"')
+            {
+                value.kind = Json::Kind::String;
+                value.text = parseString();
+            }
+            else if (c == '-' || (c >= '0' && c <= '9'))
+            {
+                value.kind = Json::Kind::Number;
+                size_t begin = position_;
+                while (position_ < input_.size() && std::string_view("+-.eE0123456789").find(input_[position_]) != std::string_view::npos)
+                {
+                    ++position_;
+                }
+                value.text = std::string(input_.substr(begin, position_ - begin));
+            }
+            else if (input_.substr(position_, 4) == "true" || input_.substr(position_, 4) == "null")
+            {
+                value.kind = c == 't' ? Json::Kind::Bool : Json::Kind::Null;
+                value.text = std::string(input_.substr(position_, 4));
+                position_ += 4;
+            }
+            else if (input_.substr(position_, 5) == "false")
+            {
+                value.kind = Json::Kind::Bool;
+                value.text = "false";
+                position_ += 5;
+            }
+            else
+            {
+                ok_ = false;
+            }
+            return value;
+        }
+
+    public:
+        /**
+         * @brief Parse one complete document
+         * @param input JSON text
+         * @param value Receives the parsed value
+         * @return false if the text is not a single valid JSON value
+         */
+        static bool parse(std::string_view input, Json &value)
+        {
+            JsonParser parser;
+            parser.input_ = input;
+            value = parser.parseValue();
+            parser.skipSpace();
+            return parser.ok_ && parser.position_ == input.size();
+        }
+    };
+
+    struct Record
+    {
+        std::string path;
+        Misspelling misspelling;
+        std::vector<std::string> suggestions;
+    };
+
+    // Run a writer over the records into a temporary file and read back what it wrote
+    std::string writeRecords(OutputFormat format, const std::vector<Record> &records, const std::string &output_path)
+    {
+        int fd = ::open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        CHECK(fd >= 0);
+        {
+            auto writer = ResultWriter::create(format, fd, 3);
+            writer->begin();
+            for (const auto &record : records)
+            {
+                writer->write(record.path, record.misspelling, record.suggestions);
+            }
+            writer->end();
+            CHECK(writer->flush());
+        }
+        ::close(fd);
+
+        std::ifstream file(output_path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    std::vector<Record> escapingRecords()
+    {
+        return {
+            {"notes \"draft\".txt", {"q\"uo\\te\x01\x1f\t", 3, 7, "", ""}, {"naïve", "✓ok", "x", "not shown"}},
+            // A stray byte, a truncated sequence, an overlong '/' and a surrogate
+            {"/tmp/é dir/50%.md", {"a\xff" "b\xc3(c\xc0\xaf" "d\xed\xa0\x80", 12, 1, "", ""}, {}},
+        };
+    }
+
+    // What each word reads as once parsed
+    const std::string kFirstWord = "q\"uo\\te\x01\x1f\t";
+    const std::string kSecondWord = "a�b�(c��d���";
+
+    void testJsonLines(const std::string &output_path)
+    {
+        std::string output = writeRecords(OutputFormat::JsonLines, escapingRecords(), output_path);
+
+        std::vector<Json> lines;
+        std::istringstream stream(output);
+        for (std::string line; std::getline(stream, line);)
+        {
+            Json value;
+            CHECK(JsonParser::parse(line, value));
+            lines.push_back(value);
+        }
+        CHECK(!output.empty() && output.back() == '\n');
+        CHECK(lines.size() == 2);
+
+        CHECK(lines[0]["path"].text == "notes \"draft\".txt");
+        CHECK(lines[0]["line"].text == "3");
+        CHECK(lines[0]["column"].text == "7");
+        CHECK(lines[0]["word"].text == kFirstWord);
+        CHECK(lines[0]["suggestions"].items.size() == 3);
+        CHECK(lines[0]["suggestions"][0].text == "naïve");
+        CHECK(lines[0]["suggestions"][1].text == "✓ok");
+
+        CHECK(lines[1]["path"].text == "/tmp/é dir/50%.md");
+        CHECK(lines[1]["word"].text == kSecondWord);
+        CHECK(lines[1]["suggestions"].kind == Json::Kind::Array);
+        CHECK(lines[1]["suggestions"].items.empty());
+
+        // Control bytes get the short or lowercase \u forms; valid UTF-8 is written as is
+        CHECK(output.find(R"("word":"q\"uo\\te\u0001\u001f\t")") != std::string::npos);
+        CHECK(output.find("\"naïve\"") != std::string::npos);
+        CHECK(output.find("\"✓ok\"") != std::string::npos);
+        CHECK(output.find("\"/tmp/é dir/50%.md\"") != std::string::npos);
+    }
+
+    void testSarif(const std::string &output_path)
+    {
+        std::string output = writeRecords(OutputFormat::Sarif, escapingRecords(), output_path);
+
+        Json log;
+        CHECK(JsonParser::parse(output, log));
+        CHECK(log["version"].text == "2.1.0");
+        const Json &run = log["runs"][0];
+        CHECK(run["tool"]["driver"]["rules"][0]["id"].text == "spelling");
+        CHECK(run["columnKind"].text == "unicodeCodePoints");
+        CHECK(run["results"].items.size() == 2);
+
+        const Json &first = run["results"][0];
+        CHECK(first["ruleId"].text == "spelling");
+        CHECK(first["message"]["text"].text == "Unknown word \"" + kFirstWord + "\"; did you mean naïve, ✓ok, x");
+        const Json &location = first["locations"][0]["physicalLocation"];
+        CHECK(location["artifactLocation"]["uri"].text == "notes%20%22draft%22.txt");
+        CHECK(location["region"]["startLine"].text == "3");
+        CHECK(location["region"]["startColumn"].text == "7");
+        CHECK(first["properties"]["word"].text == kFirstWord);
+        CHECK(first["properties"]["suggestions"].items.size() == 3);
+
+        // Absolute paths become file URIs, with non-ASCII bytes percent-encoded
+        const Json &second = run["results"][1];
+        CHECK(second["locations"][0]["physicalLocation"]["artifactLocation"]["uri"].text ==
+              "file:///tmp/%C3%A9%20dir/50%25.md");
+        CHECK(second["message"]["text"].text == "Unknown word \"" + kSecondWord + "\"");
+        CHECK(second["properties"]["word"].text == kSecondWord);
+
+        // No misspellings still makes a complete log
+        Json empty;
+        CHECK(JsonParser::parse(writeRecords(OutputFormat::Sarif, {}, output_path), empty));
+        CHECK(empty["runs"][0]["results"].kind == Json::Kind::Array);
+        CHECK(empty["runs"][0]["results"].items.empty());
+    }
+
+    void testCodePointColumns(const std::filesystem::path &directory)
+    {
+        // "teh" starts 9 bytes but 5 characters into the line
+        std::string text_path = (directory / "columns.txt").string();
+        {
+            std::ofstream file(text_path, std::ios::binary);
+            file << "the\n«—» teh\n";
+        }
+
+        SpellChecker checker("dictionaries/en_US.dict");
+        std::vector<Misspelling> misspellings = checker.checkFile(text_path);
+        CHECK(misspellings.size() == 1);
+        if (misspellings.size() != 1)
+        {
+            return;
+        }
+
+        std::vector<Record> records = {{text_path, misspellings[0], {}}};
+        std::string output_path = (directory / "columns.out").string();
+
+        Json line;
+        CHECK(JsonParser::parse(writeRecords(OutputFormat::JsonLines, records, output_path), line));
+        CHECK(line["word"].text == "teh");
+        CHECK(line["line"].text == "2");
+        CHECK(line["column"].text == "5");
+
+        Json log;
+        CHECK(JsonParser::parse(writeRecords(OutputFormat::Sarif, records, output_path), log));
+        const Json &region = log["runs"][0]["results"][0]["locations"][0]["physicalLocation"]["region"];
+        CHECK(region["startLine"].text == "2");
+        CHECK(region["startColumn"].text == "5");
+    }
+} // namespace
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "result_writer_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    std::string output_path = (directory / "results.out").string();
+    testJsonLines(output_path);
+    testSarif(output_path);
+    testCodePointColumns(directory);
+
+    std::filesystem::remove_all(directory);
+    return test::result();
+}
@@ -0,0 +1,62 @@
+#include "test_support.h"
+
+using namespace spellcheck;
+using test::words;
+
+using Words = std::vector<std::string>;
+
+namespace
+{
+    void testC()
+    {
+        CHECK(words(DocumentFormat::CSource, "int value = 0; /* block comment */ return value; // line note\n") ==
+              (Words{"block", "comment", "line", "note"}));
+        CHECK(words(DocumentFormat::CSource, "/* first\n   second */ int skipped;\n") == (Words{"first", "second"}));
+        CHECK(words(DocumentFormat::CSource, "const char *text = \"string words\";\n") ==
+              (Words{"string", "words"}));
+        CHECK(words(DocumentFormat::CSource, "char quote = '\"'; int skipped; // after\n") == (Words{"after"}));
+        CHECK(words(DocumentFormat::CSource, "auto raw = R\"tag(raw \")\" text)tag\"; int skipped;\n") ==
+              (Words{"raw", "text"}));
+        CHECK(words(DocumentFormat::CSource, "#include \"some/header.h\"\n#define MACRO value\n").empty());
+        // Documentation commands are skipped, their arguments are not
+        CHECK(words(DocumentFormat::CSource, "/** @param count the number */\n") ==
+              (Words{"count", "the", "number"}));
+    }
+
+    void testPython()
+    {
+        CHECK(words(DocumentFormat::Python, "value = compute()  # trailing remark\n") ==
+              (Words{"trailing", "remark"}));
+        CHECK(words(DocumentFormat::Python, "def run():\n    \"\"\"Docstring\n    spans lines\"\"\"\n    return skipped\n") ==
+              (Words{"docstring", "spans", "lines"}));
+        CHECK(words(DocumentFormat::Python, "text = f\"hello {name} there\"\n") == (Words{"hello", "there"}));
+        CHECK(words(DocumentFormat::Python, "pattern = r\"\\d+ digits\"  # note\n") == (Words{"digits", "note"}));
+    }
+
+    void testJavaScript()
+    {
+        CHECK(words(DocumentFormat::JavaScript, "const text = `template ${value} words\nnext line`; let skipped;\n") ==
+              (Words{"template", "words", "next", "line"}));
+        CHECK(words(DocumentFormat::JavaScript, "let path = 'single quoted'; // comment\n") ==
+              (Words{"single", "quoted", "comment"}));
+    }
+
+    void testIdentifiers()
+    {
+        TextProcessor processor;
+        CHECK(words(DocumentFormat::CSource, "int parseHTTPRequest;\n", processor).empty());
+
+        processor.setSplitIdentifiers(true);
+        CHECK(words(DocumentFormat::CSource, "int parseHTTPRequest = read_file_name;\n", processor) ==
+              (Words{"parse", "http", "request", "read", "file", "name"}));
+    }
+} // namespace
+
+int main()
+{
+    testC();
+    testPython();
+    testJavaScript();
+    testIdentifiers();
+    return test::result();
+}
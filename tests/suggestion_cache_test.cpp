@@ -0,0 +1,114 @@
+#include "test_support.h"
+#include "suggestion_cache.h"
+#include <atomic>
+#include <thread>
+
+using namespace spellcheck;
+
+using Words = std::vector<std::string>;
+
+namespace
+{
+    void testLookup()
+    {
+        SuggestionCache cache(64);
+        Words suggestions;
+        CHECK(!cache.lookup("teh", suggestions));
+
+        cache.insert("teh", {"the", "tea"}, cache.generation());
+        CHECK(cache.lookup("teh", suggestions));
+        CHECK(suggestions == (Words{"the", "tea"}));
+
+        // Replacing an entry serves the new suggestions
+        cache.insert("teh", {"ten"}, cache.generation());
+        CHECK(cache.lookup("teh", suggestions) && suggestions == Words{"ten"});
+
+        uint64_t before = cache.generation();
+        cache.invalidate();
+        CHECK(!cache.lookup("teh", suggestions));
+
+        // Computed before the invalidation, so never served
+        cache.insert("wrod", {"word"}, before);
+        CHECK(!cache.lookup("wrod", suggestions));
+
+        SuggestionCacheStats stats = cache.getStats();
+        CHECK(stats.hits == 2);
+        CHECK(stats.misses == 3);
+    }
+
+    void testCapacity()
+    {
+        SuggestionCache cache(64);
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            cache.insert("word" + std::to_string(i), {"suggestion"}, cache.generation());
+        }
+
+        SuggestionCacheStats stats = cache.getStats();
+        CHECK(stats.entries <= stats.capacity);
+        CHECK(stats.capacity >= 64);
+        CHECK(stats.evictions >= 1000 - stats.capacity);
+
+        // The most recent insert is never the one evicted
+        Words suggestions;
+        CHECK(cache.lookup("word999", suggestions));
+    }
+
+    void testConcurrentReaders()
+    {
+        // Far more words than fit, so readers race with evictions and frees
+        SuggestionCache cache(64);
+        const size_t thread_count = 8;
+        std::atomic<size_t> wrong{0};
+        std::atomic<size_t> hits{0};
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([&cache, &wrong, &hits, t]
+                                 {
+                                     Words suggestions;
+                                     for (size_t i = 0; i < 20000; ++i)
+                                     {
+                                         std::string word = "w" + std::to_string((i * 7 + t) % 500);
+                                         if (cache.lookup(word, suggestions))
+                                         {
+                                             ++hits;
+                                             if (suggestions != Words{word + "a", word + "b"})
+                                             {
+                                                 ++wrong;
+                                             }
+                                         }
+                                         else
+                                         {
+                                             uint64_t generation = cache.generation();
+                                             cache.insert(word, {word + "a", word + "b"}, generation);
+                                         }
+                                         if (t == 0 && i % 1000 == 0)
+                                         {
+                                             cache.invalidate();
+                                         }
+                                     }
+                                 });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        SuggestionCacheStats stats = cache.getStats();
+        CHECK(wrong == 0);
+        CHECK(hits > 0);
+        CHECK(stats.hits == hits);
+        CHECK(stats.hits + stats.misses == thread_count * 20000);
+        CHECK(stats.entries <= stats.capacity);
+    }
+} // namespace
+
+int main()
+{
+    testLookup();
+    testCapacity();
+    testConcurrentReaders();
+    return test::result();
+}
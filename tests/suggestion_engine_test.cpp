@@ -0,0 +1,97 @@
+#include "test_support.h"
+#include "dictionary.h"
+#include "suggestion_engine.h"
+#include <algorithm>
+
+using namespace spellcheck;
+
+using Words = std::vector<std::string>;
+
+namespace
+{
+    bool contains(const Words &words, const std::string &word)
+    {
+        return std::find(words.begin(), words.end(), word) != words.end();
+    }
+
+    void testWeightedDistance()
+    {
+        Dictionary dictionary;
+        dictionary.addWord("cat", 1);
+        dictionary.addWord("cut", 100);
+        SuggestionEngine engine(&dictionary);
+
+        // S is next to A on QWERTY but not to U, so the rarer word is closer
+        CHECK(engine.generateEditDistanceSuggestions("cst", 1) == (Words{"cat", "cut"}));
+        CHECK(engine.generateEditDistanceSuggestions("cst", 0).empty());
+
+        // Two neighbouring-key typos together cost one edit; two others cost two
+        CHECK(engine.generateEditDistanceSuggestions("xst", 1) == Words{"cat"});
+        CHECK(engine.generateEditDistanceSuggestions("cpm", 1).empty());
+        // At equal distance the more frequent word comes first
+        CHECK(engine.generateEditDistanceSuggestions("cpm", 2) == (Words{"cut", "cat"}));
+
+        // A transposition is one edit, not two substitutions
+        CHECK(engine.generateEditDistanceSuggestions("act", 1) == Words{"cat"});
+        CHECK(engine.generateEditDistanceSuggestions("tca", 1).empty());
+    }
+
+    void testDistantTier()
+    {
+        // Neither phonetic nor prefix matches reach "zebra" from "xebrx"
+        Dictionary dictionary;
+        dictionary.addWord("zebra", 10);
+        SuggestionEngine engine(&dictionary);
+        CHECK(contains(engine.generateSuggestions("xebrx"), "zebra"));
+
+        engine.setMaxEditDistance(1);
+        CHECK(!contains(engine.generateSuggestions("xebrx"), "zebra"));
+        engine.setMaxEditDistance(2);
+
+        // With a word one insertion away, the two-edit search is not run
+        dictionary.addWord("xebrxs", 1);
+        Words suggestions = engine.generateSuggestions("xebrx");
+        CHECK(contains(suggestions, "xebrxs"));
+        CHECK(!contains(suggestions, "zebra"));
+    }
+
+    void testDistantTierBudget()
+    {
+        Dictionary dictionary;
+        dictionary.addWord("zebra", 10);
+        SuggestionEngine engine(&dictionary);
+
+        // Enough for the single edits of a five-letter word (deletions,
+        // transpositions, substitutions, insertions) and one trie node
+        SuggestionBudget budget;
+        budget.max_probes = 5 + 4 + 5 * 25 + 6 * 26 + 1;
+        SuggestionResult result = engine.generateSuggestions("xebrx", budget);
+        CHECK(result.truncated);
+        CHECK(!contains(result.suggestions, "zebra"));
+    }
+
+    void testPhoneticWeight()
+    {
+        // One substitution from "rite" each; "rice" shares a longer prefix
+        // but only "rate" has the same Soundex code
+        Dictionary dictionary;
+        dictionary.addWord("rate", 10);
+        dictionary.addWord("rice", 10);
+        SuggestionEngine engine(&dictionary);
+
+        engine.setPhoneticWeight(0.0);
+        CHECK(engine.generateSuggestions("rite") == (Words{"rice", "rate"}));
+
+        engine.setPhoneticWeight(0.3);
+        CHECK(engine.generateSuggestions("rite") == (Words{"rate", "rice"}));
+    }
+} // namespace
+
+int main()
+{
+    testWeightedDistance();
+    testDistantTier();
+    testDistantTierBudget();
+    testPhoneticWeight();
+    return test::result();
+}
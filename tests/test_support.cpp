@@ -0,0 +1,39 @@
+#include "test_support.h"
+
+namespace spellcheck
+{
+    namespace test
+    {
+
+        std::vector<WordToken> tokenize(DocumentFormat format, std::string_view text, const TextProcessor &processor)
+        {
+            std::vector<WordToken> whole;
+            auto tokenizer = StreamTokenizer::create(format, processor);
+            tokenizer->feed(text, whole);
+            tokenizer->finish(whole);
+
+            // Three bytes at a time splits every fence, tag and comment marker somewhere
+            std::vector<WordToken> chunked;
+            tokenizer = StreamTokenizer::create(format, processor);
+            for (size_t i = 0; i < text.size(); i += 3)
+            {
+                tokenizer->feed(text.substr(i, 3), chunked);
+            }
+            tokenizer->finish(chunked);
+
+            CHECK(whole == chunked);
+            return whole;
+        }
+
+        std::vector<std::string> words(DocumentFormat format, std::string_view text, const TextProcessor &processor)
+        {
+            std::vector<std::string> result;
+            for (const auto &token : tokenize(format, text, processor))
+            {
+                result.push_back(std::get<0>(token));
+            }
+            return result;
+        }
+
+    } // namespace test
+} // namespace spellcheck
@@ -0,0 +1,76 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "stream_tokenizer.h"
+#include "text_processor.h"
+
+namespace spellcheck
+{
+    namespace test
+    {
+
+        /**
+         * @brief Number of failed checks in this test program
+         */
+        inline int &failures()
+        {
+            static int count = 0;
+            return count;
+        }
+
+        /**
+         * @brief Tokenize a document whole and in small chunks
+         *
+         * Chunk boundaries must not change the result, so a mismatch
+         * between the two counts as a failed check.
+         * @param format Document format
+         * @param text Whole document
+         * @param processor Word filter settings
+         * @return Words with their lines and columns
+         */
+        std::vector<WordToken> tokenize(DocumentFormat format, std::string_view text,
+                                        const TextProcessor &processor = TextProcessor());
+
+        /**
+         * @brief Tokenize a document and keep only the words
+         * @param format Document format
+         * @param text Whole document
+         * @param processor Word filter settings
+         * @return Normalized words in document order
+         */
+        std::vector<std::string> words(DocumentFormat format, std::string_view text,
+                                       const TextProcessor &processor = TextProcessor());
+
+        /**
+         * @brief Exit status for main: 0 if every check passed
+         */
+        inline int result()
+        {
+            if (failures() > 0)
+            {
+                std::cerr << failures() << " check(s) failed" << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+
+    } // namespace test
+} // namespace spellcheck
+
+// Unlike assert, also checks in release builds and keeps going after a failure
+#define CHECK(condition)                                                                               \
+    do                                                                                                 \
+    {                                                                                                  \
+        if (!(condition))                                                                              \
+        {                                                                                              \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            ++spellcheck::test::failures();                                                            \
+        }                                                                                              \
+    } while (0)
+
+#endif // TEST_SUPPORT_H
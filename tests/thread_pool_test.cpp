@@ -0,0 +1,181 @@
+#include "test_support.h"
+#include "thread_pool.h"
+#include <stdexcept>
+
+using namespace spellcheck;
+
+namespace
+{
+    void testExceptionRethrownOnce()
+    {
+        ThreadPool pool(2);
+        TaskGroup tasks(pool);
+        std::atomic<size_t> finished{0};
+        for (size_t i = 0; i < 10; ++i)
+        {
+            tasks.run([&finished, i]
+                      {
+                          if (i == 3)
+                          {
+                              throw std::runtime_error("task failed");
+                          }
+                          ++finished;
+                      });
+        }
+
+        size_t caught = 0;
+        try
+        {
+            tasks.wait();
+        }
+        catch (const std::runtime_error &error)
+        {
+            caught += std::string(error.what()) == "task failed";
+        }
+        CHECK(caught == 1);
+        CHECK(finished == 9);
+
+        // The exception was reported; the group is usable again
+        tasks.run([&finished]
+                  { ++finished; });
+        bool threw = false;
+        try
+        {
+            tasks.wait();
+        }
+        catch (...)
+        {
+            threw = true;
+        }
+        CHECK(!threw);
+        CHECK(finished == 10);
+    }
+
+    void testWaitForLimit()
+    {
+        ThreadPool pool(2);
+        TaskGroup tasks(pool);
+        std::atomic<bool> started{false};
+        std::atomic<bool> release{false};
+        std::atomic<bool> blocked_done{false};
+        std::atomic<size_t> quick_done{0};
+
+        // Once running on a worker the blocking task cannot be picked up by the waiter
+        tasks.run([&started, &release, &blocked_done]
+                  {
+                      started = true;
+                      while (!release)
+                      {
+                          std::this_thread::yield();
+                      }
+                      blocked_done = true;
+                  });
+        while (!started)
+        {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < 4; ++i)
+        {
+            tasks.run([&quick_done]
+                      { ++quick_done; });
+        }
+
+        tasks.wait(1);
+        CHECK(quick_done == 4);
+        CHECK(!blocked_done);
+
+        release = true;
+        tasks.wait();
+        CHECK(blocked_done);
+    }
+
+    void fanOut(TaskGroup &tasks, std::atomic<size_t> &count, size_t depth)
+    {
+        ++count;
+        if (depth == 0)
+        {
+            return;
+        }
+        for (size_t i = 0; i < 3; ++i)
+        {
+            tasks.run([&tasks, &count, depth]
+                      { fanOut(tasks, count, depth - 1); });
+        }
+    }
+
+    void testNestedTasks(size_t threads)
+    {
+        ThreadPool pool(threads);
+
+        // Tasks add more tasks to their own group
+        std::atomic<size_t> count{0};
+        {
+            TaskGroup tasks(pool);
+            tasks.run([&tasks, &count]
+                      { fanOut(tasks, count, 4); });
+            tasks.wait();
+        }
+        CHECK(count == 1 + 3 + 9 + 27 + 81);
+
+        // Tasks wait for groups of their own while the pool is busy
+        std::atomic<size_t> inner_count{0};
+        TaskGroup outer(pool);
+        for (size_t i = 0; i < 8; ++i)
+        {
+            outer.run([&pool, &inner_count]
+                      {
+                          TaskGroup inner(pool);
+                          for (size_t j = 0; j < 8; ++j)
+                          {
+                              inner.run([&inner_count]
+                                        { ++inner_count; });
+                          }
+                          inner.wait();
+                      });
+        }
+        outer.wait();
+        CHECK(inner_count == 64);
+    }
+
+    void testDestructorDuringUnwinding()
+    {
+        ThreadPool pool(2);
+        std::atomic<size_t> finished{0};
+        bool caught = false;
+        try
+        {
+            TaskGroup tasks(pool);
+            for (size_t i = 0; i < 16; ++i)
+            {
+                tasks.run([&finished, i]
+                          {
+                              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                              ++finished;
+                              if (i == 0)
+                              {
+                                  throw std::runtime_error("dropped");
+                              }
+                          });
+            }
+            throw std::logic_error("leaving early");
+        }
+        catch (const std::logic_error &)
+        {
+            caught = true;
+        }
+
+        // The destructor waited for every task and swallowed the task's exception
+        CHECK(caught);
+        CHECK(finished == 16);
+    }
+} // namespace
+
+int main()
+{
+    testExceptionRethrownOnce();
+    testWaitForLimit();
+    testNestedTasks(1);
+    testNestedTasks(4);
+    testDestructorDuringUnwinding();
+    return test::result();
+}
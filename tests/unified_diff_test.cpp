@@ -0,0 +1,147 @@
+#include "test_support.h"
+#include "unified_diff.h"
+#include "spell_checker.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace spellcheck;
+
+namespace
+{
+    bool parse(const std::string &diff, std::vector<DiffFile> &files)
+    {
+        std::istringstream input(diff);
+        files.clear();
+        return readUnifiedDiff(input, files);
+    }
+
+    void testHunks()
+    {
+        std::vector<DiffFile> files;
+        CHECK(parse("diff --git a/notes.txt b/notes.txt\n"
+                    "index 1111111..2222222 100644\n"
+                    "--- a/notes.txt\n"
+                    "+++ b/notes.txt\n"
+                    "@@ -1,4 +1,5 @@\n"
+                    " first\n"
+                    "-second\n"
+                    "+second changed\n"
+                    "+inserted\n"
+                    " third\n"
+                    " fourth\n"
+                    "@@ -10,2 +11,3 @@ heading text\n"
+                    " tenth\n"
+                    "+++ added line starting with pluses\n"
+                    "-removed\n"
+                    "+replacement\n",
+                    files));
+        CHECK(files.size() == 1);
+        if (files.size() == 1)
+        {
+            // Removed lines between added ones do not split the run
+            const DiffFile &file = files[0];
+            CHECK(file.path == "notes.txt");
+            CHECK(file.ranges.size() == 2);
+            CHECK(file.ranges.size() == 2 && file.ranges[0].first_line == 2 &&
+                  file.ranges[0].text == "second changed\ninserted\n");
+            CHECK(file.ranges.size() == 2 && file.ranges[1].first_line == 12 &&
+                  file.ranges[1].text == "++ added line starting with pluses\nreplacement\n");
+        }
+    }
+
+    void testHeaders()
+    {
+        std::vector<DiffFile> files;
+
+        // Counts default to 1, and "\ No newline" may follow any line
+        CHECK(parse("--- old.txt\t2024-01-01 10:00:00\n"
+                    "+++ new.txt\t2024-01-02 10:00:00\n"
+                    "@@ -1 +1 @@\n"
+                    "-old\n"
+                    "\\ No newline at end of file\n"
+                    "+new\n"
+                    "\\ No newline at end of file\n",
+                    files));
+        CHECK(files.size() == 1 && files[0].path == "new.txt" && files[0].ranges.size() == 1 &&
+              files[0].ranges[0].first_line == 1 && files[0].ranges[0].text == "new\n");
+
+        CHECK(!parse("--- a/x\n+++ b/x\n@@ -1,2 +1,2\n", files));
+        CHECK(!parse("--- a/x\n+++ b/x\n@@ -1,2 +1,2 @@\n stray\n?\n", files));
+    }
+
+    void testNewDeletedAndBinaryFiles()
+    {
+        std::vector<DiffFile> files;
+        CHECK(parse("diff --git a/created.md b/created.md\n"
+                    "new file mode 100644\n"
+                    "--- /dev/null\n"
+                    "+++ b/created.md\n"
+                    "@@ -0,0 +1,2 @@\n"
+                    "+one\n"
+                    "+two\n"
+                    "diff --git a/gone.md b/gone.md\n"
+                    "deleted file mode 100644\n"
+                    "--- a/gone.md\n"
+                    "+++ /dev/null\n"
+                    "@@ -1 +0,0 @@\n"
+                    "-gone\n"
+                    "diff --git a/image.png b/image.png\n"
+                    "Binary files a/image.png and b/image.png differ\n"
+                    "diff --git a/last.txt b/last.txt\n"
+                    "--- a/last.txt\n"
+                    "+++ b/last.txt\n"
+                    "@@ -3,0 +4 @@\n"
+                    "+appended\n",
+                    files));
+
+        // Deleted and binary files have no added lines and are left out
+        CHECK(files.size() == 2);
+        if (files.size() == 2)
+        {
+            CHECK(files[0].path == "created.md" && files[0].ranges.size() == 1 &&
+                  files[0].ranges[0].first_line == 1 && files[0].ranges[0].text == "one\ntwo\n");
+            CHECK(files[1].path == "last.txt" && files[1].ranges.size() == 1 &&
+                  files[1].ranges[0].first_line == 4 && files[1].ranges[0].text == "appended\n");
+        }
+    }
+
+    void testCheckDiff()
+    {
+        SpellChecker checker("dictionaries/en_US.dict");
+
+        // The added line sits in a fence that opens outside the hunk's context
+        std::string path = (std::filesystem::temp_directory_path() / "unified_diff_test.md").string();
+        {
+            std::ofstream file(path);
+            file << "# Title\n\n```\nint a = 1;\nint b = 2;\nint c = 3;\nint qzxvbar_helper = fnctn();\nint d = 4;\n"
+                    "int e = 5;\nint f = 6;\n```\nqzxvbar\n";
+        }
+
+        std::vector<DiffFile> files;
+        CHECK(parse("--- a/" + path + "\n+++ " + path + "\n"
+                    "@@ -4,7 +4,8 @@\n"
+                    " int a = 1;\n int b = 2;\n int c = 3;\n+int qzxvbar_helper = fnctn();\n int d = 4;\n"
+                    " int e = 5;\n int f = 6;\n ```\n"
+                    "@@ -11 +12 @@\n"
+                    "-qzxvbr\n+qzxvbar\n",
+                    files));
+        std::vector<FileCheckResult> results = checker.checkDiff(files);
+        CHECK(results.size() == 1 && results[0].checked && results[0].misspellings.size() == 1 &&
+              results[0].misspellings[0].word == "qzxvbar" && results[0].misspellings[0].line == 12);
+
+        // Without the new file the added lines are checked on their own
+        std::filesystem::remove(path);
+        results = checker.checkDiff(files);
+        CHECK(results.size() == 1 && results[0].misspellings.size() > 1);
+    }
+} // namespace
+
+int main()
+{
+    testHunks();
+    testHeaders();
+    testNewDeletedAndBinaryFiles();
+    testCheckDiff();
+    return test::result();
+}